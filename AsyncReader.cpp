@@ -0,0 +1,220 @@
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "AsyncReader.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+namespace {
+    // Enters the ring: submits toSubmit of the queued reads and waits for minComplete completions. The tests replace it
+    // to have the kernel take fewer reads than it is given
+    long (*enterRing)(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags) = [](int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        return syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0);
+    };
+
+    // Reads until byteCount bytes or the end of the file, the number of bytes read
+    size_t preadFully(int fd, char* buffer, size_t byteCount, uint64_t offset) {
+        size_t done = 0;
+        while (done < byteCount) {
+            ssize_t result = pread(fd, buffer + done, byteCount - done, offset + done);
+            if (result < 0 && errno == EINTR) { continue; }
+            if (result < 0) { throw runtime_error(string("Could not read from file: ") + strerror(errno)); }
+            if (result == 0) { break; }
+            done += result;
+        }
+        return done;
+    }
+}
+
+// The submission and completion queues shared with the kernel
+struct AsyncReader::Ring {
+    int fd = -1;
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    size_t sqRingSize = 0;
+    size_t cqRingSize = 0;
+    io_uring_sqe* sqes = (io_uring_sqe*) MAP_FAILED;
+    size_t sqesSize = 0;
+
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    io_uring_cqe* cqes;
+
+    unsigned unsubmitted = 0; // reads queued but not taken by the kernel yet
+
+    ~Ring() {
+        if (sqes != MAP_FAILED) { munmap(sqes, sqesSize); }
+        if (cqRing != MAP_FAILED && cqRing != sqRing) { munmap(cqRing, cqRingSize); }
+        if (sqRing != MAP_FAILED) { munmap(sqRing, sqRingSize); }
+        if (fd >= 0) { close(fd); }
+    }
+
+    // Sets up a ring of at least entries entries, false if io_uring is not available
+    bool setUp(unsigned entries) {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        fd = syscall(__NR_io_uring_setup, entries, &params);
+        if (fd < 0) { return false; }
+
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMapping = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMapping) { sqRingSize = cqRingSize = max(sqRingSize, cqRingSize); }
+        sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) { return false; }
+        cqRing = singleMapping ? sqRing : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) { return false; }
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = (io_uring_sqe*) mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) { return false; }
+
+        sqTail = (unsigned*) ((char*) sqRing + params.sq_off.tail);
+        sqMask = (unsigned*) ((char*) sqRing + params.sq_off.ring_mask);
+        sqArray = (unsigned*) ((char*) sqRing + params.sq_off.array);
+        cqHead = (unsigned*) ((char*) cqRing + params.cq_off.head);
+        cqTail = (unsigned*) ((char*) cqRing + params.cq_off.tail);
+        cqMask = (unsigned*) ((char*) cqRing + params.cq_off.ring_mask);
+        cqes = (io_uring_cqe*) ((char*) cqRing + params.cq_off.cqes);
+        return true;
+    }
+
+    // Queues a read of byteCount bytes into the buffer, tagged with userData. The caller keeps at most entries reads in flight
+    void queueRead(int fileFd, char* buffer, size_t byteCount, uint64_t offset, uint64_t userData) {
+        unsigned tail = *sqTail;
+        unsigned index = tail & *sqMask;
+        io_uring_sqe& sqe = sqes[index];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = fileFd;
+        sqe.addr = (uint64_t) buffer;
+        sqe.len = byteCount;
+        sqe.off = offset;
+        sqe.user_data = userData;
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        unsubmitted++;
+    }
+
+    // Submits the queued reads and waits until at least one of the inFlight reads, queued or submitted, has completed
+    // The kernel may take fewer reads than queued, such as when it is short of resources until completions are reaped.
+    // The rest stay queued and are submitted by the next call
+    void submitAndWait(size_t inFlight) {
+        while (unsubmitted > 0) {
+            long taken = enterRing(fd, unsubmitted, 0, 0);
+            if (taken < 0 && errno == EINTR) { continue; }
+            if (taken < 0 && errno != EAGAIN && errno != EBUSY) { throw runtime_error(string("Could not submit reads: ") + strerror(errno)); }
+            if (taken <= 0) { break; }
+            unsubmitted -= taken;
+        }
+        if (inFlight == unsubmitted) { // nothing to wait for, the reads are taken back off the queue so the ring can be used again
+            __atomic_store_n(sqTail, *sqTail - unsubmitted, __ATOMIC_RELEASE);
+            unsubmitted = 0;
+            throw runtime_error("Could not submit reads: the kernel took none of them.");
+        }
+        while (enterRing(fd, 0, 1, IORING_ENTER_GETEVENTS) < 0) {
+            if (errno != EINTR) { throw runtime_error(string("Could not wait for reads: ") + strerror(errno)); }
+        }
+    }
+
+    // Calls handle(userData, result) for every completion that has arrived
+    template <typename Handle>
+    void drainCompletions(Handle handle) {
+        unsigned head = *cqHead;
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            const io_uring_cqe& cqe = cqes[head & *cqMask];
+            uint64_t userData = cqe.user_data;
+            int result = cqe.res;
+            __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE); // the entry is copied, the kernel may reuse it
+            handle(userData, result);
+        }
+    }
+};
+
+AsyncReader::AsyncReader(size_t queueDepth, bool useIoUring) : queueDepth(max<size_t>(queueDepth, 1)) {
+    if (!useIoUring) { return; }
+    ring = make_unique<Ring>();
+    if (!ring->setUp(this->queueDepth)) { ring.reset(); }
+}
+
+AsyncReader::~AsyncReader() = default;
+
+void AsyncReader::readAll(const vector<Read>& reads, const function<void(size_t, const char*, size_t)>& complete) {
+    if (reads.empty()) { return; }
+    if (ring) { readAllWithRing(reads, complete); }
+    else { readAllWithPread(reads, complete); }
+}
+
+void AsyncReader::readAllWithRing(const vector<Read>& reads, const function<void(size_t, const char*, size_t)>& complete) {
+    // Every slot is a buffer for one read in flight
+    size_t slotCount = min(queueDepth, reads.size());
+    vector<vector<char>> buffers(slotCount);
+    vector<size_t> readOfSlot(slotCount);
+    vector<size_t> freeSlots;
+    for (size_t slot = slotCount; slot > 0; slot--) {
+        freeSlots.push_back(slot - 1);
+    }
+
+    size_t next = 0, inFlight = 0;
+    exception_ptr error;
+    while ((next < reads.size() && !error) || inFlight > 0) {
+        for (; next < reads.size() && !freeSlots.empty() && !error; next++) {
+            size_t slot = freeSlots.back();
+            freeSlots.pop_back();
+            const Read& read = reads[next];
+            if (!read.buffer) { buffers[slot].resize(read.length); }
+            readOfSlot[slot] = next;
+            ring->queueRead(read.fd, read.buffer ? read.buffer : buffers[slot].data(), read.length, read.offset, slot);
+            inFlight++;
+        }
+        ring->submitAndWait(inFlight);
+
+        ring->drainCompletions([&](uint64_t slot, int result) {
+            inFlight--;
+            freeSlots.push_back(slot);
+            if (error) { return; } // only draining the reads in flight
+            try {
+                const Read& read = reads[readOfSlot[slot]];
+                char* buffer = read.buffer ? read.buffer : buffers[slot].data();
+                size_t done = result;
+                if (result < 0) { done = 0; } // retried below, such as a read the kernel declined to do asynchronously
+                if (done < read.length && result != 0) { done += preadFully(read.fd, buffer + done, read.length - done, read.offset + done); }
+                complete(readOfSlot[slot], buffer, done);
+            } catch (...) {
+                error = current_exception();
+            }
+        });
+    }
+    if (error) { rethrow_exception(error); }
+}
+
+void AsyncReader::readAllWithPread(const vector<Read>& reads, const function<void(size_t, const char*, size_t)>& complete) {
+    // queueDepth workers take the next read until there are none left
+    atomic<size_t> next{0};
+    TaskGroup workers;
+    for (size_t worker = 0; worker < min(queueDepth, reads.size()); worker++) {
+        workers.run([&]() {
+            vector<char> buffer;
+            for (size_t index = next++; index < reads.size(); index = next++) {
+                const Read& read = reads[index];
+                if (!read.buffer) { buffer.resize(read.length); }
+                char* bytes = read.buffer ? read.buffer : buffer.data();
+                size_t done = preadFully(read.fd, bytes, read.length, read.offset);
+                complete(index, bytes, done);
+            }
+        });
+    }
+    workers.wait();
+}
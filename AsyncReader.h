@@ -0,0 +1,64 @@
+// AsyncReader.h
+
+#ifndef ASYNCREADER_H
+#define ASYNCREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// Batched reads of byte ranges of files, keeping up to queueDepth reads in flight.
+//
+// Reads are submitted through a Linux io_uring, set up with raw system calls, and their completions are
+// handled as they arrive, in whatever order the device finishes them. Where io_uring is not available
+// (older kernels, or blocked by a seccomp filter), the reads are made with pread() by at most queueDepth
+// workers of the shared ThreadPool instead.
+//
+// A reader is not thread-safe: each thread reading at the same time needs a reader of its own.
+class AsyncReader {
+    public:
+        struct Read {
+            int fd;
+            uint64_t offset;
+            size_t length;
+            char* buffer = nullptr; // where the bytes go, nullptr for a buffer of the reader
+        };
+
+        static const size_t QUEUE_DEPTH = 32;
+
+        // The longest read ColumnStoreDisk::readZones() makes of neighbouring zones, bounding the buffers held by the reads in flight.
+        // A single zone longer than this is still read whole.
+        static const size_t MAX_READ_BYTES = 256 * 1024;
+
+        // Falls back to pread() if useIoUring is false or io_uring cannot be set up.
+        explicit AsyncReader(size_t queueDepth = QUEUE_DEPTH, bool useIoUring = true);
+
+        ~AsyncReader();
+
+        AsyncReader(const AsyncReader&) = delete;
+        AsyncReader& operator=(const AsyncReader&) = delete;
+
+        bool usesIoUring() const { return ring != nullptr; }
+
+        // Reads every range and calls complete(index, bytes, byteCount) for the index-th read as soon as it has
+        // arrived, with fewer bytes than asked for past the end of the file. The bytes are in the buffer of the read,
+        // or if it has none in a buffer of the reader that is only valid during the call.
+        // With io_uring, complete runs on the calling thread. With pread(), it runs on the workers, possibly concurrently.
+        // Throws a runtime_error if a read fails, once the reads in flight have finished.
+        void readAll(const vector<Read>& reads, const function<void(size_t, const char*, size_t)>& complete);
+
+    private:
+        struct Ring;
+
+        size_t queueDepth;
+        unique_ptr<Ring> ring;
+
+        void readAllWithRing(const vector<Read>& reads, const function<void(size_t, const char*, size_t)>& complete);
+        void readAllWithPread(const vector<Read>& reads, const function<void(size_t, const char*, size_t)>& complete);
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <atomic>
+#include "BufferPool.h"
+
+using namespace std;
+
+namespace {
+    atomic<size_t> sharedByteBudget{256 * 1024 * 1024};
+}
+
+BufferPool::Pin::Pin(BufferPool* pool, const ColumnFile* file, size_t firstPage, size_t endPage)
+    : pool(pool), file(file), firstPage(firstPage), endPage(endPage) {}
+
+BufferPool::Pin::Pin(Pin&& other) noexcept : pool(other.pool), file(other.file), firstPage(other.firstPage), endPage(other.endPage) {
+    other.pool = nullptr;
+}
+
+BufferPool::Pin& BufferPool::Pin::operator=(Pin&& other) noexcept {
+    if (this != &other) {
+        if (pool) { pool->unpin(file, firstPage, endPage); }
+        pool = other.pool;
+        file = other.file;
+        firstPage = other.firstPage;
+        endPage = other.endPage;
+        other.pool = nullptr;
+    }
+    return *this;
+}
+
+BufferPool::Pin::~Pin() {
+    if (pool) { pool->unpin(file, firstPage, endPage); }
+}
+
+BufferPool::BufferPool(size_t byteBudget) : pageBudget(max<size_t>(byteBudget / PAGE_SIZE, 1)) {}
+
+BufferPool& BufferPool::shared() {
+    static BufferPool pool(sharedByteBudget);
+    return pool;
+}
+
+void BufferPool::setSharedByteBudget(size_t byteBudget) {
+    sharedByteBudget = byteBudget;
+}
+
+BufferPool::Pin BufferPool::pin(const ColumnFile& file, size_t offset, size_t byteCount) {
+    if (byteCount == 0 || offset >= file.size()) { return Pin(); }
+    size_t firstPage = offset / PAGE_SIZE;
+    size_t endPage = (min(offset + byteCount, file.size()) + PAGE_SIZE - 1) / PAGE_SIZE;
+
+    lock_guard<mutex> lock(poolMutex);
+    for (size_t page = firstPage; page < endPage; page++) {
+        auto found = frameOf.find(PageKey{&file, page});
+        if (found != frameOf.end()) {
+            Frame& frame = frames[found->second];
+            frame.pinCount++;
+            frame.referenced = true;
+            hits++;
+            continue;
+        }
+        misses++;
+        frameOf[PageKey{&file, page}] = frames.size();
+        frames.push_back(Frame{file.shared_from_this(), page, 1, true, false});
+    }
+    evictOverBudget();
+    return Pin(this, &file, firstPage, endPage);
+}
+
+void BufferPool::unpin(const ColumnFile* file, size_t firstPage, size_t endPage) {
+    lock_guard<mutex> lock(poolMutex);
+    for (size_t page = firstPage; page < endPage; page++) {
+        auto found = frameOf.find(PageKey{file, page});
+        if (found == frameOf.end() || frames[found->second].pinCount == 0) { continue; }
+        Frame& frame = frames[found->second];
+        frame.pinCount--;
+        if (frame.pinCount == 0 && frame.retired) { removeFrame(found->second); }
+        else if (frame.pinCount == 0) { allPinned = false; }
+    }
+    evictOverBudget();
+}
+
+bool BufferPool::contains(const ColumnFile& file, size_t page) const {
+    lock_guard<mutex> lock(poolMutex);
+    return frameOf.count(PageKey{&file, page}) > 0;
+}
+
+void BufferPool::release(const ColumnFile& file) {
+    lock_guard<mutex> lock(poolMutex);
+    for (size_t index = 0; index < frames.size();) {
+        if (frames[index].file.get() != &file) { index++; }
+        else if (frames[index].pinCount > 0) { frames[index++].retired = true; }
+        else { removeFrame(index); }
+    }
+}
+
+BufferPool::Statistics BufferPool::statistics() const {
+    lock_guard<mutex> lock(poolMutex);
+    size_t pinnedPages = 0;
+    for (const Frame& frame : frames) {
+        if (frame.pinCount > 0) { pinnedPages++; }
+    }
+    return Statistics{hits, misses, evictions, frames.size() * PAGE_SIZE, pinnedPages};
+}
+
+void BufferPool::evictOverBudget() {
+    // Two sweeps of the hand clear every reference bit, so finding no page to evict by then means all are pinned
+    // They stay pinned until a pin count drops to 0, sweeping again before then would find nothing either
+    if (allPinned) { return; }
+    for (size_t steps = 0; frames.size() > pageBudget && steps < 2 * frames.size(); steps++) {
+        if (hand >= frames.size()) { hand = 0; }
+        Frame& frame = frames[hand];
+        if (frame.pinCount > 0) {
+            hand++;
+        } else if (frame.referenced) {
+            frame.referenced = false;
+            hand++;
+        } else {
+            frame.file->discard(frame.page * PAGE_SIZE, PAGE_SIZE);
+            removeFrame(hand);
+            evictions++;
+            steps = 0;
+        }
+    }
+    allPinned = frames.size() > pageBudget;
+}
+
+void BufferPool::removeFrame(size_t index) {
+    frameOf.erase(PageKey{frames[index].file.get(), frames[index].page});
+    if (index != frames.size() - 1) {
+        frames[index] = move(frames.back());
+        frameOf[PageKey{frames[index].file.get(), frames[index].page}] = index;
+    }
+    frames.pop_back();
+}
@@ -0,0 +1,130 @@
+// BufferPool.h
+
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "ColumnFile.h"
+
+using namespace std;
+
+// A memory budget on the pages of the mapped column files, shared by every disk store of the process.
+//
+// Column files are split into pages of PAGE_SIZE bytes. Readers pin the pages holding the bytes they are
+// about to read and unpin them when done, see Pin. A pinned page is kept in the pool: pinning it again is
+// a hit, pinning a page that is not in the pool a miss. Once the pages in the pool take up more than the
+// byte budget, unpinned pages are evicted by the CLOCK algorithm (pages pinned since the hand last passed
+// get a second chance) and their memory is handed back to the OS, see ColumnFile::discard().
+//
+// Reads of pinned pages go straight to the mapping, without copying. Readers that would miss many pages can read
+// the bytes from the file instead and decode them from their own buffers, as ColumnStoreDisk::readZones() does,
+// pinning the pages all the same: the pool counts them and admits them, and later reads find them in the page cache.
+// Pinned pages can take the pool above its budget, it shrinks back as they are unpinned.
+class BufferPool {
+    public:
+        static const size_t PAGE_SIZE = 64 * 1024;
+
+        // Counters since the pool was created.
+        struct Statistics {
+            uint64_t hits;
+            uint64_t misses;
+            uint64_t evictions;
+            size_t residentBytes; // of the pages in the pool
+            size_t pinnedPages;
+        };
+
+        // Pages of a file pinned by a reader, unpinned when it goes out of scope.
+        class Pin {
+            public:
+                Pin() = default;
+                Pin(Pin&& other) noexcept;
+                Pin& operator=(Pin&& other) noexcept;
+                ~Pin();
+
+                Pin(const Pin&) = delete;
+                Pin& operator=(const Pin&) = delete;
+
+            private:
+                friend class BufferPool;
+                Pin(BufferPool* pool, const ColumnFile* file, size_t firstPage, size_t endPage);
+
+                BufferPool* pool = nullptr;
+                const ColumnFile* file = nullptr;
+                size_t firstPage = 0;
+                size_t endPage = 0;
+        };
+
+        explicit BufferPool(size_t byteBudget);
+
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+
+        // The process-wide pool, created on first use.
+        static BufferPool& shared();
+
+        // Byte budget of the process-wide pool, 256 MB by default. Only has an effect before the first call to shared().
+        static void setSharedByteBudget(size_t byteBudget);
+
+        // Pins the pages holding the bytes [offset, offset + byteCount) of the file.
+        Pin pin(const ColumnFile& file, size_t offset, size_t byteCount);
+
+        // Pins every page of the file.
+        Pin pin(const ColumnFile& file) { return pin(file, 0, file.size()); }
+
+        // Whether the page of the file is in the pool, so that reading it needs no I/O.
+        bool contains(const ColumnFile& file, size_t page) const;
+
+        // Drops the pages of a file that is not read anymore, such as a mapping replaced after a write.
+        // Pages still pinned are retired instead, and dropped once they are last unpinned.
+        void release(const ColumnFile& file);
+
+        Statistics statistics() const;
+
+        size_t byteBudget() const { return pageBudget * PAGE_SIZE; }
+
+    private:
+        struct Frame {
+            shared_ptr<const ColumnFile> file; // keeps the mapping alive while its page is in the pool
+            size_t page;
+            uint32_t pinCount;
+            bool referenced;
+            bool retired = false; // the file was released while the page was pinned
+        };
+
+        struct PageKey {
+            const ColumnFile* file;
+            size_t page;
+
+            bool operator==(const PageKey& other) const { return file == other.file && page == other.page; }
+        };
+
+        struct PageKeyHash {
+            size_t operator()(const PageKey& key) const { return hash<const void*>()(key.file) ^ (key.page * 0x9E3779B97F4A7C15ULL); }
+        };
+
+        size_t pageBudget;
+        vector<Frame> frames;
+        unordered_map<PageKey, size_t, PageKeyHash> frameOf; // index in frames
+        size_t hand = 0; // of the CLOCK
+        bool allPinned = false; // the last sweep found every page pinned, and none has been unpinned since
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        mutable mutex poolMutex;
+
+        void unpin(const ColumnFile* file, size_t firstPage, size_t endPage);
+
+        // Evicts unpinned pages until the pool fits its budget or every page is pinned
+        // Returns at once while every page is still pinned since the last sweep
+        void evictOverBudget();
+
+        // Removes the frame at index, moving the last frame into its place
+        void removeFrame(size_t index);
+};
+
+#endif
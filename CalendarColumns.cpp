@@ -0,0 +1,17 @@
+#include "CalendarColumns.h"
+#include "TimeFormat.h"
+
+using namespace std;
+
+void CalendarColumns::append(const vector<int64_t>& times, int64_t nullTime) {
+    years.reserve(years.size() + times.size());
+    months.reserve(months.size() + times.size());
+    days.reserve(days.size() + times.size());
+    for (int64_t time : times) {
+        int year = 0, month = 0, day = 0;
+        if (time != nullTime) { TimeFormat::civilFromDays(TimeFormat::daysFromEpoch(time), year, month, day); }
+        years.push_back(year);
+        months.push_back(month);
+        days.push_back(day);
+    }
+}
@@ -0,0 +1,29 @@
+// CalendarColumns.h
+
+#ifndef CALENDARCOLUMNS_H
+#define CALENDARCOLUMNS_H
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Year, month and day of the values of a TIME column, derived once when the values are stored.
+//
+// Date buckets such as a year or a month are then answered by comparing a 2-byte year and a 1-byte
+// month per row, instead of converting every epoch value back into a date. A null TIME value has year,
+// month and day 0, which no bucket matches.
+class CalendarColumns {
+    public:
+        vector<int16_t> years;
+        vector<uint8_t> months; // 1..12
+        vector<uint8_t> days; // 1..31
+
+        // Appends the dates of the epoch seconds, nullTime being the value of a null.
+        void append(const vector<int64_t>& times, int64_t nullTime);
+
+        // Number of rows.
+        size_t size() const { return years.size(); }
+};
+
+#endif
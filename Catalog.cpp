@@ -0,0 +1,113 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "Catalog.h"
+
+using namespace std;
+
+optional<Catalog> Catalog::load(const string& filepath) {
+    ifstream inputStream(filepath);
+    if (!inputStream.is_open()) { return nullopt; }
+
+    Catalog catalog;
+    string line;
+    int version = 0;
+    while (getline(inputStream, line)) {
+        istringstream entry(line);
+        string kind;
+        entry >> kind;
+        if (kind == "catalog") {
+            entry >> version;
+        } else if (kind == "rows") {
+            entry >> catalog.rowCount;
+        } else if (kind == "segment") {
+            entry >> catalog.segmentBytes;
+        } else if (kind == "calendar") {
+            entry >> catalog.calendarColumns;
+        } else if (kind == "column") {
+            Column column;
+            entry >> column.dataType >> column.format >> column.formatVersion;
+            entry.ignore(1);
+            getline(entry, column.name);
+            catalog.columns.push_back(column);
+        } else if (kind == "ingest" || kind == "ingesting") {
+            Ingest ingest = {};
+            entry >> ingest.checksum >> ingest.byteSize;
+            if (kind == "ingest") { entry >> ingest.rowCount; }
+            else { entry >> catalog.committedRowCount >> catalog.committedSegmentBytes; }
+            entry.ignore(1);
+            getline(entry, ingest.source);
+            if (kind == "ingest") { catalog.ingests.push_back(ingest); }
+            else { catalog.unfinishedIngest = ingest; }
+        } else {
+            continue; // blank or unknown lines are skipped
+        }
+        if (entry.fail()) { return nullopt; }
+    }
+    if (version != VERSION) { return nullopt; }
+    return catalog;
+}
+
+void Catalog::save(const string& filepath) const {
+    // Written next to the catalog, then renamed over it
+    string temporaryPath = filepath + ".tmp";
+    {
+        ofstream outputStream(temporaryPath, ios::trunc);
+        outputStream << "catalog " << VERSION << "\n";
+        outputStream << "rows " << rowCount << "\n";
+        outputStream << "segment " << segmentBytes << "\n";
+        outputStream << "calendar " << calendarColumns << "\n";
+        for (const Column& column : columns) {
+            outputStream << "column " << column.dataType << " " << column.format << " " << column.formatVersion << " " << column.name << "\n";
+        }
+        for (const Ingest& ingest : ingests) {
+            outputStream << "ingest " << ingest.checksum << " " << ingest.byteSize << " " << ingest.rowCount << " " << ingest.source << "\n";
+        }
+        if (unfinishedIngest) {
+            outputStream << "ingesting " << unfinishedIngest->checksum << " " << unfinishedIngest->byteSize << " " << committedRowCount << " "
+                         << committedSegmentBytes << " " << unfinishedIngest->source << "\n";
+        }
+        outputStream.flush();
+        if (!outputStream) { throw runtime_error("Could not write the catalog " + filepath); }
+    }
+    int fd = open(temporaryPath.c_str(), O_RDONLY);
+    bool synced = fd >= 0 && fsync(fd) == 0;
+    if (fd >= 0) { close(fd); }
+    if (!synced) { throw runtime_error("Could not write the catalog " + filepath); }
+    if (rename(temporaryPath.c_str(), filepath.c_str()) != 0) { throw runtime_error("Could not replace the catalog " + filepath); }
+}
+
+const Catalog::Column* Catalog::column(const string& name) const {
+    for (const Column& column : columns) {
+        if (column.name == name) { return &column; }
+    }
+    return nullptr;
+}
+
+const Catalog::Ingest* Catalog::findIngest(uint64_t checksum, uint64_t byteSize) const {
+    for (const Ingest& ingest : ingests) {
+        if (ingest.checksum == checksum && ingest.byteSize == byteSize) { return &ingest; }
+    }
+    return nullptr;
+}
+
+uint64_t Catalog::checksum(const char* bytes, size_t length, uint64_t seed) {
+    // FNV-1a over 8 byte words, with the high bits folded back in after every word, then over the remaining bytes
+    const uint64_t prime = 1099511628211ULL;
+    uint64_t hash = seed;
+    size_t idx = 0;
+    for (; idx + 8 <= length; idx += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + idx, 8);
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 29;
+    }
+    for (; idx < length; idx++) {
+        hash = (hash ^ (uint8_t) bytes[idx]) * prime;
+    }
+    return hash;
+}
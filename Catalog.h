@@ -0,0 +1,75 @@
+// Catalog.h
+
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// The manifest of a store directory: its schema, the number of rows it holds, the format of every column
+// and the CSV files ingested so far, so that a store can be reopened without ingesting its data again.
+//
+// Saved as text, one entry per line, and replaced as a whole so that it is never left half written:
+//   catalog <VERSION>
+//   rows <row count>
+//   segment <byte size>                            of the segment file when the catalog was saved
+//   calendar <1 if TIME columns have calendar runs, else 0>
+//   column <data type> <format> <format version> <name>
+//   ingest <checksum> <byte size> <row count> <path>
+//   ingesting <checksum> <byte size> <committed row count> <committed segment bytes> <path>
+//                                                  an ingest that has not finished, and the rows and segment file size before it
+class Catalog {
+    public:
+        static const int VERSION = 1;
+
+        struct Column {
+            string name;
+            int dataType;
+            string format; // such as "packed" or "runs", see ColumnStoreDisk::columnFormat()
+            int formatVersion;
+        };
+
+        struct Ingest {
+            uint64_t checksum; // of the whole file, see checksum()
+            uint64_t byteSize;
+            uint64_t rowCount;
+            string source;
+        };
+
+        uint64_t rowCount = 0;
+        uint64_t segmentBytes = 0; // of the segment file, bytes after them were appended since, see ColumnStoreDisk::openCatalog()
+        bool calendarColumns = false;
+        vector<Column> columns;
+        vector<Ingest> ingests;
+        optional<Ingest> unfinishedIngest;
+
+        // The rows and the size of the segment file when the unfinished ingest started, which a store rolls back to
+        uint64_t committedRowCount = 0;
+        uint64_t committedSegmentBytes = 0;
+
+        // Loads the catalog saved at the path, nullopt if there is none or it cannot be read.
+        static optional<Catalog> load(const string& filepath);
+
+        // Replaces the file at the path with this catalog, synced before it replaces it.
+        void save(const string& filepath) const;
+
+        // The column with the name, nullptr if there is none.
+        const Column* column(const string& name) const;
+
+        // The finished ingest of a file with the checksum and size, nullptr if there is none.
+        const Ingest* findIngest(uint64_t checksum, uint64_t byteSize) const;
+
+        // Initial value of checksum().
+        static const uint64_t CHECKSUM_SEED = 14695981039346656037ULL;
+
+        // Checksum of the bytes, continuing from the checksum of the bytes before them. Every part but the last
+        // has to be a multiple of 8 bytes long.
+        static uint64_t checksum(const char* bytes, size_t length, uint64_t seed = CHECKSUM_SEED);
+};
+
+#endif
@@ -0,0 +1,39 @@
+// ColumnBatch.h
+
+#ifndef COLUMNBATCH_H
+#define COLUMNBATCH_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// A batch of rows parsed into one typed vector per column, in the order of the CSV header.
+//
+// Only the vector matching the data type of a column is filled. Nulls are stored as the sentinel
+// values of ColumnStoreAbstract (NULL_INTEGER, NULL_FLOAT and NULL_TIME) and as "M" in STRING columns.
+// STRING values are views into the parsed text, which has to outlive the batch.
+class ColumnBatch {
+    public:
+        class Column {
+            public:
+                string name;
+                int dataType;
+
+                vector<int32_t> integers; // INTEGER_DATATYPE
+                vector<float> floats; // FLOAT_DATATYPE
+                vector<int64_t> times; // TIME_DATATYPE as epoch seconds
+                vector<string_view> strings; // STRING_DATATYPE
+
+                Column(string name, int dataType) : name(name), dataType(dataType) {}
+        };
+
+        vector<Column> columns;
+
+        // Number of rows in every column.
+        size_t rowCount = 0;
+};
+
+#endif
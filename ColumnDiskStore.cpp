@@ -7,7 +7,34 @@
 #include <vector>
 #include <cfloat>
 #include <map>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+#include <memory>
+#include <optional>
+#include <mutex>
+#include <atomic>
+#include <filesystem>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
 #include "ColumnStoreAbstract.h"
+#include "MinMaxKernels.h"
+#include "ZoneMap.h"
+#include "ColumnFile.h"
+#include "StringDictionary.h"
+#include "CalendarColumns.h"
+#include "Morsels.h"
+#include "PackedBlock.h"
+#include "XorBlock.h"
+#include "RunBlock.h"
+#include "BufferPool.h"
+#include "AsyncReader.h"
+#include "Catalog.h"
+#include "Segment.h"
 
 using namespace std;
 
@@ -16,17 +43,9 @@ using namespace std;
  */
 class ColumnStoreDisk: public ColumnStoreAbstract {
     public:
-        // Constants for data types
-        static const int STRING_DATATYPE = 0;
-        static const int TIME_DATATYPE = 1;
-        static const int INTEGER_DATATYPE = 2;
-        static const int FLOAT_DATATYPE = 3;
-
-        // Buffer size when reading files
-        static const int BUFFER_SIZE = 10240;
-
-        // Date time format string
-        static const string DTFORMATSTRING;
+        // Whether FLOAT columns are XOR encoded (see XorBlock) rather than stored as raw 4 byte floats
+        // Set it before storing any data, a store holding data goes on writing them the way its catalog says they were written
+        bool compressFloatColumns = true;
 
         // Constructor
         ColumnStoreDisk(unordered_map<string, int> columnDataTypes) : ColumnStoreAbstract(columnDataTypes){
@@ -37,98 +56,96 @@ class ColumnStoreDisk: public ColumnStoreAbstract {
             }
         }
 
-        
-
-        // Write an appropriate value to the outputStream given the column string and value string
-        void store(ofstream& outputStream, string column, string value) {
-            Object* toAdd = &castValueAccordingToColumnType(column, value);
-            switch(columnDataTypes[column]) {
-                case STRING_DATATYPE: {
-                    // Get its string value, each datum separated by new line
-                    if (toAdd == nullptr) {
-                        outputStream << "M\n";
-                    } else {
-                        outputStream << *reinterpret_cast<string*>(toAdd) << "\n";
-                    }
-                    break;
-                }
-                case TIME_DATATYPE: {
-                    if (toAdd == nullptr) {
-                        outputStream << "M\n";
-                    } else {
-                        outputStream << chrono::system_clock::to_time_t(*reinterpret_cast<chrono::system_clock::time_point*>(toAdd)) << "\n";
-                    }
-                    break;
-                }
-                case INTEGER_DATATYPE: {
-                    if (toAdd == nullptr) { handleStoreInteger(outputStream, INT_MIN); }
-                    else { handleStoreInteger(outputStream, *reinterpret_cast<int*>(toAdd)); }
-                    break;
-                }
-                case FLOAT_DATATYPE: {
-                    if (toAdd == nullptr) { handleStoreFloat(outputStream, NAN); }
-                    else { handleStoreFloat(outputStream, *reinterpret_cast<float*>(toAdd)); }
-                    break;
-                }
-                default: outputStream << "M\n";
+        // Write a value to a file given the column and value strings
+        // Every call is committed on its own: the footer of the segment file is written again and the file and the catalog synced,
+        // so values are better stored many at a time with storeAll() or storeBatch()
+        void store(string column, string value) override {
+            if (isInvalidColumn(column)) {
+                cout << "Column is not registered with this column store." << endl;
+                return;
             }
-        }
 
-        // Write a value to a file given the column and value strings
-        void store(string column, string value) {
             try {
-                ofstream outputStream(getName() + "/" + column + ".store", ios::app | ios::binary);
-                store(outputStream, column, value);
+                appendColumns({parseColumn(column, {value})});
+                sealSegment();
+                saveCatalog();
             } catch (exception& e) {
                 cerr << e.what() << endl;
             }
         }
 
         // Write multiple values to multiple files given a buffer of columns and values
-        void storeAll(map<string, vector<string>> buffer) {
+        void storeAll(const unordered_map<string, vector<string>>& buffer) override {
             try {
+                vector<ColumnBatch::Column> parsed;
                 for (auto& pair : buffer) {
                     string column = pair.first;
-                    ofstream outputStream(getName() + "/" + column + ".store", ios::app | ios::binary);
-                    for (string& value : pair.second) {
-                        store(outputStream, column, value);
+                    if (isInvalidColumn(column)) {
+                        cout << "Column is not registered with this column store." << endl;
+                        continue;
                     }
+                    parsed.push_back(parseColumn(column, pair.second));
                 }
+                appendColumns(parsed);
+                sealSegment();
+                saveCatalog();
             } catch (exception& e) {
                 cerr << e.what() << endl;
             }
         }
 
+        // Write a batch of parsed rows to the segment file, the typed values are written without being converted again
+        // During the ingest of a CSV file only the chunks of the batch are written, the footer and the catalog once the ingest finishes
+        // (see finishIngest()). A batch stored on its own is committed right away
+        // Throws if the batch cannot be written, see addCSVData()
+        void storeBatch(const ColumnBatch& batch) override {
+            appendColumns(batch.columns);
+            if (catalog.unfinishedIngest) { return; }
+            sealSegment();
+            saveCatalog();
+        }
+
+        // Number of rows every column of the store holds, including those of an ingest that has not finished yet
+        uint64_t getRowCount() {
+            return rowCount(*segmentFor());
+        }
+
         // Filter a column by a predicate and return a list of row indexes that satisfy it
-        vector<int> filter(string column, function<bool(Object*)> predicate) {
-            vector<int> result;
+        // The predicate is evaluated on the stored representation, no Object is created per value
+        // Zones whose statistics cannot satisfy the predicate are skipped without being read
+        // The file is scanned in morsels of consecutive zones, each on its own worker
+        Selection filter(string column, const Predicate& predicate) override {
+            Selection result;
+            if (isInvalidColumn(column)) {
+                cerr << "Invalid column" << endl;
+                return result;
+            }
+
             try {
-                ifstream inputStream(getName() + "/" + column + ".store", ios::binary);
-                int idx = 0;
-                if (isNotNumberDataType(column)) { // Use getline since it's string
-                    string value;
-                    while (getline(inputStream, value)) {
-                        Object* toCheck;
-                        if (value != "M") {
-                            if (columnDataTypes[column] == TIME_DATATYPE) {
-                                toCheck = reinterpret_cast<Object*>(new chrono::system_clock::time_point(chrono::system_clock::from_time_t(stoi(value))));
-                            } else {
-                                toCheck = reinterpret_cast<Object*>(new string(value));
-                            }
-                            if (predicate(toCheck)) { result.push_back(idx); }
-                        }
-                        idx++;
-                    }
-                } else { // Use read
-                    char buffer[4];
-                    while (inputStream.read(buffer, 4)) {
-                        Object* toCheck = convertBytesToNumber(buffer, columnDataTypes[column]);
-                        if (toCheck != nullptr && predicate(toCheck)) {
-                            result.push_back(idx);
-                        }
-                        idx++;
+                shared_ptr<const Segment> current = segmentFor();
+                const Segment::Column* stored = storedColumn(*current, column);
+                if (!stored) { return result; }
+                const ZoneMap& zoneMap = stored->zoneMap;
+                const ColumnFile& file = *current->file;
+
+                // Every chunk is an encoded block, STRING values are runs of dictionary codes, the predicate is evaluated once per code
+                int dataType = columnDataTypes[column];
+                Predicate bound = bindPredicate(predicate, dataType);
+                shared_ptr<const StringDictionary> dictionary = dataType == STRING_DATATYPE ? dictionaryFor(*current, column) : nullptr;
+                vector<bool> matches = dictionary ? dictionary->matchingCodes(bound) : vector<bool>();
+
+                return Morsels::filter(zoneMap.rowCount, [&](uint32_t firstRow, uint32_t endRow) {
+                    Selection rows;
+                    // Morsels start and end at zone boundaries, every zone is evaluated whole in the mapping
+                    for (size_t zone = firstRow / ZoneMap::ZONE_ROWS; zone < zoneMap.zones.size() && zoneMap.firstRow(zone) < endRow; zone++) {
+                        if (!zoneMap.mayMatch(zone, bound)) { continue; }
+                        BufferPool::Pin pin = pinZone(file, zoneMap, zone);
+                        const char* block = file.data() + zoneMap.zones[zone].byteOffset;
+                        if (dictionary) { filterCodes(block, zoneMap.firstRow(zone), matches, rows); }
+                        else { filterValues(block, zoneMap.zones[zone], zoneMap.firstRow(zone), dataType, bound, rows); }
                     }
-                }
+                    return rows;
+                });
             } catch (exception& e) {
                 cerr << e.what() << endl;
             }
@@ -136,43 +153,44 @@ class ColumnStoreDisk: public ColumnStoreAbstract {
         }
 
         // Filter a column by a predicate and a list of row indexes to check and return a list of row indexes that satisfy it
-        vector<int> filter(string column, function<bool(Object*)> predicate, vector<int> indexesToCheck) {
-            vector<int> result;
+        Selection filter(string column, const Predicate& predicate, const Selection& indexesToCheck) override {
+            Selection result;
+            if (isInvalidColumn(column)) {
+                cerr << "Invalid column" << endl;
+                return result;
+            }
+
             try {
-                if (isNotNumberDataType(column)) {
-                    ifstream inputStream(getName() + "/" + column + ".store", ios::binary);
-                    int currIndex = 0;
-                    for (int indexToCheck : indexesToCheck) {
-                        Object* toCheck;
-                        while (currIndex != indexToCheck) {
-                            if (!inputStream.ignore(numeric_limits<streamsize>::max(), '\n')) {
-                                // End of file reached
-                                cerr << "Index to check is out of bounds!" << endl;
-                                return result;
-                            }
-                            currIndex++;
-                        }
-                        string value;
-                        getline(inputStream, value);
-                        currIndex++;
-                        if (value == "M") { continue; } // Null value, predicate will always be false. Can skip to next index to check
-                        if (columnDataTypes[column] == STRING_DATATYPE) { toCheck = reinterpret_cast<Object*>(new string(value)); }
-                        else { toCheck = reinterpret_cast<Object*>(new chrono::system_clock::time_point(chrono::system_clock::from_time_t(stoi(value)))); }
-
-                        if (predicate(toCheck)) { result.push_back(indexToCheck); }
-                    }
-                } else { // Values are stored directly, each taking up 4 bytes. Can skip to index using seekg
-                    ifstream inputStream(getName() + "/" + column + ".store", ios::binary);
-                    char buffer[4];
-                    for (int indexToCheck : indexesToCheck) {
-                        // Can access directly
-                        inputStream.seekg(indexToCheck * 4L);
-                        if (!inputStream.read(buffer, 4)) {
-                            cerr << "Did not read 4 bytes when getting a number value from file." << endl;
-                        }
-                        Object* toCheck = convertBytesToNumber(buffer, columnDataTypes[column]);
-                        if (toCheck != nullptr && predicate(toCheck)) { result.push_back(indexToCheck); }
-                    }
+                shared_ptr<const Segment> current = segmentFor();
+                const Segment::Column* stored = storedColumn(*current, column);
+                if (!stored) { return result; }
+                const ZoneMap& zoneMap = stored->zoneMap;
+                const ColumnFile& file = *current->file;
+
+                // Only rows in zones that may match the predicate need to be read
+                int dataType = columnDataTypes[column];
+                Predicate bound = bindPredicate(predicate, dataType);
+                Selection candidates = indexesToCheck & zoneMap.candidateRows(bound);
+                shared_ptr<const StringDictionary> dictionary = dataType == STRING_DATATYPE ? dictionaryFor(*current, column) : nullptr;
+                vector<bool> matches = dictionary ? dictionary->matchingCodes(bound) : vector<bool>();
+                if (indexesToCheck.upperBound() > zoneMap.rowCount) {
+                    cerr << "Index to check is out of bounds!" << endl;
+                    candidates = candidates & Selection::range(0, zoneMap.rowCount);
+                }
+
+                // Every zone holding a candidate is evaluated whole on its own worker once it has been read in,
+                // then narrowed down to the candidates
+                vector<size_t> zones = zonesOf(candidates);
+                vector<Selection> zoneResults(zoneMap.zones.size());
+                readZones(file, zoneMap, zones, [&](size_t zone, const char* block) {
+                    uint32_t zoneFirst = zoneMap.firstRow(zone), zoneEnd = zoneFirst + zoneMap.zones[zone].rowCount;
+                    Selection zoneResult;
+                    if (dictionary) { filterCodes(block, zoneFirst, matches, zoneResult); }
+                    else { filterValues(block, zoneMap.zones[zone], zoneFirst, dataType, bound, zoneResult); }
+                    zoneResults[zone] = zoneResult & candidates.slice(zoneFirst, zoneEnd);
+                });
+                for (size_t zone : zones) {
+                    result.append(move(zoneResults[zone]));
                 }
             } catch (exception& e) {
                 cerr << e.what() << endl;
@@ -180,112 +198,138 @@ class ColumnStoreDisk: public ColumnStoreAbstract {
             return result;
         }
 
-        // Get the maximum value(s) of a column from a list of row indexes to check and return a list of row indexes that have the maximum value
-        vector<int> getMax(string column, vector<int> indexesToCheck) {
-            vector<int> result;
-            if (!validationCheckForMinMax(column)) { return result; }
+        // Filter a TIME column by year, adding the runs of rows holding the year
+        Selection filterYear(string column, int year) override {
+            shared_ptr<const vector<RunBlock::Run>> years = calendarRuns(column, "year");
+            if (!years) { return ColumnStoreAbstract::filterYear(column, year); }
 
+            Selection result;
             try {
-                ifstream inputStream(getName() + "/" + column + ".store", ios::binary);
-                char buffer[4];
-                float maximum = FLT_MIN;
-                float valueAtIndex;
-                for (int indexToCheck : indexesToCheck) {
-                    inputStream.seekg(indexToCheck * 4L);
-                    if (!inputStream.read(buffer, 4)) {
-                        cerr << "Did not read 4 bytes when getting a number value from file." << endl;
-                    }
-                    Object* objectAtIndex = convertBytesToNumber(buffer, columnDataTypes[column]);
-                    if (objectAtIndex == nullptr) { continue; }
-                    valueAtIndex = *reinterpret_cast<float*>(objectAtIndex); // Cast to float. Even if the underlying object is int, e.g. 24, it will cast to 24.0. It does NOT read the underlying bytes as float, still reads as int
-                    if (valueAtIndex == maximum) {
-                        result.push_back(indexToCheck);
-                    } else if (valueAtIndex > maximum) {
-                        result.clear();
-                        result.push_back(indexToCheck);
-                        maximum = valueAtIndex; // Update new maximum
-                    }
-                }
+                return calendarRows(*years, year);
             } catch (exception& e) {
                 cerr << e.what() << endl;
             }
             return result;
         }
 
-        // Get the minimum value(s) of a column from a list of row indexes to check and return a list of row indexes that have the minimum value
-        vector<int> getMin(string column, vector<int> indexesToCheck) {
-            vector<int> result;
-            if (!validationCheckForMinMax(column)) {
-                return result;
-            }
+        // Filter the given indexes of a TIME column by month, intersecting them with the runs of the year and the month
+        Selection filterMonth(string column, int year, int month, const Selection& indexesToCheck) override {
+            shared_ptr<const vector<RunBlock::Run>> years = calendarRuns(column, "year");
+            shared_ptr<const vector<RunBlock::Run>> months = calendarRuns(column, "month");
+            if (!years || !months) { return ColumnStoreAbstract::filterMonth(column, year, month, indexesToCheck); }
 
+            Selection result;
             try {
-                ifstream inputStream(getName() + "/" + column + ".store", ios::binary);
-                char buffer[4];
-                float minimum = FLT_MAX;
-                float valueAtIndex;
-                for (int indexToCheck : indexesToCheck) {
-                    inputStream.seekg(indexToCheck * 4L);
-                    if (!inputStream.read(buffer, 4)) {
-                        cerr << "Did not read 4 bytes when getting a number value from file." << endl;
-                    }
-                    Object* objectAtIndex = convertBytesToNumber(buffer, columnDataTypes[column]);
-                    if (objectAtIndex == nullptr) { continue; }
-                    valueAtIndex = *reinterpret_cast<float*>(objectAtIndex); // Cast to float. Even if the underlying object is int, e.g. 24, it will cast to 24.0. It does NOT read the underlying bytes as float, still reads as int
-                    if (valueAtIndex == minimum) {
-                        result.push_back(indexToCheck);
-                    } else if (valueAtIndex < minimum) {
-                        result.clear();
-                        result.push_back(indexToCheck);
-                        minimum = valueAtIndex; // Update new minimum
-                    }
+                if (indexesToCheck.upperBound() > zoneMapFor(column)->rowCount) {
+                    cerr << "Index to check is out of bounds!" << endl;
                 }
+                return indexesToCheck & calendarRows(*months, month) & calendarRows(*years, year);
             } catch (exception& e) {
                 cerr << e.what() << endl;
             }
             return result;
         }
 
+        // Get the maximum value(s) of a column from a list of row indexes to check and return a list of row indexes that have the maximum value
+        Selection getMax(string column, const Selection& indexesToCheck) {
+            if (!validationCheckForMinMax(column)) { return Selection(); }
+
+            if (columnDataTypes[column] == INTEGER_DATATYPE) { return scanMinMax<int32_t>(column, indexesToCheck, false, true).maxRows; }
+            return scanMinMax<float>(column, indexesToCheck, false, true).maxRows;
+        }
+
+        // Get the minimum value(s) of a column from a list of row indexes to check and return a list of row indexes that have the minimum value
+        Selection getMin(string column, const Selection& indexesToCheck) {
+            if (!validationCheckForMinMax(column)) { return Selection(); }
+
+            if (columnDataTypes[column] == INTEGER_DATATYPE) { return scanMinMax<int32_t>(column, indexesToCheck, true, false).minRows; }
+            return scanMinMax<float>(column, indexesToCheck, true, false).minRows;
+        }
+
         // Get the name of the column store
         string getName() {
             return "disk";
         }
 
-        // Get the value of a column at a given row index
-        Object* getValue(string column, int index) {
+        // Get the value of a column at a given row index, nullopt if it is null
+        // The value is decoded straight from the block of its zone in the mapped segment file, nothing is allocated besides the text of a STRING value
+        optional<Object> getValue(string column, int index) {
             if (isInvalidColumn(column)) {
                 cerr << "Invalid column" << endl;
-                return nullptr;
+                return nullopt;
             }
 
             try {
-                if (isNotNumberDataType(column)) {
-                    // Values are stored as string, separated by newlines
-                    // Cannot skip index, must manually call getline
-                    ifstream inputStream(getName() + "/" + column + ".store", ios::binary);
-                    string value;
-                    while (index > 0 && getline(inputStream, value)) {
-                        index--;
-                    }
-                    getline(inputStream, value);
-                    if (value == "M") { return nullptr; }
-                    if (columnDataTypes[column] == STRING_DATATYPE) { return reinterpret_cast<Object*>(new string(value)); }
-                    else {
-                        return reinterpret_cast<Object*>(new chrono::system_clock::time_point(chrono::system_clock::from_time_t(stoi(value))));
-                    }
-                } else { // Values are stored directly, each taking up 4 bytes. Can skip to index using seekg
-                    ifstream inputStream(getName() + "/" + column + ".store", ios::binary);
-                    char buffer[4];
-                    inputStream.seekg(index * 4L);
-                    if (!inputStream.read(buffer, 4)) {
-                        cerr << "Did not read 4 bytes when getting a number value from file." << endl;
-                    }
-                    return convertBytesToNumber(buffer, columnDataTypes[column]);
+                shared_ptr<const Segment> current = segmentFor();
+                const Segment::Column* stored = storedColumn(*current, column);
+                if (!stored || index < 0 || (size_t) index >= stored->zoneMap.rowCount) {
+                    cerr << "Index to check is out of bounds!" << endl;
+                    return nullopt;
+                }
+                const ZoneMap& zoneMap = stored->zoneMap;
+                const ZoneMap::Zone& zone = zoneMap.zones[index / ZoneMap::ZONE_ROWS];
+                BufferPool::Pin pin = pinZone(*current->file, zoneMap, index / ZoneMap::ZONE_ROWS);
+                const char* block = current->file->data() + zone.byteOffset;
+                if (columnDataTypes[column] == STRING_DATATYPE) { // Dictionary codes
+                    uint32_t code = RunBlock::at(block, index % ZoneMap::ZONE_ROWS);
+                    if (code == StringDictionary::NULL_CODE) { return nullopt; }
+                    return Object(dictionaryFor(*current, column)->decode(code));
+                }
+                if (columnDataTypes[column] == TIME_DATATYPE) {
+                    int64_t epoch = PackedBlock::at(block, index % ZoneMap::ZONE_ROWS, (int64_t) NULL_TIME);
+                    if (isNullValue(epoch)) { return nullopt; }
+                    return Object((long long) epoch);
+                }
+                if (columnDataTypes[column] == INTEGER_DATATYPE) {
+                    int32_t value = PackedBlock::at(block, index % ZoneMap::ZONE_ROWS, (int32_t) NULL_INTEGER);
+                    if (isNullValue(value)) { return nullopt; }
+                    return Object((int) value);
+                }
+                float value;
+                if (zone.encoding == Segment::RAW) { memcpy(&value, block + (size_t) (index % ZoneMap::ZONE_ROWS) * sizeof(float), sizeof(float)); }
+                else { value = XorBlock::at(block, index % ZoneMap::ZONE_ROWS); }
+                if (isNullValue(value)) { return nullopt; }
+                return Object(value);
+            } catch (exception& e) {
+                cerr << e.what() << endl;
+            }
+            return nullopt;
+        }
+
+        // Get the values of the given indexes of a column, each zone holding some of them is decoded once
+        using ColumnStoreAbstract::getValues;
+
+        bool getValues(string column, const Selection& indexes, int32_t* values) {
+            return copyValues(column, indexes, INTEGER_DATATYPE, (int32_t) NULL_INTEGER, values);
+        }
+
+        bool getValues(string column, const Selection& indexes, float* values) {
+            return copyValues(column, indexes, FLOAT_DATATYPE, NULL_FLOAT, values);
+        }
+
+        bool getValues(string column, const Selection& indexes, int64_t* values) {
+            return copyValues(column, indexes, TIME_DATATYPE, (int64_t) NULL_TIME, values);
+        }
+
+        // Dictionary codes, decoded into views of the dictionary of the segment they were read from
+        // The rows of a run get the same view, so consumers comparing with the previous value skip them cheaply
+        // The views are valid until the store is next written to, even if a write replaces the segment while they are decoded (see keepDictionary())
+        bool getValues(string column, const Selection& indexes, string_view* values) {
+            vector<uint32_t> codes(indexes.cardinality());
+            shared_ptr<const Segment> current;
+            if (!copyValues(column, indexes, STRING_DATATYPE, StringDictionary::NULL_CODE, codes.data(), &current)) { return false; }
+
+            try {
+                shared_ptr<const StringDictionary> dictionary = dictionaryFor(*current, column);
+                for (uint32_t code : codes) {
+                    *values++ = dictionary->decode(code);
                 }
+                keepDictionary(column, move(dictionary));
+                return true;
             } catch (exception& e) {
                 cerr << e.what() << endl;
             }
-            return nullptr;
+            return false;
         }
 
         // Print the first n values of each column
@@ -293,22 +337,18 @@ class ColumnStoreDisk: public ColumnStoreAbstract {
             try {
                 for (const string& column : columnHeaders) {
                     cout << column << ": ";
-                    if (isNotNumberDataType(column)) {
-                        ifstream inputStream(getName() + "/" + column + ".store", ios::binary);
-                        string value;
-                        int temp = n;
-                        while (temp > 0 && getline(inputStream, value)) {
+                    if (columnDataTypes[column] == STRING_DATATYPE) { // Nulls are decoded as "M"
+                        vector<string_view> values(min<size_t>(max(n, 0), zoneMapFor(column)->rowCount));
+                        if (!getValues(column, Selection::range(0, values.size()), values.data())) { values.clear(); }
+                        for (string_view value : values) {
                             cout << value << ",";
-                            temp--;
                         }
+                    } else if (columnDataTypes[column] == TIME_DATATYPE) {
+                        printValues<int64_t>(column, n);
+                    } else if (columnDataTypes[column] == INTEGER_DATATYPE) {
+                        printValues<int32_t>(column, n);
                     } else {
-                        ifstream inputStream(getName() + "/" + column + ".store", ios::binary);
-                        char buffer[4];
-                        int temp = n;
-                        while (temp > 0 && inputStream.read(buffer, 4)) {
-                            cout << convertBytesToNumber(buffer, columnDataTypes[column]) << ",";
-                            temp--;
-                        }
+                        printValues<float>(column, n);
                     }
                     cout << endl;
                 }
@@ -317,86 +357,914 @@ class ColumnStoreDisk: public ColumnStoreAbstract {
             }
         }
 
-               // Converts the byte array (should be of size 4) into either a float or int based on the data type passed in
-        // If the converted number is INT_MIN or NAN, then return nullptr
-        Object* convertBytesToNumber(char* buffer, int dataType) {
-            Object* result;
-            if (dataType == INTEGER_DATATYPE) {
-                int value;
-                memcpy(&value, buffer, 4); // Copy the buffer to the int value
-                if (value == INT_MIN) { return nullptr; } // The design is such that INT_MIN is equivalent to null
-                result = reinterpret_cast<Object*>(new int(value));
-            } else if (dataType == FLOAT_DATATYPE) {
-                float value;
-                memcpy(&value, buffer, 4); // Copy the buffer to the float value
-                if (isnan(value)) { return nullptr; } // The design is such that NAN is equivalent to null
-                result = reinterpret_cast<Object*>(new float(value));
-            } else {
-                cerr << "Wrong usage of this function (convertBytesToNumber). Should pass in only FLOAT or INTEGER dataType." << endl;
-                return nullptr;
+    protected:
+        // Skips a CSV file whose rows the store holds already, a file with the same size and checksum
+        // Otherwise the ingest is recorded in the catalog until it finishes, together with the rows and the size of the segment file it
+        // starts from: the ingest only appends to the file, so cutting it back to that size undoes it, see rollBackIngest()
+        bool startIngest(const string& filepath, const ColumnFile& file) override {
+            try {
+                openCatalog();
+                uint64_t checksum = checksumOf(file);
+                if (catalog.findIngest(checksum, file.size())) {
+                    cout << filepath << " is stored in " << getName() << " already, it is not ingested again." << endl;
+                    return false;
+                }
+                saveCatalog(); // The segment file is compacted, if need be, before the ingest starts from it
+                catalog.unfinishedIngest = Catalog::Ingest{checksum, file.size(), 0, filepath};
+                catalog.committedRowCount = catalog.rowCount;
+                catalog.committedSegmentBytes = catalog.segmentBytes;
+                saveCatalog();
+                return true;
+            } catch (exception& e) {
+                cerr << e.what() << endl;
+                return false;
             }
-            return result;
         }
 
-        // Append 8 bytes to the file representing a long
-        void handleStoreLong(ofstream& fileOutputStream, long value) {
-            char buffer[8];
-            memcpy(buffer, &value, 8); // Copy the long value to the buffer
-            fileOutputStream.write(buffer, 8); // Write the buffer to the file
+        // Writes the footer locating the chunks of the ingest of a CSV file, and records the finished ingest in the catalog
+        // The ingest is rolled back if the footer cannot be written
+        void finishIngest(const string& filepath, const ColumnFile& file, size_t rowCount) override {
+            if (!catalog.unfinishedIngest) { return; }
+            try {
+                sealSegment();
+            } catch (exception& e) {
+                cerr << e.what() << endl;
+                abortIngest(filepath, file);
+                return;
+            }
+            Catalog::Ingest ingest = *catalog.unfinishedIngest;
+            ingest.rowCount = rowCount;
+            catalog.ingests.push_back(ingest);
+            catalog.unfinishedIngest.reset();
+            try {
+                saveCatalog();
+            } catch (exception& e) {
+                cerr << e.what() << endl;
+            }
         }
 
-        // Append 4 bytes to the file representing an int
-        void handleStoreInteger(ofstream& fileOutputStream, int value) {
-            char buffer[4];
-            memcpy(buffer, &value, 4); // Copy the int value to the buffer
-            fileOutputStream.write(buffer, 4); // Write the buffer to the file
+        // Rolls the store back to the rows it held before the ingest of a CSV file started, the store is cleared if it cannot be
+        void abortIngest(const string& filepath, const ColumnFile&) override {
+            if (!catalog.unfinishedIngest) { return; }
+            try {
+                dropSegment();
+                if (rollBackIngest(catalog)) {
+                    cerr << "The rows of " << filepath << " stored so far are removed from " << getName() << "." << endl;
+                    return;
+                }
+                cerr << "The rows of " << filepath << " stored so far cannot be told apart, " << getName() << " is cleared." << endl;
+                clearFiles(catalog);
+                catalog = Catalog();
+            } catch (exception& e) {
+                cerr << e.what() << endl;
+            }
         }
 
-        // Append 4 bytes to the file representing a float
-        void handleStoreFloat(ofstream& fileOutputStream, float value) {
-            char buffer[4];
-            memcpy(buffer, &value, 4); // Copy the float value to the buffer
-            fileOutputStream.write(buffer, 4); // Write the buffer to the file
+        // Computes the minimum and maximum of the INTEGER or FLOAT values of the given indexes in one pass over the mapped segment file
+        // Zones are visited best-first using the zone map, and zones whose statistics cannot reach the current
+        // minimum (if needMin) or maximum (if needMax) are skipped, so only the requested extremes are exact
+        // The best zone sets the bound, the zones that can still reach it are then scanned in parallel as they are read in
+        template <typename T>
+        MinMax<T> scanMinMax(string& column, const Selection& indexesToCheck, bool needMin = true, bool needMax = true) {
+            MinMaxAccumulator<T> accumulator;
+            try {
+                shared_ptr<const Segment> current = segmentFor();
+                const Segment::Column* stored = storedColumn(*current, column);
+                if (!stored) { return accumulator.result(); }
+                const ZoneMap& zoneMap = stored->zoneMap;
+                const ColumnFile& file = *current->file;
+                uint32_t count = zoneMap.rowCount;
+                Selection rows = indexesToCheck;
+                if (rows.upperBound() > count) {
+                    cerr << "Index to check is out of bounds!" << endl;
+                    rows = rows & Selection::range(0, count);
+                }
+
+                // Split the indexes at zone boundaries
+                const vector<ZoneMap::Zone>& zones = zoneMap.zones;
+                vector<Selection> rowsByZone(zones.size());
+                rows.forEachRun([&](uint32_t start, uint32_t end) {
+                    while (start < end) {
+                        size_t zone = min<size_t>(start / ZoneMap::ZONE_ROWS, zones.size() - 1);
+                        uint32_t zoneEnd = zone + 1 < zones.size() ? min<uint32_t>(end, zoneMap.firstRow(zone + 1)) : end;
+                        rowsByZone[zone].addRange(start, zoneEnd);
+                        start = zoneEnd;
+                    }
+                });
+
+                vector<size_t> order;
+                for (size_t zone = 0; zone < zones.size(); zone++) {
+                    if (!rowsByZone[zone].empty()) { order.push_back(zone); }
+                }
+                // Visit the most promising zones first so the rest can be skipped
+                if (needMax && !needMin) {
+                    sort(order.begin(), order.end(), [&](size_t a, size_t b) { return zones[a].max > zones[b].max; });
+                } else if (needMin && !needMax) {
+                    sort(order.begin(), order.end(), [&](size_t a, size_t b) { return zones[a].min < zones[b].min; });
+                }
+
+                // Ties still have to be collected, so a zone is only skipped when it cannot reach the extreme
+                auto mayReach = [&](size_t zone, const MinMax<T>& best) {
+                    if (zones[zone].nullCount == zones[zone].rowCount) { return false; } // Only nulls
+                    if (!best.found) { return true; }
+                    return (needMin && zones[zone].min <= best.min) || (needMax && zones[zone].max >= best.max);
+                };
+
+                // The indexes of a zone, scanned in its decoded block
+                T null;
+                if constexpr (is_integral_v<T>) { null = NULL_INTEGER; }
+                else { null = NULL_FLOAT; }
+                auto scanZone = [&](size_t zone, const char* block) {
+                    MinMaxAccumulator<T> zoneAccumulator;
+                    forEachZoneRun(block, zoneMap, zone, null, rowsByZone[zone], [&](uint32_t start, uint32_t end, const T* values) {
+                        zoneAccumulator.addDense(values, end - start, start);
+                    });
+                    return zoneAccumulator.result();
+                };
+
+                const MinMax<T>& best = accumulator.result();
+                size_t next = 0;
+                while (next < order.size() && !best.found) { // The best zone holding a value sets the bound
+                    size_t zone = order[next++];
+                    if (mayReach(zone, best)) {
+                        BufferPool::Pin pin = pinZone(file, zoneMap, zone);
+                        accumulator.merge(scanZone(zone, file.data() + zoneMap.zones[zone].byteOffset));
+                    }
+                }
+
+                // The final extremes are at least as good as the bound, so zones that cannot reach it are never needed
+                // The others are scanned by readZones() as soon as their blocks are in memory, each on a worker of its own
+                vector<size_t> zonesToScan;
+                for (; next < order.size(); next++) {
+                    if (mayReach(order[next], best)) { zonesToScan.push_back(order[next]); }
+                }
+                sort(zonesToScan.begin(), zonesToScan.end());
+                vector<MinMax<T>> partials(zones.size());
+                readZones(file, zoneMap, zonesToScan, [&](size_t zone, const char* block) { partials[zone] = scanZone(zone, block); });
+                for (size_t zone : zonesToScan) {
+                    accumulator.merge(partials[zone]);
+                }
+            } catch (exception& e) {
+                cerr << e.what() << endl;
+            }
+            return accumulator.result();
         }
 
-        // Check if a column is not a number data type
-        bool isNotNumberDataType(string column) {
-            return columnDataTypes[column] == STRING_DATATYPE || columnDataTypes[column] == TIME_DATATYPE;
+    private:
+        // Version of the layout of the files of the store, recorded in the catalog (see columnFormat())
+        // Version 2 keeps every column in a single segment file, see Segment
+        // Version 3 stores null times as NULL_TIME = LLONG_MIN, version 2 stored them as 0 (1970-01-01 00:00)
+        static const int COLUMN_FORMAT_VERSION = 3;
+
+        // Values of a column to be written from a row group on, see appendColumns()
+        struct PendingValues {
+            vector<int32_t> integers;
+            vector<float> floats;
+            vector<int64_t> times;
+            vector<uint32_t> codes; // of STRING values
+        };
+
+        // Append parsed values to their columns in the segment file, keeping their zone maps up to date in the segment of the store
+        // The appended columns are written again from the first row group one of them has not filled yet, their chunks there encoded
+        // again together with the new values. Columns appended together, such as the columns of a batch, only have their last row group written again
+        // The chunks go after the end of the file, so the bytes written before never change: readers holding the previous segment keep
+        // reading them, and an append that fails is undone by cutting the file back to its old size
+        // No footer locates the chunks until sealSegment() writes one, the segment of the store locates them in memory until then
+        // STRING values are encoded into copies of the dictionaries, published together with the segment locating their codes
+        // The chunks and footers the append replaces are left in the file until compactSegment() drops them
+        void appendColumns(const vector<ColumnBatch::Column>& appended) {
+            if (appended.empty()) { return; }
+            shared_ptr<const Segment> current = segmentFor();
+            Segment next = *current;
+            for (auto& pair : columnDataTypes) {
+                if (next.column(pair.first)) { continue; }
+                Segment::Column column;
+                column.name = pair.first;
+                column.dataType = pair.second;
+                next.columns.push_back(column);
+            }
+            sort(next.columns.begin(), next.columns.end(), [](const Segment::Column& a, const Segment::Column& b) { return a.name < b.name; });
+
+            size_t firstGroup = next.rowGroupCount();
+            for (const ColumnBatch::Column& values : appended) {
+                firstGroup = min<size_t>(firstGroup, next.column(values.name)->zoneMap.rowCount / ZoneMap::ZONE_ROWS);
+            }
+
+            // The rows of the appended columns from the row group firstGroup on, followed by their new values
+            // The chunks of the other columns stay where they are
+            vector<optional<PendingValues>> pending(next.columns.size());
+            vector<uint64_t> firstRows(next.columns.size());
+            unordered_map<string, shared_ptr<const StringDictionary>> nextDictionaries;
+            for (const ColumnBatch::Column& values : appended) {
+                size_t idx = next.column(values.name) - next.columns.data();
+                firstRows[idx] = next.columns[idx].zoneMap.rowCount;
+                shared_ptr<StringDictionary> dictionary;
+                if (values.dataType == STRING_DATATYPE) { dictionary = make_shared<StringDictionary>(*dictionaryFor(*current, values.name)); }
+                pending[idx] = pendingValues(*current, values, firstGroup, dictionary.get());
+                if (dictionary) {
+                    next.columns[idx].dictionary = dictionary->entries();
+                    nextDictionaries[values.name] = move(dictionary);
+                }
+                while (next.columns[idx].zoneMap.zones.size() > firstGroup) {
+                    next.columns[idx].zoneMap.removeLastZone();
+                }
+            }
+            bool existing = (bool) current->file;
+            uint64_t previousBytes = existing ? current->file->size() : 0;
+            next.file.reset();
+            current.reset();
+
+            string filepath = segmentPath();
+            try {
+                ofstream outputStream(filepath, ios::app | ios::binary);
+                uint64_t position = previousBytes;
+                if (!existing) {
+                    uint32_t magic = Segment::MAGIC;
+                    outputStream.write((const char*) &magic, sizeof(magic));
+                    position = sizeof(magic);
+                }
+                for (size_t group = firstGroup; ; group++) {
+                    bool written = false;
+                    for (size_t idx = 0; idx < next.columns.size(); idx++) {
+                        if (!pending[idx]) { continue; }
+                        Segment::Column& column = next.columns[idx];
+                        written |= writeChunk(outputStream, position, column.dataType, *pending[idx], (group - firstGroup) * ZoneMap::ZONE_ROWS, column.zoneMap);
+                    }
+                    if (!written) { break; }
+                }
+                outputStream.close();
+                if (!outputStream) { throw runtime_error("Could not write the segment file " + filepath); }
+                next.file = ColumnFile::open(filepath);
+                if (!next.file) { throw runtime_error("Could not open the segment file " + filepath); }
+                next.footerOffset = next.file->size();
+            } catch (...) {
+                // Nothing locates the bytes after the old end of the file
+                next.file.reset();
+                error_code ignored;
+                if (existing) { filesystem::resize_file(filepath, previousBytes, ignored); }
+                else { filesystem::remove(filepath, ignored); }
+                throw;
+            }
+
+            // Calendar runs, in the footer together with the dictionaries
+            for (const ColumnBatch::Column& values : appended) {
+                if (values.dataType == TIME_DATATYPE && storeCalendarColumns) {
+                    size_t idx = next.column(values.name) - next.columns.data();
+                    appendCalendar(next.columns[idx], values, firstRows[idx]);
+                }
+            }
+            replaceSegment(make_shared<const Segment>(move(next)), move(nextDictionaries));
         }
 
-        // Check if a column is invalid
-        bool isInvalidColumn(string column) {
-            return columnDataTypes.find(column) == columnDataTypes.end();
+        // Ends the segment file with a footer locating the chunks appended since the last one, if any
+        // The file is synced once the footer is written, before saveCatalog() records its size: until the catalog does, reopening the
+        // store cuts the file back to the size it recorded (see openCatalog())
+        void sealSegment() {
+            shared_ptr<const Segment> current = segmentFor();
+            if (!current->file || current->footerOffset < current->file->size()) { return; }
+            string filepath = segmentPath();
+            uint64_t chunkBytes = current->file->size();
+            try {
+                ofstream outputStream(filepath, ios::app | ios::binary);
+                current->writeFooter(outputStream);
+                outputStream.close();
+                if (!outputStream) { throw runtime_error("Could not write the segment file " + filepath); }
+                syncFile(filepath);
+            } catch (...) {
+                error_code ignored;
+                filesystem::resize_file(filepath, chunkBytes, ignored);
+                throw;
+            }
+            current.reset();
+            dropSegment(); // Read back with the footer on next use
         }
 
-        // Check if a column is valid for min/max operations
-        bool validationCheckForMinMax(string column) {
-            if (isInvalidColumn(column)) {
-                cerr << "Invalid column" << endl;
-                return false;
+        // Writes the segment file again without the chunks and footers appends have replaced, once they take up more bytes than the rest
+        // The chunks are copied in the order of their row groups into a file next to the segment file, which is renamed over it once
+        // synced, so readers holding the old one keep reading it
+        void compactSegment() {
+            shared_ptr<const Segment> current = segmentFor();
+            if (!current->file) { return; }
+            const ColumnFile& file = *current->file;
+            uint64_t liveBytes = sizeof(Segment::MAGIC) + file.size() - current->footerOffset;
+            for (const Segment::Column& column : current->columns) {
+                for (const ZoneMap::Zone& chunk : column.zoneMap.zones) {
+                    liveBytes += chunk.byteLength;
+                }
             }
-            if (isNotNumberDataType(column)) {
-                cerr << "Cannot perform min/max on non-number data type" << endl;
-                return false;
+            if (file.size() - liveBytes <= liveBytes) { return; }
+
+            Segment next = *current;
+            string temporaryPath = segmentPath() + ".tmp";
+            {
+                ofstream outputStream(temporaryPath, ios::binary | ios::trunc);
+                uint32_t magic = Segment::MAGIC;
+                outputStream.write((const char*) &magic, sizeof(magic));
+                uint64_t position = sizeof(magic);
+                for (size_t group = 0; group < next.rowGroupCount(); group++) {
+                    for (Segment::Column& column : next.columns) {
+                        if (group >= column.zoneMap.zones.size()) { continue; }
+                        ZoneMap::Zone& chunk = column.zoneMap.zones[group];
+                        BufferPool::Pin pin = pinZone(file, column.zoneMap, group);
+                        outputStream.write(file.data() + chunk.byteOffset, chunk.byteLength);
+                        chunk.byteOffset = position;
+                        position += chunk.byteLength;
+                    }
+                }
+                next.writeFooter(outputStream);
+                outputStream.close();
+                if (!outputStream) { throw runtime_error("Could not write the segment file " + temporaryPath); }
             }
+            syncFile(temporaryPath);
+            next.file.reset();
+            current.reset();
+            filesystem::rename(temporaryPath, segmentPath());
+            dropSegment();
+        }
+
+        // Flushes the bytes written to the file to the device
+        static void syncFile(const string& filepath) {
+            int fd = ::open(filepath.c_str(), O_RDONLY);
+            if (fd < 0 || fsync(fd) != 0) {
+                if (fd >= 0) { close(fd); }
+                throw runtime_error("Could not sync " + filepath);
+            }
+            close(fd);
+        }
+
+        // The rows of a column from the row group firstGroup on, followed by the new values, STRING values as codes of the dictionary
+        // they are added to
+        PendingValues pendingValues(const Segment& segment, const ColumnBatch::Column& values, size_t firstGroup, StringDictionary* dictionary) {
+            PendingValues pending;
+            const Segment::Column* stored = segment.column(values.name);
+            switch (values.dataType) {
+                case STRING_DATATYPE: {
+                    decodeRows(segment, stored, firstGroup, StringDictionary::NULL_CODE, pending.codes);
+                    for (string_view value : values.strings) {
+                        pending.codes.push_back(dictionary->encode(value));
+                    }
+                    break;
+                }
+                case TIME_DATATYPE:
+                    decodeRows(segment, stored, firstGroup, (int64_t) NULL_TIME, pending.times);
+                    pending.times.insert(pending.times.end(), values.times.begin(), values.times.end());
+                    break;
+                case INTEGER_DATATYPE:
+                    decodeRows(segment, stored, firstGroup, (int32_t) NULL_INTEGER, pending.integers);
+                    pending.integers.insert(pending.integers.end(), values.integers.begin(), values.integers.end());
+                    break;
+                case FLOAT_DATATYPE:
+                    decodeRows(segment, stored, firstGroup, NULL_FLOAT, pending.floats);
+                    pending.floats.insert(pending.floats.end(), values.floats.begin(), values.floats.end());
+                    break;
+            }
+            return pending;
+        }
+
+        // Appends the decoded rows of a stored column from the row group firstGroup on to the values
+        template <typename T>
+        static void decodeRows(const Segment& segment, const Segment::Column* stored, size_t firstGroup, T null, vector<T>& values) {
+            if (!stored || !segment.file) { return; }
+            Selection rows = Selection::range(firstGroup * ZoneMap::ZONE_ROWS, max<uint64_t>(stored->zoneMap.rowCount, firstGroup * ZoneMap::ZONE_ROWS));
+            forEachBlockRun(*segment.file, stored->zoneMap, null, rows, [&values](uint32_t start, uint32_t end, const T* decoded) {
+                values.insert(values.end(), decoded, decoded + (end - start));
+            });
+        }
+
+        // Write the chunk of the pending values of a column in a row group, starting at the value first, false if there is none
+        // The zone map records where it is, position being where the stream is
+        bool writeChunk(ofstream& outputStream, uint64_t& position, int dataType, const PendingValues& pending, size_t first, ZoneMap& zoneMap) {
+            switch (dataType) {
+                case STRING_DATATYPE: return writeChunk(outputStream, position, pending.codes, first, StringDictionary::NULL_CODE, zoneMap);
+                case TIME_DATATYPE: return writeChunk(outputStream, position, pending.times, first, (int64_t) NULL_TIME, zoneMap);
+                case INTEGER_DATATYPE: return writeChunk(outputStream, position, pending.integers, first, (int32_t) NULL_INTEGER, zoneMap);
+                default: return writeChunk(outputStream, position, pending.floats, first, NULL_FLOAT, zoneMap);
+            }
+        }
+
+        // Write up to a zone of INTEGER (int32_t), FLOAT (float), TIME (int64_t) values or STRING codes (uint32_t) as one encoded block
+        template <typename T>
+        bool writeChunk(ofstream& outputStream, uint64_t& position, const vector<T>& values, size_t first, T null, ZoneMap& zoneMap) {
+            if (first >= values.size()) { return false; }
+            size_t count = min<size_t>(ZoneMap::ZONE_ROWS, values.size() - first);
+            for (size_t idx = first; idx < first + count; idx++) {
+                if (isNullValue(values[idx])) { zoneMap.addNull(); }
+                else if constexpr (is_same_v<T, uint32_t>) { zoneMap.addUnknown(); } // Dictionary codes do not order the strings
+                else { zoneMap.addValue(values[idx]); }
+            }
+            vector<char> block;
+            Segment::Encoding encoding = encodeBlock(values.data() + first, count, null, block);
+            zoneMap.setLastBlock(position, block.size(), encoding);
+            outputStream.write(block.data(), block.size());
+            position += block.size();
             return true;
         }
 
-        // private:
-        //     // Map of column names and data types
-        //     map<string, int> columnDataTypes;
+        // Encodes the values into a block and returns its encoding: INTEGER and TIME values are bit-packed (see PackedBlock), FLOAT values
+        // XOR encoded (see XorBlock) if compressFloatColumns and stored directly otherwise, and STRING codes run-length encoded (see RunBlock)
+        Segment::Encoding encodeBlock(const int32_t* values, size_t count, int32_t null, vector<char>& block) {
+            PackedBlock::encode(values, count, null, block);
+            return Segment::PACKED;
+        }
+
+        Segment::Encoding encodeBlock(const int64_t* values, size_t count, int64_t null, vector<char>& block) {
+            PackedBlock::encode(values, count, null, block);
+            return Segment::PACKED;
+        }
+
+        Segment::Encoding encodeBlock(const float* values, size_t count, float, vector<char>& block) {
+            if (!compressFloatColumns) {
+                block.insert(block.end(), (const char*) values, (const char*) (values + count));
+                return Segment::RAW;
+            }
+            XorBlock::encode(values, count, block);
+            return Segment::XOR;
+        }
+
+        Segment::Encoding encodeBlock(const uint32_t* codes, size_t count, uint32_t, vector<char>& block) {
+            RunBlock::encode(codes, count, block);
+            return Segment::RUNS;
+        }
+
+        // Decodes the values of the block of a zone, written by encodeBlock()
+        static void decodeBlock(const char* block, const ZoneMap::Zone&, int32_t null, int32_t* values) { PackedBlock::decode(block, null, values); }
+        static void decodeBlock(const char* block, const ZoneMap::Zone&, int64_t null, int64_t* values) { PackedBlock::decode(block, null, values); }
+        static void decodeBlock(const char* block, const ZoneMap::Zone& zone, float, float* values) {
+            if (zone.encoding == Segment::RAW) { memcpy(values, block, zone.rowCount * sizeof(float)); }
+            else { XorBlock::decode(block, values); }
+        }
+        static void decodeBlock(const char* block, const ZoneMap::Zone&, uint32_t, uint32_t* codes) { RunBlock::decode(block, codes); }
+
+        // Append the years, months and days of the values of a TIME column, the first of them being the row firstRow, to its calendar runs
+        void appendCalendar(Segment::Column& column, const ColumnBatch::Column& values, uint64_t firstRow) {
+            CalendarColumns calendar;
+            calendar.append(values.times, NULL_TIME);
+            RunBlock::appendRuns(column.years, calendar.years.data(), calendar.size(), firstRow);
+            RunBlock::appendRuns(column.months, calendar.months.data(), calendar.size(), firstRow);
+            RunBlock::appendRuns(column.days, calendar.days.data(), calendar.size(), firstRow);
+        }
+
+        // The dictionary of a STRING column in a segment, built from its entries in the footer. It never changes: appends encode into a copy,
+        // published together with the next segment (see appendColumns()), so readers decode the codes of their snapshot with its own dictionary
+        // The dictionaries of the segment of the store are built on first use and shared between all callers, those of older snapshots on every call
+        // Every block records the width of its codes, so the codes already stored stay as they are when the dictionary grows
+        shared_ptr<const StringDictionary> dictionaryFor(const Segment& snapshot, const string& column) {
+            auto build = [&]() {
+                const Segment::Column* stored = snapshot.column(column);
+                return make_shared<const StringDictionary>(stored ? StringDictionary(stored->dictionary) : StringDictionary());
+            };
+            lock_guard<mutex> lock(segmentMutex);
+            if (segment.get() != &snapshot) { return build(); }
+            shared_ptr<const StringDictionary>& dictionary = dictionaries[column];
+            if (!dictionary) { dictionary = build(); }
+            return dictionary;
+        }
+
+        // Path of the segment file holding the columns of the store, see Segment
+        string segmentPath() {
+            return getName() + "/segment";
+        }
+
+        // Path of the catalog of the store, see Catalog
+        string catalogPath() {
+            return getName() + "/catalog";
+        }
+
+        // Checksum of the whole file, read through in windows whose memory is handed back once they are summed
+        static uint64_t checksumOf(const ColumnFile& file) {
+            const size_t windowBytes = 64 << 20;
+            uint64_t checksum = Catalog::CHECKSUM_SEED;
+            for (size_t start = 0; start < file.size(); start += windowBytes) {
+                size_t length = min(windowBytes, file.size() - start);
+                checksum = Catalog::checksum(file.data() + start, length, checksum);
+                file.discard(start, length);
+            }
+            return checksum;
+        }
+
+        // Loads the catalog of the store, once, before its files are first read or written
+        // The formats it records are adopted, so that the files are read back the way they were written. An ingest the catalog records
+        // as unfinished is rolled back, see rollBackIngest(). A store whose catalog records other columns is cleared
+        // So is a segment file without a usable catalog, whose rows would otherwise be ingested again on top of themselves
+        // Bytes appended to the segment file after the size the catalog records are cut off, see appendColumns()
+        void openCatalog() {
+            if (catalogOpened.load(memory_order_acquire)) { return; }
+            lock_guard<mutex> lock(catalogMutex);
+            if (catalogOpened.load(memory_order_relaxed)) { return; }
+
+            filesystem::create_directories(getName());
+            optional<Catalog> stored = Catalog::load(catalogPath());
+            if (stored && stored->unfinishedIngest) {
+                string source = stored->unfinishedIngest->source;
+                if (rollBackIngest(*stored)) {
+                    cerr << "The ingest of " << source << " into " << getName() << " did not finish, it is undone." << endl;
+                } else {
+                    cerr << "The ingest of " << source << " into " << getName() << " did not finish, the store is cleared." << endl;
+                    clearFiles(*stored);
+                    stored.reset();
+                }
+            }
+            if (stored && !adoptFormats(*stored)) {
+                cerr << "The catalog of " << getName() << " does not match the columns of this store, the store is cleared." << endl;
+                clearFiles(*stored);
+                stored.reset();
+            } else if (!stored && filesystem::exists(segmentPath())) {
+                cerr << "The catalog of " << getName() << " is missing or cannot be read, the store is cleared." << endl;
+                clearFiles(Catalog());
+            } else if (stored && stored->segmentBytes > 0 && filesystem::exists(segmentPath()) && filesystem::file_size(segmentPath()) > stored->segmentBytes) {
+                // An append the catalog was not saved after, such as one cut short, only wrote after the bytes the catalog recorded
+                cerr << "An append to " << getName() << " did not finish, it is undone." << endl;
+                filesystem::resize_file(segmentPath(), stored->segmentBytes);
+            }
+            catalog = stored ? *stored : Catalog();
+            catalogOpened.store(true, memory_order_release);
+        }
+
+        // Cuts the segment file back to the size it had when the unfinished ingest of the catalog started, and saves the catalog with the rows
+        // the store held then. False if the file is shorter than that, then the rows of the ingest cannot be told apart from the others
+        // The segment file is not compacted during an ingest (see saveCatalog()), so the footer ending it then is still in place
+        bool rollBackIngest(Catalog& stored) {
+            bool exists = filesystem::exists(segmentPath());
+            if (stored.committedSegmentBytes == 0) { filesystem::remove(segmentPath()); }
+            else if (!exists || filesystem::file_size(segmentPath()) < stored.committedSegmentBytes) { return false; }
+            else { filesystem::resize_file(segmentPath(), stored.committedSegmentBytes); }
+            stored.rowCount = stored.committedRowCount;
+            stored.segmentBytes = stored.committedSegmentBytes;
+            stored.unfinishedIngest.reset();
+            stored.save(catalogPath());
+            return true;
+        }
+
+        // Takes on the formats of the columns recorded in the catalog, false if it has other columns or unknown formats
+        bool adoptFormats(const Catalog& stored) {
+            if (stored.columns.size() != columnDataTypes.size()) { return false; }
+            for (const Catalog::Column& column : stored.columns) {
+                auto registered = columnDataTypes.find(column.name);
+                if (registered == columnDataTypes.end() || registered->second != column.dataType || column.formatVersion != COLUMN_FORMAT_VERSION) { return false; }
+                if (column.dataType == FLOAT_DATATYPE) {
+                    if (column.format != "xor" && column.format != "raw") { return false; }
+                    compressFloatColumns = column.format == "xor";
+                }
+                if (column.format != columnFormat(column.dataType)) { return false; }
+            }
+            storeCalendarColumns = stored.calendarColumns;
+            return true;
+        }
+
+        // Removes the segment file and the catalog of the store
+        // Stores written before the segment file kept a file per column, those of the columns recorded in the catalog are removed as well
+        void clearFiles(const Catalog& stored) {
+            dropSegment();
+            for (const Catalog::Column& column : stored.columns) {
+                for (const char* suffix : {".store", ".zonemap", ".dict", ".year", ".month", ".day"}) {
+                    filesystem::remove(getName() + "/" + column.name + suffix);
+                }
+            }
+            filesystem::remove(segmentPath());
+            filesystem::remove(segmentPath() + ".tmp");
+            filesystem::remove(catalogPath());
+        }
+
+        // Writes the catalog, with the current formats, the number of rows held by every column and the size of the segment file
+        // The segment file has to end with a footer, see sealSegment()
+        // The segment file is compacted first if appends have left it holding more replaced bytes than live ones, unless an ingest
+        // is unfinished: rolling it back relies on the bytes before it staying where they are
+        void saveCatalog() {
+            openCatalog();
+            if (!catalog.unfinishedIngest) { compactSegment(); }
+            catalog.columns.clear();
+            for (auto& pair : columnDataTypes) {
+                catalog.columns.push_back(Catalog::Column{pair.first, pair.second, columnFormat(pair.second), COLUMN_FORMAT_VERSION});
+            }
+            sort(catalog.columns.begin(), catalog.columns.end(), [](const Catalog::Column& a, const Catalog::Column& b) { return a.name < b.name; });
+            shared_ptr<const Segment> current = segmentFor();
+            catalog.rowCount = rowCount(*current);
+            catalog.segmentBytes = current->file ? current->file->size() : 0;
+            catalog.calendarColumns = storeCalendarColumns;
+            catalog.save(catalogPath());
+        }
+
+        // Number of rows every column of the segment holds
+        uint64_t rowCount(const Segment& current) {
+            uint64_t count = UINT64_MAX;
+            for (auto& pair : columnDataTypes) {
+                const Segment::Column* stored = current.column(pair.first);
+                count = min<uint64_t>(count, stored ? stored->zoneMap.rowCount : 0);
+            }
+            return columnDataTypes.empty() ? 0 : count;
+        }
+
+        // Name of the format the values of a column of the data type are written in, recorded in the catalog
+        string columnFormat(int dataType) {
+            switch (dataType) {
+                case STRING_DATATYPE: return "runs"; // of dictionary codes, see RunBlock
+                case INTEGER_DATATYPE:
+                case TIME_DATATYPE: return "packed"; // see PackedBlock
+                default: return compressFloatColumns ? "xor" : "raw"; // see XorBlock
+            }
+        }
+
+        // The calendar runs holding the years, months or days (part) of a TIME column, read from the footer of the segment file
+        // nullptr if the column has none, or they do not cover every row of the column
+        shared_ptr<const vector<RunBlock::Run>> calendarRuns(const string& column, const string& part) {
+            if (isInvalidColumn(column) || columnDataTypes[column] != TIME_DATATYPE) { return nullptr; }
+            shared_ptr<const Segment> current = segmentFor();
+            const Segment::Column* stored = current->column(column);
+            if (!stored) { return nullptr; }
+            const vector<RunBlock::Run>& runs = part == "year" ? stored->years : part == "month" ? stored->months : stored->days;
+            if (runs.empty() || runs.back().end != stored->zoneMap.rowCount) { return nullptr; }
+            return shared_ptr<const vector<RunBlock::Run>>(current, &runs);
+        }
+
+        // The rows of the calendar runs holding the year, month or day
+        static Selection calendarRows(const vector<RunBlock::Run>& runs, int value) {
+            Selection rows;
+            uint32_t start = 0;
+            for (const RunBlock::Run& run : runs) {
+                if (run.value == (uint32_t) value) { rows.addRange(start, run.end); }
+                start = run.end;
+            }
+            return rows;
+        }
+
+        // The segment file of the store with its footer read, mapped on first use and shared until the store is written to
+        // Readers holding it keep reading the rows it had when they got it
+        // During an ingest, it locates the chunks appended since the footer ending the file, see appendColumns()
+        shared_ptr<const Segment> segmentFor() {
+            openCatalog();
+            lock_guard<mutex> lock(segmentMutex);
+            if (!segment) { segment = make_shared<const Segment>(Segment::open(segmentPath())); }
+            return segment;
+        }
+
+        // The stored column of a segment, nullptr if it has no rows yet
+        static const Segment::Column* storedColumn(const Segment& segment, const string& column) {
+            const Segment::Column* stored = segment.column(column);
+            return stored && segment.file && stored->zoneMap.rowCount > 0 ? stored : nullptr;
+        }
+
+        // The zone map of a column, from the footer of the segment file, empty if the column has no rows yet
+        // The chunks of the column are found through it, see appendColumns()
+        shared_ptr<const ZoneMap> zoneMapFor(const string& column) {
+            shared_ptr<const Segment> current = segmentFor();
+            const Segment::Column* stored = current->column(column);
+            if (!stored) { return make_shared<const ZoneMap>(); }
+            return shared_ptr<const ZoneMap>(current, &stored->zoneMap);
+        }
+
+        // Drops the segment file after it changed, readers still holding it keep their snapshot
+        // It is read again from the file on next use
+        void dropSegment() {
+            replaceSegment(nullptr);
+        }
+
+        // Replaces the segment of the store by the one locating the chunks just appended, readers still holding the old one keep their snapshot
+        // The dictionaries the append encoded into come with it, the others are built again on first use
+        // The pages of its mapping leave the BufferPool as soon as no reader has them pinned
+        void replaceSegment(shared_ptr<const Segment> next, unordered_map<string, shared_ptr<const StringDictionary>> nextDictionaries = {}) {
+            lock_guard<mutex> lock(segmentMutex);
+            if (segment && segment->file) { BufferPool::shared().release(*segment->file); }
+            segment = move(next);
+            dictionaries = move(nextDictionaries);
+            keptDictionaries.clear();
+        }
+
+        // Keeps the dictionary getValues() decoded views of a column from alive until the store is next written to
+        // The dictionary of the segment of the store lives until then anyway. One of an older snapshot, such as when a write replaced
+        // the segment during the call, would otherwise only live as long as the call
+        void keepDictionary(const string& column, shared_ptr<const StringDictionary> dictionary) {
+            lock_guard<mutex> lock(segmentMutex);
+            auto current = dictionaries.find(column);
+            if (current == dictionaries.end() || current->second != dictionary) { keptDictionaries.push_back(move(dictionary)); }
+        }
+
+        // The bytes [start, end) of the block of a zone in the segment file
+        static pair<uint64_t, uint64_t> zoneBytes(const ZoneMap& zoneMap, size_t zone) {
+            return {zoneMap.zones[zone].byteOffset, zoneMap.zones[zone].byteOffset + zoneMap.zones[zone].byteLength};
+        }
+
+        // Pins the pages of the shared BufferPool holding the block of a zone of the mapped segment file
+        static BufferPool::Pin pinZone(const ColumnFile& file, const ZoneMap& zoneMap, size_t zone) {
+            auto [start, end] = zoneBytes(zoneMap, zone);
+            return BufferPool::shared().pin(file, start, end - start);
+        }
+
+        // The zones holding any of the rows, in increasing order
+        static vector<size_t> zonesOf(const Selection& rows) {
+            vector<size_t> zones;
+            rows.forEachRun([&zones](uint32_t start, uint32_t end) {
+                for (size_t zone = start / ZoneMap::ZONE_ROWS; zone <= (end - 1) / ZoneMap::ZONE_ROWS; zone++) {
+                    if (zones.empty() || zones.back() != zone) { zones.push_back(zone); }
+                }
+            });
+            return zones;
+        }
+
+        // Calls process(zone, block) for each of the zones of a column in the mapped segment file, given in increasing order, as soon as its bytes are in memory
+        // Sparse rows would otherwise fault their pages in one at a time. Instead, the zones with pages missing from the BufferPool are read whole,
+        // neighbouring zones together, through the AsyncReader of the thread, many reads in flight, and decoded from the bytes read: block points
+        // into the buffer of the read. Their pages are pinned in the pool, as misses, before being read and until the zones of the window are done,
+        // so the pool's budget covers them and a later read of the zones finds them in the pool. Zones already in the pool are pinned and decoded
+        // from the mapping, block points into it.
+        // The reads go in windows of QUEUE_DEPTH reads, into one of two buffers, so the bytes held at once stay bounded and the zones of
+        // a window are decoded while the next one is read. Every zone is processed on a worker of the shared ThreadPool
+        template <typename Process>
+        static void readZones(const ColumnFile& file, const ZoneMap& zoneMap, const vector<size_t>& zones, Process process) {
+            // The reads covering the zones missing from the pool, each ending with a whole zone, and the zones of every read
+            vector<AsyncReader::Read> reads;
+            vector<vector<size_t>> zonesOfRead;
+            vector<size_t> zonesInPool;
+            for (size_t zone : zones) {
+                auto [start, end] = zoneBytes(zoneMap, zone);
+                bool inPool = true;
+                for (size_t page = start / BufferPool::PAGE_SIZE; inPool && page * BufferPool::PAGE_SIZE < end; page++) {
+                    inPool = BufferPool::shared().contains(file, page);
+                }
+                if (inPool) {
+                    zonesInPool.push_back(zone);
+                    continue;
+                }
+                uint64_t readEnd = reads.empty() ? 0 : reads.back().offset + reads.back().length;
+                if (!reads.empty() && start >= readEnd && start - readEnd < BufferPool::PAGE_SIZE && end - reads.back().offset <= AsyncReader::MAX_READ_BYTES) {
+                    reads.back().length = end - reads.back().offset;
+                } else {
+                    reads.push_back({file.descriptor(), start, end - start});
+                    zonesOfRead.emplace_back();
+                }
+                zonesOfRead.back().push_back(zone);
+            }
+
+            // Declared before the tasks, which refer to them, so that they outlive the tasks if a read or a task throws
+            vector<char> buffers[2];
+            vector<BufferPool::Pin> pins[2]; // of the zones of the window read into each buffer
+            atomic<bool> shortRead{false};
+            TaskGroup mappedTasks;
+            TaskGroup windowTasks[2];
+
+            for (size_t zone : zonesInPool) {
+                mappedTasks.run([&file, &zoneMap, &process, zone]() {
+                    BufferPool::Pin pin = pinZone(file, zoneMap, zone);
+                    process(zone, file.data() + zoneMap.zones[zone].byteOffset);
+                });
+            }
+
+            // A reader per thread, a thread only reads once at a time: with io_uring, the completions only queue tasks
+            static thread_local AsyncReader reader;
+            for (size_t first = 0, window = 0; first < reads.size(); first += AsyncReader::QUEUE_DEPTH, window++) {
+                vector<char>& buffer = buffers[window % 2];
+                TaskGroup& tasks = windowTasks[window % 2];
+                tasks.wait(); // The zones of the window before the last are done with the buffer
+                pins[window % 2].clear();
+
+                vector<AsyncReader::Read> windowReads(reads.begin() + first, reads.begin() + min(first + AsyncReader::QUEUE_DEPTH, reads.size()));
+                size_t bytes = 0;
+                for (const AsyncReader::Read& read : windowReads) { bytes += read.length; }
+                buffer.resize(bytes);
+                bytes = 0;
+                for (size_t read = 0; read < windowReads.size(); read++) {
+                    windowReads[read].buffer = buffer.data() + bytes;
+                    bytes += windowReads[read].length;
+                    for (size_t zone : zonesOfRead[first + read]) { pins[window % 2].push_back(pinZone(file, zoneMap, zone)); }
+                }
+                reader.readAll(windowReads, [&, first](size_t read, const char* bytesRead, size_t byteCount) {
+                    if (byteCount < windowReads[read].length) { // The reads in flight still write to the buffer, so the error waits for them
+                        shortRead = true;
+                        return;
+                    }
+                    for (size_t zone : zonesOfRead[first + read]) {
+                        const char* block = bytesRead + (zoneMap.zones[zone].byteOffset - windowReads[read].offset);
+                        tasks.run([&process, zone, block]() { process(zone, block); });
+                    }
+                });
+                if (shortRead) { throw runtime_error("The segment file ends within a zone"); }
+            }
+            windowTasks[0].wait();
+            windowTasks[1].wait();
+            mappedTasks.wait();
+        }
+
+        // Evaluates the predicate on the encoded block of a zone of an INTEGER, FLOAT or TIME column, zoneFirst being its first row,
+        // and adds the matching rows to the result
+        static void filterValues(const char* block, const ZoneMap::Zone& zone, uint32_t zoneFirst, int dataType, const Predicate& predicate, Selection& result) {
+            if (dataType == TIME_DATATYPE) { PackedBlock::filter(block, (int64_t) NULL_TIME, zoneFirst, predicate, result); }
+            else if (dataType == INTEGER_DATATYPE) { PackedBlock::filter(block, (int32_t) NULL_INTEGER, zoneFirst, predicate, result); }
+            else { // FLOAT values are compared once decoded
+                vector<float> decoded(zone.rowCount);
+                decodeBlock(block, zone, NULL_FLOAT, decoded.data());
+                for (uint32_t idx = 0; idx < decoded.size(); idx++) {
+                    if (predicate.matchesFloat(decoded[idx], isNullValue(decoded[idx]))) { result.add(zoneFirst + idx); }
+                }
+            }
+        }
+
+        // Adds the rows of the encoded block of a zone of a STRING column whose codes match to the result, a whole run at a time,
+        // zoneFirst being its first row
+        static void filterCodes(const char* block, uint32_t zoneFirst, const vector<bool>& matches, Selection& result) {
+            RunBlock::forEachRun(block, [&](uint32_t start, uint32_t end, uint32_t code) {
+                if (matches[code]) { result.addRange(zoneFirst + start, zoneFirst + end); }
+            });
+        }
+
+        // Whether a stored value is the null of its data type
+        static bool isNullValue(int32_t value) { return value == NULL_INTEGER; }
+        static bool isNullValue(float value) { return isnan(value); }
+        static bool isNullValue(int64_t value) { return value == NULL_TIME; }
+        static bool isNullValue(uint32_t code) { return code == StringDictionary::NULL_CODE; }
+
+        // Copies the values (or STRING codes) of the given indexes of a column of the data type from the decoded blocks of their zones, null past its end
+        // The segment they were read from is kept in snapshot, if given
+        template <typename T>
+        bool copyValues(string& column, const Selection& indexes, int dataType, T null, T* values, shared_ptr<const Segment>* snapshot = nullptr) {
+            if (!validationCheckForDataType(column, dataType)) { return false; }
+
+            try {
+                shared_ptr<const Segment> current = segmentFor();
+                if (snapshot) { *snapshot = current; }
+                const Segment::Column* stored = storedColumn(*current, column);
+                size_t count = stored ? stored->zoneMap.rowCount : 0;
+                Selection storedRows = indexes.upperBound() > count ? indexes & Selection::range(0, count) : indexes;
+                if (stored) {
+                    // Every zone is copied to its own part of values as soon as its block is in memory
+                    vector<size_t> zones = zonesOf(storedRows);
+                    vector<Selection> rowsOfZone(stored->zoneMap.zones.size());
+                    vector<size_t> firstValue(stored->zoneMap.zones.size());
+                    size_t copied = 0;
+                    for (size_t zone : zones) {
+                        rowsOfZone[zone] = storedRows.slice(stored->zoneMap.firstRow(zone), stored->zoneMap.firstRow(zone) + ZoneMap::ZONE_ROWS);
+                        firstValue[zone] = copied;
+                        copied += rowsOfZone[zone].cardinality();
+                    }
+                    readZones(*current->file, stored->zoneMap, zones, [&](size_t zone, const char* block) {
+                        T* zoneValues = values + firstValue[zone];
+                        forEachZoneRun(block, stored->zoneMap, zone, null, rowsOfZone[zone], [&zoneValues](uint32_t start, uint32_t end, const T* decoded) {
+                            zoneValues = copy(decoded, decoded + (end - start), zoneValues);
+                        });
+                    });
+                }
+                fill_n(values + storedRows.cardinality(), indexes.cardinality() - storedRows.cardinality(), null);
+                return true;
+            } catch (exception& e) {
+                cerr << e.what() << endl;
+            }
+            return false;
+        }
+
+        // Print the first n values of an INTEGER (int32_t), FLOAT (float) or TIME (int64_t) column, "M" for nulls
+        template <typename T>
+        void printValues(const string& column, int n) {
+            size_t count = min<size_t>(max(n, 0), zoneMapFor(column)->rowCount);
+            vector<T> values(count);
+            if (!getValues(column, Selection::range(0, count), values.data())) { return; }
+            for (T value : values) {
+                if (isNullValue(value)) { cout << "M,"; }
+                else { cout << value << ","; }
+            }
+        }
+
+        // Calls process(start, end, values) for the runs [start, end) of the rows of an INTEGER (int32_t), FLOAT (float),
+        // TIME (int64_t) or STRING (uint32_t codes) column, split at zone boundaries, values being the decoded values of the run. Each zone is decoded once
+        template <typename T, typename Process>
+        static void forEachBlockRun(const ColumnFile& file, const ZoneMap& zoneMap, T null, const Selection& rows, Process process) {
+            vector<T> decoded(ZoneMap::ZONE_ROWS);
+            size_t decodedZone = zoneMap.zones.size();
+            rows.forEachRun([&](uint32_t start, uint32_t end) {
+                while (start < end) {
+                    size_t zone = start / ZoneMap::ZONE_ROWS;
+                    uint32_t zoneFirst = zoneMap.firstRow(zone);
+                    uint32_t runEnd = min<uint32_t>(end, zoneFirst + zoneMap.zones[zone].rowCount);
+                    if (zone != decodedZone) {
+                        BufferPool::Pin pin = pinZone(file, zoneMap, zone);
+                        decodeBlock(file.data() + zoneMap.zones[zone].byteOffset, zoneMap.zones[zone], null, decoded.data());
+                        decodedZone = zone;
+                    }
+                    process(start, runEnd, decoded.data() + (start - zoneFirst));
+                    start = runEnd;
+                }
+            });
+        }
+
+        // Calls process(start, end, values) for the runs [start, end) of the rows of a zone of an INTEGER (int32_t), FLOAT (float),
+        // TIME (int64_t) or STRING (uint32_t codes) column, values being the values of the run decoded from the encoded block of the zone
+        template <typename T, typename Process>
+        static void forEachZoneRun(const char* block, const ZoneMap& zoneMap, size_t zone, T null, const Selection& rows, Process process) {
+            vector<T> decoded(zoneMap.zones[zone].rowCount);
+            decodeBlock(block, zoneMap.zones[zone], null, decoded.data());
+            uint32_t zoneFirst = zoneMap.firstRow(zone);
+            rows.forEachRun([&](uint32_t start, uint32_t end) { process(start, end, decoded.data() + (start - zoneFirst)); });
+        }
+
+        // The segment file, see segmentFor()
+        shared_ptr<const Segment> segment;
+        mutex segmentMutex;
+
+        // Dictionaries of the STRING columns in the segment, see dictionaryFor()
+        unordered_map<string, shared_ptr<const StringDictionary>> dictionaries;
 
-        //     // Vector of column names
-        //     vector<string> columnHeaders;
+        // Dictionaries of older snapshots getValues() decoded views from since the last write, see keepDictionary()
+        vector<shared_ptr<const StringDictionary>> keptDictionaries;
 
-        //     // Cast a value string to an appropriate object according to the column data type
-        //     Object* too(string column, string value) {
-        //         switch(columnDataTypes[column]) {
-        //             case STRING_DATATYPE: return reinterpret_cast<Object*>(new string(value));
-        //             case TIME_DATATYPE: return reinterpret_cast<Object*>(new chrono::system_clock::time_point(chrono::system_clock::from_time_t(stoi(value))));
-        //             case INTEGER_DATATYPE: return reinterpret_cast<Object*>(new int(stoi(value)));
-        //             case FLOAT_DATATYPE: return reinterpret_cast<Object*>(new float(stof(value)));
-        //             default: return nullptr;
-        //         }
-        //     }
+        // The catalog of the store, see openCatalog()
+        Catalog catalog;
+        atomic<bool> catalogOpened{false};
+        mutex catalogMutex;
 };
\ No newline at end of file
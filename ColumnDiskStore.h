@@ -1,7 +1,7 @@
+// ColumnDiskStore.h
+
 #ifndef COLUMN_DISK_STORE_H
 #define COLUMN_DISK_STORE_H
-// header file content goes here
-#endif
 
 #include <iostream>
 #include <fstream>
@@ -11,61 +11,287 @@
 #include <vector>
 #include <cfloat>
 #include <map>
+#include <string_view>
+#include <memory>
+#include <optional>
+#include <mutex>
+#include <atomic>
 #include "ColumnStoreAbstract.h"
+#include "MinMaxKernels.h"
+#include "ZoneMap.h"
+#include "ColumnFile.h"
+#include "StringDictionary.h"
+#include "CalendarColumns.h"
+#include "Morsels.h"
+#include "PackedBlock.h"
+#include "XorBlock.h"
+#include "RunBlock.h"
+#include "BufferPool.h"
+#include "AsyncReader.h"
+#include "Catalog.h"
+#include "Segment.h"
 
 using namespace std;
 
 class ColumnStoreDisk: public ColumnStoreAbstract {
     public:
-        // Constants for data types
-        static const int STRING_DATATYPE = 0;
-        static const int TIME_DATATYPE = 1;
-        static const int INTEGER_DATATYPE = 2;
-        static const int FLOAT_DATATYPE = 3;
-
-        // Buffer size when reading files
-        static const int BUFFER_SIZE = 10240;
-
-        // Date time format string
-        static const string DTFORMATSTRING;
+        // Whether FLOAT columns are XOR encoded (see XorBlock) rather than stored as raw 4 byte floats
+        // Set it before storing any data, a store holding data goes on writing them the way its catalog says they were written
+        bool compressFloatColumns = true;
 
         // Constructor
         ColumnStoreDisk(unordered_map<string, int> columnDataTypes);
 
-        // Write an appropriate value to the outputStream given the column string and value string
-        void store(ofstream& outputStream, string column, string value);
-
         // Write a value to a file given the column and value strings
+        // Every call is committed on its own, footer and syncs included, so values are better stored many at a time
         void store(string column, string value) override;
 
         // Write multiple values to multiple files given a buffer of columns and values
-        void storeAll(unordered_map<string, vector<string>> buffer) override;
+        void storeAll(const unordered_map<string, vector<string>>& buffer) override;
 
-        // Append 4 bytes to the file representing an int
-        void handleStoreInteger(ofstream& fileOutputStream, int value);
+        // Write a batch of parsed rows to the segment file, the typed values are written without being converted again
+        // During the ingest of a CSV file only its chunks are written, the footer and the catalog once the ingest finishes
+        // Throws if the batch cannot be written, see addCSVData()
+        void storeBatch(const ColumnBatch& batch) override;
 
-        // Append 4 bytes to the file representing a float
-        void handleStoreFloat(ofstream& fileOutputStream, float value);
+        // Number of rows every column of the store holds, including those of an ingest that has not finished yet
+        uint64_t getRowCount();
 
         // Filter a column by a predicate and return a list of row indexes that satisfy it
-        vector<int> filter(string column, bool predicate) override;
+        Selection filter(string column, const Predicate& predicate) override;
 
         // Filter a column by a predicate and a list of row indexes to check and return a list of row indexes that satisfy it
-        vector<int> filter(string column, bool predicate, vector<int> indexesToCheck) override;
+        Selection filter(string column, const Predicate& predicate, const Selection& indexesToCheck) override;
+
+        // Filter a TIME column by year, adding the runs of rows holding the year
+        Selection filterYear(string column, int year) override;
+
+        // Filter the given indexes of a TIME column by month, intersecting them with the runs of the year and the month
+        Selection filterMonth(string column, int year, int month, const Selection& indexesToCheck) override;
 
         // Get the maximum value(s) of a column from a list of row indexes to check and return a list of row indexes that have the maximum value
-        vector<int> getMax(string column, vector<int> indexesToCheck);
+        Selection getMax(string column, const Selection& indexesToCheck);
 
         // Get the minimum value(s) of a column from a list of row indexes to check and return a list of row indexes that have the minimum value
-        vector<int> getMin(string column, vector<int> indexesToCheck);
+        Selection getMin(string column, const Selection& indexesToCheck);
 
         // Get the name of the column store
         string getName();
 
-        // Get the value of a column at a given row index
-        Object* getValue(string column, int index);
+        // Get the value of a column at a given row index, nullopt if it is null
+        optional<Object> getValue(string column, int index) override;
+
+        // Get the values of the given indexes of a column, each zone holding some of them is decoded once
+        using ColumnStoreAbstract::getValues;
+        bool getValues(string column, const Selection& indexes, int32_t* values) override;
+        bool getValues(string column, const Selection& indexes, float* values) override;
+        bool getValues(string column, const Selection& indexes, int64_t* values) override;
+        // STRING values are views valid until the store is next written to, even if a write replaces the segment meanwhile
+        bool getValues(string column, const Selection& indexes, string_view* values) override;
 
         // Print the first n values of each column
         void printHead(int n);
+
+    protected:
+        // Skips a CSV file whose rows the store holds already, a file with the same size and checksum
+        // Otherwise the ingest is recorded in the catalog until it finishes, with the rows and the size of the segment file it starts from
+        bool startIngest(const string& filepath, const ColumnFile& file) override;
+
+        // Writes the footer locating the chunks of the ingest of a CSV file, and records the finished ingest in the catalog
+        void finishIngest(const string& filepath, const ColumnFile& file, size_t rowCount) override;
+
+        // Rolls the store back to the rows it held before the ingest of a CSV file started, the store is cleared if it cannot be
+        void abortIngest(const string& filepath, const ColumnFile& file) override;
+
+        // Computes the minimum and maximum of the INTEGER or FLOAT values of the given indexes in one pass over the mapped segment file
+        // Zones that cannot hold the requested extremes are skipped using the zone map, the others are scanned in parallel morsels
+        template <typename T>
+        MinMax<T> scanMinMax(string& column, const Selection& indexesToCheck, bool needMin = true, bool needMax = true);
+
+    private:
+        // Version of the layout of the files of the store, recorded in the catalog (see columnFormat())
+        // Version 2 keeps every column in a single segment file, see Segment
+        // Version 3 stores null times as NULL_TIME = LLONG_MIN, version 2 stored them as 0 (1970-01-01 00:00)
+        static const int COLUMN_FORMAT_VERSION = 3;
+
+        // Values of a column to be written from a row group on, see appendColumns()
+        struct PendingValues {
+            vector<int32_t> integers;
+            vector<float> floats;
+            vector<int64_t> times;
+            vector<uint32_t> codes; // of STRING values
+        };
+
+        // Append parsed values to their columns in the segment file, keeping their zone maps up to date in the segment of the store
+        // The chunks of the appended columns from the first row group one of them has not filled yet are encoded again together with
+        // the new values, and written after the end of the file, whose bytes never change. No footer locates them until sealSegment()
+        void appendColumns(const vector<ColumnBatch::Column>& appended);
+
+        // Ends the segment file with a footer locating the chunks appended since the last one, if any, and syncs it
+        void sealSegment();
+
+        // Writes the segment file again without the chunks and footers appends have replaced, once they take up more bytes than the rest
+        void compactSegment();
+
+        // Flushes the bytes written to the file to the device
+        static void syncFile(const string& filepath);
+
+        // The rows of a column from the row group firstGroup on, followed by the new values, STRING values as codes of the dictionary they are added to
+        PendingValues pendingValues(const Segment& segment, const ColumnBatch::Column& values, size_t firstGroup, StringDictionary* dictionary);
+
+        // Appends the decoded rows of a stored column from the row group firstGroup on to the values
+        template <typename T>
+        static void decodeRows(const Segment& segment, const Segment::Column* stored, size_t firstGroup, T null, vector<T>& values);
+
+        // Write the chunk of the pending values of a column in a row group, starting at the value first, false if there is none
+        // The zone map records where it is, position being where the stream is
+        bool writeChunk(ofstream& outputStream, uint64_t& position, int dataType, const PendingValues& pending, size_t first, ZoneMap& zoneMap);
+
+        // Write up to a zone of INTEGER (int32_t), FLOAT (float), TIME (int64_t) values or STRING codes (uint32_t) as one encoded block
+        template <typename T>
+        bool writeChunk(ofstream& outputStream, uint64_t& position, const vector<T>& values, size_t first, T null, ZoneMap& zoneMap);
+
+        // Encodes the values into a block and returns its encoding: INTEGER and TIME values are bit-packed (see PackedBlock), FLOAT values
+        // XOR encoded (see XorBlock) if compressFloatColumns and stored directly otherwise, and STRING codes run-length encoded (see RunBlock)
+        Segment::Encoding encodeBlock(const int32_t* values, size_t count, int32_t null, vector<char>& block);
+        Segment::Encoding encodeBlock(const int64_t* values, size_t count, int64_t null, vector<char>& block);
+        Segment::Encoding encodeBlock(const float* values, size_t count, float null, vector<char>& block);
+        Segment::Encoding encodeBlock(const uint32_t* codes, size_t count, uint32_t null, vector<char>& block);
+
+        // Decodes the values of the block of a zone, written by encodeBlock()
+        static void decodeBlock(const char* block, const ZoneMap::Zone& zone, int32_t null, int32_t* values);
+        static void decodeBlock(const char* block, const ZoneMap::Zone& zone, int64_t null, int64_t* values);
+        static void decodeBlock(const char* block, const ZoneMap::Zone& zone, float null, float* values);
+        static void decodeBlock(const char* block, const ZoneMap::Zone& zone, uint32_t null, uint32_t* codes);
+
+        // Append the years, months and days of the values of a TIME column, the first of them being the row firstRow, to its calendar runs
+        void appendCalendar(Segment::Column& column, const ColumnBatch::Column& values, uint64_t firstRow);
+
+        // The dictionary of a STRING column in a segment, which never changes: appends encode into a copy published with the next segment
+        // Those of the segment of the store are built from the footer on first use and shared between all callers
+        shared_ptr<const StringDictionary> dictionaryFor(const Segment& snapshot, const string& column);
+
+        // Path of the segment file holding the columns of the store, see Segment
+        string segmentPath();
+
+        // Path of the catalog of the store, see Catalog
+        string catalogPath();
+
+        // Checksum of the whole file, read through in windows whose memory is handed back once they are summed
+        static uint64_t checksumOf(const ColumnFile& file);
+
+        // Loads the catalog of the store once, before its files are first read or written, and adopts the formats it records
+        // An ingest the catalog records as unfinished is rolled back, a store whose catalog records other columns is cleared
+        // Bytes appended to the segment file after the size the catalog records are cut off
+        void openCatalog();
+
+        // Cuts the segment file back to the size it had when the unfinished ingest of the catalog started, and saves the catalog with the rows
+        // the store held then. False if the file is shorter than that, then the rows of the ingest cannot be told apart from the others
+        bool rollBackIngest(Catalog& stored);
+
+        // Takes on the formats of the columns recorded in the catalog, false if it has other columns or unknown formats
+        bool adoptFormats(const Catalog& stored);
+
+        // Removes the segment file and the catalog of the store, and the files of the columns recorded in a catalog written before the segment file
+        void clearFiles(const Catalog& stored);
+
+        // Writes the catalog, with the current formats, the number of rows held by every column and the size of the segment file
+        // The segment file has to end with a footer, see sealSegment()
+        // The segment file is compacted first if appends have left it holding more replaced bytes than live ones, unless an ingest is unfinished
+        void saveCatalog();
+
+        // Number of rows every column of the segment holds
+        uint64_t rowCount(const Segment& current);
+
+        // Name of the format the values of a column of the data type are written in, recorded in the catalog
+        string columnFormat(int dataType);
+
+        // The calendar runs holding the years, months or days (part) of a TIME column, read from the footer of the segment file
+        // nullptr if the column has none, or they do not cover every row of the column
+        shared_ptr<const vector<RunBlock::Run>> calendarRuns(const string& column, const string& part);
+
+        // The rows of the calendar runs holding the year, month or day
+        static Selection calendarRows(const vector<RunBlock::Run>& runs, int value);
+
+        // The segment file of the store with its footer read, mapped on first use and shared until the store is written to
+        // During an ingest, it locates the chunks appended since the footer ending the file
+        shared_ptr<const Segment> segmentFor();
+
+        // The stored column of a segment, nullptr if it has no rows yet
+        static const Segment::Column* storedColumn(const Segment& segment, const string& column);
+
+        // The zone map of a column, from the footer of the segment file, empty if the column has no rows yet
+        shared_ptr<const ZoneMap> zoneMapFor(const string& column);
+
+        // Drops the segment file after it changed, and its unpinned pages from the BufferPool
+        void dropSegment();
+
+        // Replaces the segment of the store by the one locating the chunks just appended, and its dictionaries by those they were encoded into
+        void replaceSegment(shared_ptr<const Segment> next, unordered_map<string, shared_ptr<const StringDictionary>> nextDictionaries = {});
+
+        // Keeps the dictionary getValues() decoded views of a column from alive until the store is next written to
+        void keepDictionary(const string& column, shared_ptr<const StringDictionary> dictionary);
+
+        // The bytes [start, end) of the block of a zone in the segment file
+        static pair<uint64_t, uint64_t> zoneBytes(const ZoneMap& zoneMap, size_t zone);
+
+        // Pins the pages of the shared BufferPool holding the block of a zone of the mapped segment file
+        static BufferPool::Pin pinZone(const ColumnFile& file, const ZoneMap& zoneMap, size_t zone);
+
+        // The zones holding any of the rows, in increasing order
+        static vector<size_t> zonesOf(const Selection& rows);
+
+        // Calls process(zone, block) for each of the zones, given in increasing order, on a worker as soon as its bytes are in memory
+        // The zones with pages missing from the BufferPool are read whole, in windows of coalesced reads through the AsyncReader of the thread,
+        // and block points into the buffer of the read, their pages pinned in the BufferPool until the window is done, so later reads find them there.
+        // Zones in the pool are pinned while processed and block points into the mapping
+        template <typename Process>
+        static void readZones(const ColumnFile& file, const ZoneMap& zoneMap, const vector<size_t>& zones, Process process);
+
+        // Evaluates the predicate on the encoded block of a zone of an INTEGER, FLOAT or TIME column, zoneFirst being its first row
+        static void filterValues(const char* block, const ZoneMap::Zone& zone, uint32_t zoneFirst, int dataType, const Predicate& predicate, Selection& result);
+
+        // Adds the rows of the encoded block of a zone of a STRING column whose codes match to the result, a whole run at a time
+        static void filterCodes(const char* block, uint32_t zoneFirst, const vector<bool>& matches, Selection& result);
+
+        // Whether a stored value is the null of its data type
+        static bool isNullValue(int32_t value);
+        static bool isNullValue(float value);
+        static bool isNullValue(int64_t value);
+        static bool isNullValue(uint32_t code);
+
+        // Copies the values (or STRING codes) of the given indexes of a column of the data type from the decoded blocks of their zones, null past its end
+        // The segment they were read from is kept in snapshot, if given
+        template <typename T>
+        bool copyValues(string& column, const Selection& indexes, int dataType, T null, T* values, shared_ptr<const Segment>* snapshot = nullptr);
+
+        // Print the first n values of an INTEGER (int32_t), FLOAT (float) or TIME (int64_t) column, "M" for nulls
+        template <typename T>
+        void printValues(const string& column, int n);
+
+        // Calls process(start, end, values) for the runs [start, end) of the rows of an INTEGER (int32_t), FLOAT (float),
+        // TIME (int64_t) or STRING (uint32_t codes) column, split at zone boundaries, values being the decoded values of the run
+        template <typename T, typename Process>
+        static void forEachBlockRun(const ColumnFile& file, const ZoneMap& zoneMap, T null, const Selection& rows, Process process);
+
+        // Calls process(start, end, values) for the runs [start, end) of the rows of a zone, values being decoded from the encoded block of the zone
+        template <typename T, typename Process>
+        static void forEachZoneRun(const char* block, const ZoneMap& zoneMap, size_t zone, T null, const Selection& rows, Process process);
+
+        // The segment file, see segmentFor()
+        shared_ptr<const Segment> segment;
+        mutex segmentMutex;
+
+        // Dictionaries of the STRING columns in the segment, see dictionaryFor()
+        unordered_map<string, shared_ptr<const StringDictionary>> dictionaries;
+
+        // Dictionaries of older snapshots getValues() decoded views from since the last write, see keepDictionary()
+        vector<shared_ptr<const StringDictionary>> keptDictionaries;
+
+        // The catalog of the store, see openCatalog()
+        Catalog catalog;
+        atomic<bool> catalogOpened{false};
+        mutex catalogMutex;
 };
 
+#endif
@@ -0,0 +1,44 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include "ColumnFile.h"
+
+using namespace std;
+
+ColumnFile::ColumnFile(int fd, const char* bytes, size_t length) : fd(fd), bytes(bytes), length(length) {}
+
+shared_ptr<const ColumnFile> ColumnFile::open(const string& filepath) {
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) { return nullptr; }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    size_t length = status.st_size;
+    void* bytes = nullptr;
+    if (length > 0) { // an empty file cannot be mapped, but is a valid column without values
+        bytes = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (bytes == MAP_FAILED) {
+            close(fd);
+            return nullptr;
+        }
+    }
+    return shared_ptr<const ColumnFile>(new ColumnFile(fd, (const char*) bytes, length));
+}
+
+ColumnFile::~ColumnFile() {
+    if (length > 0) { munmap((void*) bytes, length); }
+    close(fd);
+}
+
+void ColumnFile::discard(size_t offset, size_t byteCount) const {
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t start = (offset + pageSize - 1) / pageSize * pageSize; // only the pages entirely within the range
+    size_t end = min(offset + byteCount, length) / pageSize * pageSize;
+    if (start < end) { madvise((void*) (bytes + start), end - start, MADV_DONTNEED); }
+}
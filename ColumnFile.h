@@ -0,0 +1,69 @@
+// ColumnFile.h
+
+#ifndef COLUMNFILE_H
+#define COLUMNFILE_H
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+// A read-only memory mapping of a column file.
+//
+// A column file is mapped once and shared between threads through a shared_ptr. Reads go
+// straight to the OS page cache without copying, so a point lookup is a pointer dereference
+// instead of an open/seekg/read.
+//
+// The mapping is a snapshot of the file when it was opened: values appended later are not
+// visible, so stores drop their mapping of a column whenever they write to it.
+//
+// How much of the mapping stays in memory is bounded by the BufferPool its readers pin pages of.
+class ColumnFile : public enable_shared_from_this<ColumnFile> {
+    public:
+        // Maps the whole file, nullptr if it cannot be opened.
+        static shared_ptr<const ColumnFile> open(const string& filepath);
+
+        ~ColumnFile();
+
+        ColumnFile(const ColumnFile&) = delete;
+        ColumnFile& operator=(const ColumnFile&) = delete;
+
+        const char* data() const { return bytes; }
+
+        // File descriptor of the file, open as long as the mapping, for reads bypassing the mapping (see AsyncReader).
+        int descriptor() const { return fd; }
+
+        // Size of the file in bytes.
+        size_t size() const { return length; }
+
+        // Number of fixed width values of type T in the file.
+        template <typename T>
+        size_t count() const { return length / sizeof(T); }
+
+        // The file as an array of count<T>() fixed width values.
+        template <typename T>
+        const T* values() const { return reinterpret_cast<const T*>(bytes); }
+
+        // The index-th fixed width value, index must be less than count<T>().
+        template <typename T>
+        T at(size_t index) const {
+            T value;
+            memcpy(&value, bytes + index * sizeof(T), sizeof(T));
+            return value;
+        }
+
+        // Tells the OS that the bytes [offset, offset + byteCount) are not needed anymore, so that the pages
+        // holding them can leave the memory of the process. They are read from the file again if accessed.
+        void discard(size_t offset, size_t byteCount) const;
+
+    private:
+        ColumnFile(int fd, const char* bytes, size_t length);
+
+        int fd;
+        const char* bytes;
+        size_t length;
+};
+
+#endif
@@ -7,10 +7,50 @@
 #include <ctime>
 #include <sstream>
 #include <fstream>
-
+#include <iomanip>
+#include <climits>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <memory>
+#include <thread>
+#include <charconv>
+#include <string_view>
+#include <algorithm>
+#include "Predicate.h"
+#include "Selection.h"
+#include "ColumnBatch.h"
+#include "ColumnFile.h"
+#include "TimeFormat.h"
+#include "ThreadPool.h"
 
 using namespace std;
 
+// A class representing an object that can hold different types of values
+class Object {
+    public:
+        enum Type {NONE, STRING, INT, FLOAT, TIME, BOOL};
+
+        Type type;
+        string sval;
+        int ival = 0;
+        float fval = 0;
+        long long tval = 0; // TIME as epoch seconds
+        bool flag = false;
+
+        Object() : type(NONE) {}
+
+        Object(string s) : type(STRING), sval(s) {}
+
+        Object(int i) : type(INT), ival(i) {}
+
+        Object(float f) : type(FLOAT), fval(f) {}
+
+        Object(long long t) : type(TIME), tval(t) {}
+
+        Object(bool flag) : type(BOOL), flag(flag) {}
+};
+
 // An abstract class representing a column store.
 class ColumnStoreAbstract {
     public:
@@ -20,6 +60,16 @@ class ColumnStoreAbstract {
         static const int TIME_DATATYPE = 3;
         static const string DTFORMATSTRING;
 
+        // Sentinel values used by the typed storages to represent null ("M" or empty) cells.
+        static const int NULL_INTEGER = INT_MIN;
+        static constexpr float NULL_FLOAT = numeric_limits<float>::quiet_NaN();
+        static const long long NULL_TIME = LLONG_MIN;
+
+        // Default limits of addCSVData(): parsed rows are stored in batches of at most DEFAULT_CSV_BATCH_ROWS rows,
+        // and at most DEFAULT_CSV_BATCH_MEGABYTES of CSV text is parsed before its batches are stored.
+        static const size_t DEFAULT_CSV_BATCH_ROWS = 1 << 16;
+        static const size_t DEFAULT_CSV_BATCH_MEGABYTES = 64;
+
         // The registered column headers with this column store.
         unordered_set<string> columnHeaders;
 
@@ -32,6 +82,10 @@ class ColumnStoreAbstract {
         // TIME_DATATYPE.
         unordered_map<string, int> columnDataTypes;
 
+        // Whether the year, month and day of every TIME value are stored as well (see CalendarColumns),
+        // so that filterYear() and filterMonth() compare them instead of the epoch seconds. Set it before storing any data.
+        bool storeCalendarColumns = true;
+
         // User has to specify, for each column, 1. the column name 2. the corresponding data type.
         ColumnStoreAbstract(unordered_map<string, int> columnDataTypes) {
             this->columnDataTypes = columnDataTypes;
@@ -41,94 +95,207 @@ class ColumnStoreAbstract {
             }
         }
 
-        ColumnStoreAbstract(unordered_map<string, int> columnDataTypes);
+        // Stores are deleted through pointers to this class.
+        virtual ~ColumnStoreAbstract() = default;
 
-        // Parses the CSV file and stores into the column store, using storeAll()
+        // Parses the CSV file and stores into the column store, using storeBatch()
+        // See addCSVData(filepath, batchRows, batchMegabytes), with the default batch limits.
         void addCSVData(string filepath) {
-            const string separator = ",";
-            ifstream file(filepath);
-            if (!file.is_open()) {
+            addCSVData(filepath, DEFAULT_CSV_BATCH_ROWS, DEFAULT_CSV_BATCH_MEGABYTES);
+        }
+
+        // Parses the CSV file and stores into the column store, using storeBatch()
+        // The file is memory mapped and streamed through in windows of batchMegabytes of text. Each window is split at
+        // line boundaries into one chunk per hardware thread, and each chunk is tokenized without copying and parsed
+        // straight into typed batches of at most batchRows rows. The batches of a window are stored in file order before
+        // the next window is parsed, so memory use depends on the batch limits and not on the size of the file.
+        void addCSVData(string filepath, size_t batchRows, size_t batchMegabytes) {
+            shared_ptr<const ColumnFile> file = ColumnFile::open(filepath);
+            if (!file) {
                 cout << "could not csv decode file: no column headers" << endl;
                 return;
             }
 
-            string line;
-            if (!getline(file, line)) {
+            string_view text(file->data(), file->size());
+            size_t headerEnd = min(text.find('\n'), text.size());
+            string_view headerLine = trimLineEnd(text.substr(0, headerEnd));
+            if (headerLine.empty()) {
                 cout << "could not csv decode file: no column headers" << endl;
                 return;
             }
 
-            vector<string> incomingColumnHeaders = split(line, separator); //get the column headers
+            vector<string> incomingColumnHeaders; //get the column headers
+            for (string_view header : splitView(headerLine, ',')) {
+                incomingColumnHeaders.push_back(string(header));
+            }
             if (columnHeaders != unordered_set<string>(incomingColumnHeaders.begin(), incomingColumnHeaders.end())) {
                 cout << "Incoming CSV data has different format from current csv data" << endl;
                 return;
             }
-            unordered_map<string, vector<string>> buffer;
-            for (string& column : incomingColumnHeaders) {
-                buffer[column] = vector<string>();
+            if (!startIngest(filepath, *file)) {
+                return;
             }
 
-            while (getline(file, line)) {
-                vector<string> nextDatum = split(line, separator);
-                int i = 0;
-                while (i < nextDatum.size()) {
-                    if (i >= incomingColumnHeaders.size()) { //means this datum has more columns that what is provided, skip to next line
-                        break;
+            size_t rowCount = 0;
+            batchRows = max<size_t>(batchRows, 1);
+            size_t windowBytes = max<size_t>(batchMegabytes, 1) << 20;
+            size_t start = min(headerEnd + 1, text.size());
+            while (start < text.size()) {
+                // The window ends at the first newline after windowBytes, so that no line is split
+                size_t end = windowBytes < text.size() - start ? min(text.find('\n', start + windowBytes), text.size()) : text.size();
+                vector<ColumnBatch> batches = parseCSVWindow(text.substr(start, end - start), incomingColumnHeaders, batchRows);
+                try {
+                    for (ColumnBatch& batch : batches) {
+                        storeBatch(batch);
+                        rowCount += batch.rowCount;
                     }
-
-                    string value = nextDatum[i];
-                    string column = incomingColumnHeaders[i];
-                    buffer[column].push_back(value);
-                    i++;
-                }
-
-                while (i < incomingColumnHeaders.size()) { //means this datum has less columns that what is provided, add null values
-                    buffer[incomingColumnHeaders[i]].push_back("M");
-                    i++;
+                } catch (exception& e) {
+                    // Not finished, so that the store can tell the rows stored so far from those of finished ingests
+                    cerr << e.what() << endl;
+                    cerr << "The ingest of " << filepath << " into " << getName() << " stopped after " << rowCount << " rows." << endl;
+                    abortIngest(filepath, *file);
+                    return;
                 }
+                file->discard(start, end - start); // the batches held views into the window, they are stored now
+                start = end + 1;
             }
-
-            storeAll(buffer);
-            file.close();
+            finishIngest(filepath, *file, rowCount);
         }
 
         // Given a value string and the corresponding column, store into data storage.
         virtual void store(string column, string value) = 0;
 
         // Given a map of columns to its values (in String), store all into the data storage.
-        virtual void storeAll(unordered_map<string, vector<string>> buffer) = 0;
+        virtual void storeAll(const unordered_map<string, vector<string>>& buffer) = 0;
+
+        // Given a batch of parsed rows, store all its columns into the data storage.
+        // Throws if the batch cannot be stored, addCSVData() then leaves the ingest of its file unfinished.
+        virtual void storeBatch(const ColumnBatch& batch) = 0;
 
         // Scans all the indexes of the column and returns the indexes whose values match the predicate.
-        virtual vector<int> filter(string column, function<bool(Object)> predicate) = 0;
+        // Indexes are passed between the stages of a query as a compressed Selection.
+        // Nothing matches, and an error is printed, when a literal of the predicate cannot be compared with the values of the column.
+        virtual Selection filter(string column, const Predicate& predicate) = 0;
 
         // Scans the given indexes of the column and returns the indexes whose values match the predicate.
-        virtual vector<int> filter(string column, function<bool(Object)> predicate, vector<int> indexesToCheck) = 0;
+        virtual Selection filter(string column, const Predicate& predicate, const Selection& indexesToCheck) = 0;
+
+        // Scans all the indexes of the TIME column and returns the indexes whose values lie in the year.
+        // Stores keeping calendar columns override this to compare the stored years instead.
+        virtual Selection filterYear(string column, int year) {
+            return filter(column, Predicate::halfOpenRange(toEpoch(year, 1, 1), toEpoch(year + 1, 1, 1)));
+        }
+
+        // Scans the given indexes of the TIME column and returns the indexes whose values lie in the month (1-12) of the year.
+        // Stores keeping calendar columns override this to compare the stored years and months instead.
+        virtual Selection filterMonth(string column, int year, int month, const Selection& indexesToCheck) {
+            return filter(column, Predicate::halfOpenRange(toEpoch(year, month, 1), toEpoch(year, month + 1, 1)), indexesToCheck);
+        }
 
         // Scans the given indexes of the column and returns the indexes whose values are the largest among all the scanned values.
         //
         // The implementation by extending classes is recommended to perform a validation check to ensure column type is a number.
-        virtual vector<int> getMax(string column, vector<int> indexesToCheck) = 0;
+        virtual Selection getMax(string column, const Selection& indexesToCheck) = 0;
 
         // Scans the given indexes of the column and returns the indexes whose values are the smallest among all the scanned values.
         //
         // The implementation by extending classes is recommended to perform a validation check to ensure column type is a number.
-        virtual vector<int> getMin(string column, vector<int> indexesToCheck) = 0;
+        virtual Selection getMin(string column, const Selection& indexesToCheck) = 0;
 
         // Returns the name of this column store.
         virtual string getName() = 0;
 
-        // Gets the value from a column based on the index.
-        virtual Object* getValue(string column, int index) = 0;
+        // Gets the value from a column based on the index, nullopt if the cell is null or the index is out of bounds.
+        // The value is returned by value, nothing has to be freed. Use getValues() to read many indexes.
+        virtual optional<Object> getValue(string column, int index) = 0;
+
+        // Fills values[i] with the value of the i-th of the given indexes of an INTEGER, FLOAT, TIME (epoch seconds) or STRING column,
+        // values having room for indexes.cardinality() values. Runs of consecutive indexes are read at once and nothing is allocated per index.
+        // Null cells, and indexes past the end of the column, read as null ("M" for STRING). STRING values are views into the store,
+        // valid until the column is stored into again. Returns false if the column is not registered or holds another data type.
+        virtual bool getValues(string column, const Selection& indexes, int32_t* values) = 0;
+        virtual bool getValues(string column, const Selection& indexes, float* values) = 0;
+        virtual bool getValues(string column, const Selection& indexes, int64_t* values) = 0;
+        virtual bool getValues(string column, const Selection& indexes, string_view* values) = 0;
+
+        // Gets the values of the given indexes of the column, appended to the vector of values matching its data type (see ColumnBatch).
+        void getValues(string column, const Selection& indexes, ColumnBatch::Column& values) {
+            switch (values.dataType) {
+                case INTEGER_DATATYPE: appendValues(column, indexes, values.integers); break;
+                case FLOAT_DATATYPE: appendValues(column, indexes, values.floats); break;
+                case TIME_DATATYPE: appendValues(column, indexes, values.times); break;
+                default: appendValues(column, indexes, values.strings);
+            }
+        }
 
         // Prints the head of the data (i.e. from index 0) until the specified index.
         virtual void printHead(int until) = 0;
 
+        // Returns the epoch seconds of the start of the given day, in the same wall-clock seconds TIME values are stored as.
+        // Useful for building TIME predicates, e.g. a year is [toEpoch(y, 1, 1), toEpoch(y + 1, 1, 1)).
+        static long long toEpoch(int year, int month, int day) {
+            return TimeFormat::toEpoch(year, month, day); // month 13 is January of the next year
+        }
+
+        // Useful in getMax() and getMin() functions.
+        // So that code does not have to be repeated.
+        bool validationCheckForMinMax(string column) {
+            if (isInvalidColumn(column)) {
+                cout << "Column is not registered with this column store." << endl;
+                return false;
+            }
+
+            if (isNotNumberDataType(column)) {
+                cout << "Cannot perform get max operation on a column whose data are not numbers." << endl;
+                return false;
+            }
+
+            return true;
+        }
+
+        // Useful in getValues() functions: whether the column is registered and holds values of the data type
+        bool validationCheckForDataType(string column, int dataType) {
+            if (isInvalidColumn(column)) {
+                cout << "Column is not registered with this column store." << endl;
+                return false;
+            }
+
+            if (columnDataTypes[column] != dataType) {
+                cout << "Cannot read the values of a column into a buffer of another data type." << endl;
+                return false;
+            }
+
+            return true;
+        }
+
     protected:
+        // Called by addCSVData() once the headers of the file are checked, before any of its rows are stored.
+        // Returns false to skip the file, e.g. when a persistent store holds its rows already.
+        virtual bool startIngest(const string&, const ColumnFile&) {
+            return true;
+        }
+
+        // Called by addCSVData() once all rowCount rows of the file are stored, not if storing one of its batches failed.
+        virtual void finishIngest(const string&, const ColumnFile&, size_t) {}
+
+        // Called by addCSVData() instead of finishIngest() if storing one of the batches of the file failed.
+        virtual void abortIngest(const string&, const ColumnFile&) {}
+
         // Checks if the column was registered with this column store or not.
         bool isInvalidColumn(string column) {
             return columnHeaders.find(column) == columnHeaders.end();
         }
 
+        // Binds the predicate to the values of a column of the data type (see Predicate::bind()), before it is evaluated.
+        // Throws invalid_argument if a literal cannot be compared with the values.
+        static Predicate bindPredicate(const Predicate& predicate, int dataType) {
+            switch (dataType) {
+                case STRING_DATATYPE: return predicate.bind(Predicate::TEXT_VALUES);
+                case FLOAT_DATATYPE: return predicate.bind(Predicate::REAL_VALUES);
+                default: return predicate.bind(Predicate::INTEGER_VALUES);
+            }
+        }
+
         // Based on the value string and column type, cast this value string to the appropriate type.
         // Additionally, checks the validation of value string.
         Object castValueAccordingToColumnType(string column, string value) {
@@ -141,7 +308,11 @@ class ColumnStoreAbstract {
                     case STRING_DATATYPE: return Object(value);
                     case INTEGER_DATATYPE: return Object(stoi(value));
                     case FLOAT_DATATYPE: return Object(stof(value));
-                    case TIME_DATATYPE: return Object(parseTime(value));
+                    case TIME_DATATYPE: {
+                        int64_t epoch;
+                        if (!parseTime(value, epoch)) { throw invalid_argument("Invalid time for column (" + column + "): " + value); }
+                        return Object((long long) epoch);
+                    }
                     default: throw invalid_argument("No such data type for column (" + column + ") registered. Defaulting to string...");
                 }
             } catch (invalid_argument& e) {
@@ -149,7 +320,7 @@ class ColumnStoreAbstract {
             } catch (exception& e) { //any other exception
                 cout << e.what() << endl;
             }
-
+            return Object(); // unparsable values are stored as null
         }
 
         // Returns true if column data type is not a integer or float.
@@ -157,66 +328,143 @@ class ColumnStoreAbstract {
             return columnDataTypes[column] != INTEGER_DATATYPE && columnDataTypes[column] != FLOAT_DATATYPE;
         }
 
-        // Useful in getMax() and getMin() functions.
-        // So that code does not have to be repeated.
-        bool validationCheckForMinMax(string column) {
-            if (isInvalidColumn(column)) {
-                cout << "Column is not registered with this column store." << endl;
-                return false;
-            }
-
-            if (isNotNumberDataType(column)) {
-                cout << "Cannot perform get max operation on a column whose data are not numbers." << endl;
-                return false;
-            }
-
-            return true;
+        // Appends the values of the given indexes of the column to the vector, through the typed getValues()
+        template <typename T>
+        void appendValues(const string& column, const Selection& indexes, vector<T>& values) {
+            size_t first = values.size();
+            values.resize(first + indexes.cardinality());
+            if (!getValues(column, indexes, values.data() + first)) { values.resize(first); }
         }
 
-    private:
-        // Splits a string by a delimiter and returns a vector of tokens
-        vector<string> split(string s, string delimiter) {
-            vector<string> tokens;
-            size_t pos = 0;
-            while ((pos = s.find(delimiter)) != string::npos) {
-                tokens.push_back(s.substr(0, pos));
-                s.erase(0, pos + delimiter.length());
+        // Parses the values of a column according to its data type
+        ColumnBatch::Column parseColumn(const string& column, const vector<string>& values) {
+            ColumnBatch::Column parsed(column, columnDataTypes[column]);
+            for (const string& value : values) {
+                parseInto(parsed, value);
             }
-            tokens.push_back(s);
-            return tokens;
+            return parsed;
         }
 
-        // Parses a string into a tm struct representing time
-        tm parseTime(string s) {
-            tm t;
-            stringstream ss(s);
-            ss >> get_time(&t, DTFORMATSTRING.c_str());
-            return t;
+        // Parses a value according to the data type of the column and appends it, unparsable values become null
+        void parseInto(ColumnBatch::Column& column, string_view value) {
+            bool isNullValue = value == "" || value == "M";
+            switch (column.dataType) {
+                case INTEGER_DATATYPE: {
+                    int32_t parsed = NULL_INTEGER;
+                    if (!isNullValue && from_chars(value.data(), value.data() + value.size(), parsed).ec != errc()) { parsed = NULL_INTEGER; }
+                    column.integers.push_back(parsed);
+                    break;
+                }
+                case FLOAT_DATATYPE: {
+                    float parsed = NULL_FLOAT;
+                    if (!isNullValue && from_chars(value.data(), value.data() + value.size(), parsed).ec != errc()) { parsed = NULL_FLOAT; }
+                    column.floats.push_back(parsed);
+                    break;
+                }
+                case TIME_DATATYPE: {
+                    int64_t parsed = NULL_TIME;
+                    if (!isNullValue && !parseTime(value, parsed)) { parsed = NULL_TIME; }
+                    column.times.push_back(parsed);
+                    break;
+                }
+                default: column.strings.push_back(isNullValue ? string_view("M") : value);
+            }
         }
-};
 
-// A class representing an object that can hold different types of values
-class Object {
-    public:
-        enum Type {NONE, STRING, INT, FLOAT, TIME};
+    private:
+        // Minimum number of bytes of a CSV chunk parsed by one thread
+        static const size_t MIN_CSV_CHUNK = 1 << 20;
+
+        // Splits a window of CSV rows into chunks ending at a newline, at least MIN_CSV_CHUNK bytes each,
+        // and parses them on the workers of the shared ThreadPool. Returns the batches of all the chunks in file order
+        vector<ColumnBatch> parseCSVWindow(string_view rows, const vector<string>& headers, size_t batchRows) {
+            size_t chunkCount = max<size_t>(1, min<size_t>(ThreadPool::shared().workerCount(), rows.size() / MIN_CSV_CHUNK));
+            vector<string_view> chunks;
+            size_t start = 0;
+            for (size_t i = 1; i <= chunkCount && start < rows.size(); i++) {
+                size_t end = i == chunkCount ? rows.size() : max(start, rows.size() * i / chunkCount);
+                end = min(rows.find('\n', end), rows.size());
+                chunks.push_back(rows.substr(start, end - start));
+                start = end + 1;
+            }
 
-        Type type;
-        string sval;
-        int ival;
-        float fval;
-        tm tval;
+            vector<vector<ColumnBatch>> chunkBatches(chunks.size());
+            TaskGroup parsing;
+            for (size_t i = 0; i < chunks.size(); i++) {
+                parsing.run([this, &chunks, &chunkBatches, &headers, batchRows, i]() {
+                    chunkBatches[i] = parseCSVChunk(chunks[i], headers, batchRows);
+                });
+            }
+            parsing.wait();
 
-        Object() : type(NONE) {}
+            vector<ColumnBatch> batches;
+            for (vector<ColumnBatch>& parsed : chunkBatches) {
+                move(parsed.begin(), parsed.end(), back_inserter(batches));
+            }
+            return batches;
+        }
 
-        Object(string s) : type(STRING), sval(s) {}
+        // Parses the rows of a CSV chunk into batches of at most batchRows rows, a row with fewer values than headers
+        // is padded with nulls and values beyond the last header are ignored
+        vector<ColumnBatch> parseCSVChunk(string_view chunk, const vector<string>& headers, size_t batchRows) {
+            vector<ColumnBatch> batches;
+            size_t pos = 0;
+            while (pos < chunk.size()) {
+                size_t end = min(chunk.find('\n', pos), chunk.size());
+                string_view line = trimLineEnd(chunk.substr(pos, end - pos));
+                pos = end + 1;
+                if (line.empty()) { continue; }
+
+                if (batches.empty() || batches.back().rowCount == batchRows) {
+                    batches.push_back(ColumnBatch());
+                    for (const string& header : headers) {
+                        batches.back().columns.push_back(ColumnBatch::Column(header, columnDataTypes.at(header))); // at() does not insert, safe to share between threads
+                    }
+                }
+                ColumnBatch& batch = batches.back();
+
+                size_t i = 0;
+                size_t start = 0;
+                while (i < headers.size() && start <= line.size()) {
+                    size_t comma = min(line.find(',', start), line.size());
+                    parseInto(batch.columns[i], line.substr(start, comma - start));
+                    start = comma + 1;
+                    i++;
+                }
+                while (i < headers.size()) { //means this datum has less columns that what is provided, add null values
+                    parseInto(batch.columns[i], "M");
+                    i++;
+                }
+                batch.rowCount++;
+            }
+            return batches;
+        }
 
-        Object(int i) : type(INT), ival(i) {}
+        // Splits a string by a delimiter into views of the string
+        static vector<string_view> splitView(string_view s, char delimiter) {
+            vector<string_view> tokens;
+            size_t start = 0;
+            while (true) {
+                size_t end = min(s.find(delimiter, start), s.size());
+                tokens.push_back(s.substr(start, end - start));
+                if (end == s.size()) { return tokens; }
+                start = end + 1;
+            }
+        }
 
-        Object(float f) : type(FLOAT), fval(f) {}
+        // Removes the carriage return of a line ending in "\r\n"
+        static string_view trimLineEnd(string_view line) {
+            if (!line.empty() && line.back() == '\r') { line.remove_suffix(1); }
+            return line;
+        }
 
-        Object(tm t) : type(TIME), tval(t) {}  
+        // Parses a time in the DTFORMATSTRING format into epoch seconds, returns false if it is not a valid time
+        // The default format is read directly from its digits, any other format through get_time()
+        static bool parseTime(string_view value, int64_t& epoch) {
+            static const bool isDefaultFormat = DTFORMATSTRING == TimeFormat::FORMAT;
+            if (isDefaultFormat) { return TimeFormat::parse(value, epoch); }
+            return TimeFormat::parse(value, DTFORMATSTRING, epoch);
+        }
+};
 
-    operator long() {return fval;}
-    operator int() {return ival;}
-    operator float() {return fval;}
-};
\ No newline at end of file
+const string ColumnStoreAbstract::DTFORMATSTRING = TimeFormat::FORMAT;
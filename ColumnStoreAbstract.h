@@ -10,9 +10,42 @@
 #include <unordered_set>
 #include <functional>
 #include <ctime>
+#include <climits>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include "Predicate.h"
+#include "Selection.h"
+#include "ColumnBatch.h"
+#include "ColumnFile.h"
 
 using namespace std;
 
+// A class representing an object that can hold different types of values
+class Object {
+    public:
+        enum Type {NONE, STRING, INT, FLOAT, TIME, BOOL};
+
+        Type type;
+        string sval;
+        int ival = 0;
+        float fval = 0;
+        long long tval = 0; // TIME as epoch seconds
+        bool flag = false;
+
+        Object();
+
+        Object(string s);
+
+        Object(int i);
+
+        Object(float f);
+
+        Object(long long t);
+
+        Object(bool flag);
+};
+
 // An abstract class representing a column store.
 class ColumnStoreAbstract {
     public:
@@ -22,6 +55,16 @@ class ColumnStoreAbstract {
         static const int TIME_DATATYPE = 3;
         static const string DTFORMATSTRING;
 
+        // Sentinel values used by the typed storages to represent null ("M" or empty) cells.
+        static const int NULL_INTEGER = INT_MIN;
+        static constexpr float NULL_FLOAT = numeric_limits<float>::quiet_NaN();
+        static const long long NULL_TIME = LLONG_MIN;
+
+        // Default limits of addCSVData(): parsed rows are stored in batches of at most DEFAULT_CSV_BATCH_ROWS rows,
+        // and at most DEFAULT_CSV_BATCH_MEGABYTES of CSV text is parsed before its batches are stored.
+        static const size_t DEFAULT_CSV_BATCH_ROWS = 1 << 16;
+        static const size_t DEFAULT_CSV_BATCH_MEGABYTES = 64;
+
         // The registered column headers with this column store.
         unordered_set<string> columnHeaders;
 
@@ -34,79 +77,148 @@ class ColumnStoreAbstract {
         // TIME_DATATYPE.
         unordered_map<string, int> columnDataTypes;
 
+        // Whether the year, month and day of every TIME value are stored as well (see CalendarColumns),
+        // so that filterYear() and filterMonth() compare them instead of the epoch seconds. Set it before storing any data.
+        bool storeCalendarColumns = true;
+
         // User has to specify, for each column, 1. the column name 2. the corresponding data type.
         ColumnStoreAbstract(unordered_map<string, int> columnDataTypes);
 
-        // Parses the CSV file and stores into the column store, using storeAll()
+        // Stores are deleted through pointers to this class.
+        virtual ~ColumnStoreAbstract() = default;
+
+        // Parses the CSV file and stores into the column store, using storeBatch(), with the default batch limits.
         void addCSVData(string filepath);
 
+        // Parses the CSV file and stores into the column store, using storeBatch()
+        // The file is streamed through in windows of batchMegabytes of text, whose chunks are parsed on parallel threads
+        // straight into typed batches of at most batchRows rows. Memory use does not grow with the size of the file.
+        void addCSVData(string filepath, size_t batchRows, size_t batchMegabytes);
+
         // Given a value string and the corresponding column, store into data storage.
         virtual void store(string column, string value) = 0;
 
         // Given a map of columns to its values (in String), store all into the data storage.
-        virtual void storeAll(unordered_map<string, vector<string>> buffer) = 0;
+        virtual void storeAll(const unordered_map<string, vector<string>>& buffer) = 0;
+
+        // Given a batch of parsed rows, store all its columns into the data storage.
+        // Throws if the batch cannot be stored, addCSVData() then leaves the ingest of its file unfinished.
+        virtual void storeBatch(const ColumnBatch& batch) = 0;
 
         // Scans all the indexes of the column and returns the indexes whose values match the predicate.
-        virtual vector<int> filter(string column, bool predicate) = 0;
+        // Indexes are passed between the stages of a query as a compressed Selection.
+        // Nothing matches, and an error is printed, when a literal of the predicate cannot be compared with the values of the column.
+        virtual Selection filter(string column, const Predicate& predicate) = 0;
 
         // Scans the given indexes of the column and returns the indexes whose values match the predicate.
-        virtual vector<int> filter(string column, bool predicate, vector<int> indexesToCheck) = 0;
+        virtual Selection filter(string column, const Predicate& predicate, const Selection& indexesToCheck) = 0;
+
+        // Scans all the indexes of the TIME column and returns the indexes whose values lie in the year.
+        // Stores keeping calendar columns override this to compare the stored years instead.
+        virtual Selection filterYear(string column, int year);
+
+        // Scans the given indexes of the TIME column and returns the indexes whose values lie in the month (1-12) of the year.
+        // Stores keeping calendar columns override this to compare the stored years and months instead.
+        virtual Selection filterMonth(string column, int year, int month, const Selection& indexesToCheck);
 
         // Scans the given indexes of the column and returns the indexes whose values are the largest among all the scanned values.
         //
         // The implementation by extending classes is recommended to perform a validation check to ensure column type is a number.
-        virtual vector<int> getMax(string column, vector<int> indexesToCheck) = 0;
+        virtual Selection getMax(string column, const Selection& indexesToCheck) = 0;
 
         // Scans the given indexes of the column and returns the indexes whose values are the smallest among all the scanned values.
         //
         // The implementation by extending classes is recommended to perform a validation check to ensure column type is a number.
-        virtual vector<int> getMin(string column, vector<int> indexesToCheck) = 0;
+        virtual Selection getMin(string column, const Selection& indexesToCheck) = 0;
 
         // Returns the name of this column store.
         virtual string getName() = 0;
 
-        // Gets the value from a column based on the index.
-        virtual Object* getValue(string column, int index) = 0;
+        // Gets the value from a column based on the index, nullopt if the cell is null or the index is out of bounds.
+        // The value is returned by value, nothing has to be freed. Use getValues() to read many indexes.
+        virtual optional<Object> getValue(string column, int index) = 0;
+
+        // Fills values[i] with the value of the i-th of the given indexes of an INTEGER, FLOAT, TIME (epoch seconds) or STRING column,
+        // values having room for indexes.cardinality() values. Runs of consecutive indexes are read at once and nothing is allocated per index.
+        // Null cells, and indexes past the end of the column, read as null ("M" for STRING). STRING values are views into the store,
+        // valid until the column is stored into again. Returns false if the column is not registered or holds another data type.
+        virtual bool getValues(string column, const Selection& indexes, int32_t* values) = 0;
+        virtual bool getValues(string column, const Selection& indexes, float* values) = 0;
+        virtual bool getValues(string column, const Selection& indexes, int64_t* values) = 0;
+        virtual bool getValues(string column, const Selection& indexes, string_view* values) = 0;
+
+        // Gets the values of the given indexes of the column, appended to the vector of values matching its data type (see ColumnBatch).
+        void getValues(string column, const Selection& indexes, ColumnBatch::Column& values);
 
         // Prints the head of the data (i.e. from index 0) until the specified index.
         virtual void printHead(int until) = 0;
 
+        // Returns the epoch seconds of the start of the given day, in the same wall-clock seconds TIME values are stored as.
+        // Useful for building TIME predicates, e.g. a year is [toEpoch(y, 1, 1), toEpoch(y + 1, 1, 1)).
+        static long long toEpoch(int year, int month, int day);
+
         // Useful in getMax() and getMin() functions.
         // So that code does not have to be repeated.
         bool validationCheckForMinMax(string column);
+
+        // Useful in getValues() functions: whether the column is registered and holds values of the data type.
+        bool validationCheckForDataType(string column, int dataType);
     
     protected:
+         // Called by addCSVData() once the headers of the file are checked, before any of its rows are stored.
+         // Returns false to skip the file, e.g. when a persistent store holds its rows already.
+         virtual bool startIngest(const string& filepath, const ColumnFile& file);
+
+         // Called by addCSVData() once all rowCount rows of the file are stored, not if storing one of its batches failed.
+         virtual void finishIngest(const string& filepath, const ColumnFile& file, size_t rowCount);
+
+         // Called by addCSVData() instead of finishIngest() if storing one of the batches of the file failed.
+         virtual void abortIngest(const string& filepath, const ColumnFile& file);
+
          // Based on the value string and column type, cast this value string to the appropriate type.
          // Additionally, checks the validation of value string.
          Object castValueAccordingToColumnType(string column, string value);
 
          // Checks if the column was registered with this column store or not.
          bool isInvalidColumn(string column);
-};
 
-// A class representing an object that can hold different types of values
-class Object {
-    public:
-        enum Type {NONE, STRING, INT, FLOAT, TIME, BOOL};
+         // Returns true if column data type is not a integer or float.
+         bool isNotNumberDataType(string column);
 
-        Type type;
-        string sval;
-        int ival;
-        float fval;
-        tm tval;
-        bool flag;
+         // Binds the predicate to the values of a column of the data type (see Predicate::bind()), before it is evaluated.
+         // Throws invalid_argument if a literal cannot be compared with the values.
+         static Predicate bindPredicate(const Predicate& predicate, int dataType);
 
-        Object();
+         // Parses the values of a column according to its data type.
+         ColumnBatch::Column parseColumn(const string& column, const vector<string>& values);
 
-        Object(string s);
+         // Parses a value according to the data type of the column and appends it, unparsable values become null.
+         void parseInto(ColumnBatch::Column& column, string_view value);
 
-        Object(int i);
+         // Appends the values of the given indexes of the column to the vector, through the typed getValues().
+         template <typename T>
+         void appendValues(const string& column, const Selection& indexes, vector<T>& values);
 
-        Object(float f);
+    private:
+         // Minimum number of bytes of a CSV chunk parsed by one thread
+         static const size_t MIN_CSV_CHUNK = 1 << 20;
 
-        Object(tm t);
+         // Splits a window of CSV rows into chunks ending at a newline, at least MIN_CSV_CHUNK bytes each,
+         // and parses them on the workers of the shared ThreadPool. Returns the batches of all the chunks in file order
+         vector<ColumnBatch> parseCSVWindow(string_view rows, const vector<string>& headers, size_t batchRows);
 
-        Object(bool flag);
+         // Parses the rows of a CSV chunk into batches of at most batchRows rows, a row with fewer values than headers
+         // is padded with nulls and values beyond the last header are ignored
+         vector<ColumnBatch> parseCSVChunk(string_view chunk, const vector<string>& headers, size_t batchRows);
+
+         // Splits a string by a delimiter into views of the string
+         static vector<string_view> splitView(string_view s, char delimiter);
+
+         // Removes the carriage return of a line ending in "\r\n"
+         static string_view trimLineEnd(string_view line);
+
+         // Parses a time in the DTFORMATSTRING format into epoch seconds, returns false if it is not a valid time
+         static bool parseTime(string_view value, int64_t& epoch);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -3,19 +3,121 @@
 #include <vector>
 #include <map>
 #include <functional>
+#include <cstdint>
+#include <string_view>
+#include <optional>
 using namespace std;
 #include "ColumnStoreAbstract.h"
+#include "Selection.h"
+#include "MinMaxKernels.h"
+#include "StringDictionary.h"
+#include "CalendarColumns.h"
+#include "Morsels.h"
 
 class ColumnStoreMM : public ColumnStoreAbstract {
     private:
-        map<string, vector<Object>> data; // a map of column names to vectors of objects
+        // typed, contiguous buffers, one per column depending on its data type
+        unordered_map<string, vector<int32_t>> integerData; // INTEGER_DATATYPE, null is NULL_INTEGER
+        unordered_map<string, vector<float>> floatData; // FLOAT_DATATYPE, null is NULL_FLOAT
+        unordered_map<string, vector<int64_t>> timeData; // TIME_DATATYPE as epoch seconds, null is NULL_TIME
+        unordered_map<string, DictionaryColumn> stringData; // STRING_DATATYPE as dictionary codes, null is NULL_CODE
+        unordered_map<string, CalendarColumns> calendarData; // dates of the TIME_DATATYPE columns, if storeCalendarColumns
+
+        // number of rows stored in a column
+        size_t rowCount(string column) {
+            switch (columnDataTypes[column]) {
+                case INTEGER_DATATYPE: return integerData[column].size();
+                case FLOAT_DATATYPE: return floatData[column].size();
+                case TIME_DATATYPE: return timeData[column].size();
+                default: return stringData[column].size();
+            }
+        }
+
+        // the calendar columns of a TIME column, nullptr if it has none covering all its rows
+        const CalendarColumns* calendarFor(string& column) {
+            if (isInvalidColumn(column) || columnDataTypes[column] != TIME_DATATYPE) { return nullptr; }
+            auto it = calendarData.find(column);
+            if (it == calendarData.end() || it->second.size() != timeData[column].size()) { return nullptr; }
+            return &it->second;
+        }
+
+        // print a value followed by a comma, "M" if it is null
+        template <typename T>
+        static void printValue(T value, bool isNullValue) {
+            if (isNullValue) { cout << "M,"; }
+            else { cout << value << ","; }
+        }
+
+        // the indexes to check that are rows of the column, with an error if some are out of bounds
+        Selection storedRows(string& column, const Selection& indexesToCheck) {
+            size_t count = rowCount(column);
+            if (indexesToCheck.upperBound() <= count) { return indexesToCheck; }
+            cout << "Index to check is out of bounds!" << endl;
+            return indexesToCheck & Selection::range(0, count);
+        }
+
+        // evaluate the predicate directly on the typed buffer of a column: scanRows(matches) returns the rows for which matches(row) holds
+        // the buffer is looked up here, so that matches(row) can be called from the morsel workers
+        // the predicate is bound to the column first, nothing matches if its literals cannot be compared with the values
+        template <typename ScanRows>
+        Selection filterTyped(string& column, const Predicate& unbound, ScanRows scanRows) {
+            optional<Predicate> bound;
+            try {
+                bound = bindPredicate(unbound, columnDataTypes[column]);
+            } catch (invalid_argument& e) {
+                cout << e.what() << endl;
+                return Selection();
+            }
+            const Predicate& predicate = *bound;
+
+            switch (columnDataTypes[column]) {
+                case INTEGER_DATATYPE: {
+                    const int32_t* values = integerData[column].data();
+                    return scanRows([values, &predicate](uint32_t i) {
+                        return predicate.matchesInteger(values[i], values[i] == NULL_INTEGER);
+                    });
+                }
+                case FLOAT_DATATYPE: {
+                    const float* values = floatData[column].data();
+                    return scanRows([values, &predicate](uint32_t i) {
+                        return predicate.matchesFloat(values[i], isnan(values[i]));
+                    });
+                }
+                case TIME_DATATYPE: {
+                    const int64_t* values = timeData[column].data();
+                    return scanRows([values, &predicate](uint32_t i) {
+                        return predicate.matchesInteger(values[i], values[i] == NULL_TIME);
+                    });
+                }
+                default: {
+                    // evaluate the predicate once per distinct value, then only look up the codes
+                    const DictionaryColumn& values = stringData[column];
+                    vector<bool> matches = values.getDictionary().matchingCodes(predicate);
+                    return scanRows([&values, &matches](uint32_t i) { return matches[values.codeAt(i)]; });
+                }
+            }
+        }
+
+        // copy data[i] for every index into values, null past the end of data
+        template <typename T>
+        static void copyValues(const vector<T>& data, const Selection& indexes, T null, T* values) {
+            indexes.forEachRun([&](uint32_t start, uint32_t end) {
+                size_t stored = start < data.size() ? min<size_t>(end, data.size()) : start;
+                if (stored > start) { values = copy(data.begin() + start, data.begin() + stored, values); }
+                values = fill_n(values, end - stored, null);
+            });
+        }
 
     public:
         // constructor that takes a map of column names and data types
         ColumnStoreMM(unordered_map<string, int> columnDataTypes) : ColumnStoreAbstract(columnDataTypes) {
-            for (auto& pair : columnHeaders) {
-                string columnHeader = pair;
-                data[columnHeader] = vector<Object>(); // initialize the data vector with empty objects
+            for (auto& pair : this->columnDataTypes) {
+                switch (pair.second) {
+                    case INTEGER_DATATYPE: integerData[pair.first] = vector<int32_t>(); break;
+                    case FLOAT_DATATYPE: floatData[pair.first] = vector<float>(); break;
+                    case TIME_DATATYPE: timeData[pair.first] = vector<int64_t>(); break;
+                    default: stringData[pair.first] = DictionaryColumn(); break;
+                }
             }
         }
 
@@ -23,97 +125,150 @@ class ColumnStoreMM : public ColumnStoreAbstract {
         void store(string column, string value) override {
             if (isInvalidColumn(column)) {
                 cout << "Column is not registered with this column store." << endl;
-            } else {
-                Object toAdd = castValueAccordingToColumnType(column, value);
-                data[column].push_back(toAdd);
+                return;
             }
+
+            append(parseColumn(column, {value}));
         }
 
         // store all values in a buffer
-        void storeAll(unordered_map<string, vector<string>> buffer) override {
+        void storeAll(const unordered_map<string, vector<string>>& buffer) override {
             for (auto& pair : buffer) {
-                string column = pair.first;
-                vector<string> values = pair.second;
-                for (string value : values) {
-                    store(column, value);
+                if (isInvalidColumn(pair.first)) {
+                    cout << "Column is not registered with this column store." << endl;
+                    continue;
+                }
+                append(parseColumn(pair.first, pair.second));
+            }
+        }
+
+        // store a batch of parsed rows, the typed values are appended as they are
+        void storeBatch(const ColumnBatch& batch) override {
+            for (const ColumnBatch::Column& column : batch.columns) {
+                append(column);
+            }
+        }
+
+        // append parsed values to the typed buffer of their column
+        void append(const ColumnBatch::Column& values) {
+            switch (values.dataType) {
+                case INTEGER_DATATYPE: {
+                    vector<int32_t>& data = integerData[values.name];
+                    data.insert(data.end(), values.integers.begin(), values.integers.end());
+                    break;
+                }
+                case FLOAT_DATATYPE: {
+                    vector<float>& data = floatData[values.name];
+                    data.insert(data.end(), values.floats.begin(), values.floats.end());
+                    break;
+                }
+                case TIME_DATATYPE: {
+                    vector<int64_t>& data = timeData[values.name];
+                    data.insert(data.end(), values.times.begin(), values.times.end());
+                    if (storeCalendarColumns) { calendarData[values.name].append(values.times, NULL_TIME); }
+                    break;
+                }
+                default: {
+                    DictionaryColumn& data = stringData[values.name];
+                    for (string_view value : values.strings) {
+                        data.push_back(value);
+                    }
                 }
             }
         }
 
         // filter a column by a predicate and return the indexes of matching values
-        vector<int> filter(string column, bool predicate) override {
-            vector<int> results;
+        Selection filter(string column, const Predicate& predicate) override {
+            Selection results;
             if (isInvalidColumn(column)) {
                 cout << "Column is not registered with this column store." << endl;
                 return results;
             }
 
-            for (int i = 0; i < data[column].size(); i++) {
-                Object value = data[column][i];
-                if (predicate) {
-                    results.push_back(i);
-                }
-            }
-            return results;
+            // every morsel of rows is scanned on its own worker
+            size_t size = rowCount(column);
+            return filterTyped(column, predicate, [size](auto matches) {
+                return Morsels::filter(size, [&matches](uint32_t first, uint32_t end) {
+                    Selection results;
+                    for (uint32_t i = first; i < end; i++) {
+                        if (matches(i)) { results.add(i); }
+                    }
+                    return results;
+                });
+            });
         }
 
         // filter a column by a predicate and return the indexes of matching values from a given list of indexes
-        vector<int> filter(string column, bool predicate, vector<int> indexesToCheck) {
-            vector<int> results;
+        Selection filter(string column, const Predicate& predicate, const Selection& indexesToCheck) override {
+            Selection results;
             if (isInvalidColumn(column)) {
                 cout << "Column is not registered with this column store." << endl;
                 return results;
             }
 
-            for (int index : indexesToCheck) {
-                Object value = data[column][index];
-                if (predicate) {
-                    results.push_back(index);
+            Selection rowsToCheck = storedRows(column, indexesToCheck);
+            return filterTyped(column, predicate, [&rowsToCheck](auto matches) {
+                return Morsels::filter(rowsToCheck, [&matches](const Selection& rows) {
+                    Selection results;
+                    rows.forEach([&](uint32_t i) {
+                        if (matches(i)) { results.add(i); }
+                    });
+                    return results;
+                });
+            });
+        }
+
+        // filter a TIME column by year, comparing the stored years when the column has calendar columns
+        Selection filterYear(string column, int year) override {
+            const CalendarColumns* calendar = calendarFor(column);
+            if (!calendar) { return ColumnStoreAbstract::filterYear(column, year); }
+
+            const int16_t* years = calendar->years.data();
+            return Morsels::filter(calendar->size(), [years, year](uint32_t first, uint32_t end) {
+                Selection results;
+                for (uint32_t i = first; i < end; i++) {
+                    if (years[i] == year) { results.add(i); }
                 }
-            }
-            return results;
+                return results;
+            });
+        }
+
+        // filter the given indexes of a TIME column by month, comparing the stored years and months when the column has calendar columns
+        Selection filterMonth(string column, int year, int month, const Selection& indexesToCheck) override {
+            const CalendarColumns* calendar = calendarFor(column);
+            if (!calendar) { return ColumnStoreAbstract::filterMonth(column, year, month, indexesToCheck); }
+
+            const int16_t* years = calendar->years.data();
+            const uint8_t* months = calendar->months.data();
+            return Morsels::filter(indexesToCheck & Selection::range(0, calendar->size()), [years, months, year, month](const Selection& rows) {
+                Selection results;
+                rows.forEach([&](uint32_t i) {
+                    if (years[i] == year && months[i] == month) { results.add(i); }
+                });
+                return results;
+            });
         }
 
         // get the maximum value in a column from a given list of indexes
-        vector<int> getMax(string column, vector<int> indexesToCheck) override {
-            vector<int> results;
-            if (!validationCheckForMinMax(column)) { return results; } //return empty vector if validation check fails
+        Selection getMax(string column, const Selection& indexesToCheck) override {
+            if (!validationCheckForMinMax(column)) { return Selection(); } //return empty selection if validation check fails
 
-            float maximum = numeric_limits<float>::min();
-            for (int index : indexesToCheck) {
-                if (data[column][index].type == NULL) { continue; }
-                float value = (float) data[column][index].fval;
-                if (value == maximum) {
-                    results.push_back(index);
-                } else if (value > maximum) {
-                    maximum = value;
-                    results.clear();
-                    results.push_back(index);
-                }
+            Selection rows = storedRows(column, indexesToCheck);
+            if (columnDataTypes[column] == INTEGER_DATATYPE) {
+                return Morsels::minMax(integerData[column].data(), rows).maxRows;
             }
-
-            return results;
+            return Morsels::minMax(floatData[column].data(), rows).maxRows;
         }
 
         // get the minimum value in a column from a given list of indexes
-        vector<int> getMin(string column, vector<int> indexesToCheck) override {
-            vector<int> results;
-            if (!validationCheckForMinMax(column)) { return results; } //return empty vector if validation check fails
+        Selection getMin(string column, const Selection& indexesToCheck) override {
+            if (!validationCheckForMinMax(column)) { return Selection(); } //return empty selection if validation check fails
 
-            float minimum = numeric_limits<float>::max();
-            for (int index : indexesToCheck) {
-                if (data[column][index].type == NULL) { continue; }
-                float value = (float) data[column][index].fval;
-                if (value == minimum) {
-                    results.push_back(index);
-                } else if (value < minimum) {
-                    minimum = value;
-                    results.clear();
-                    results.push_back(index);
-                }
+            Selection rows = storedRows(column, indexesToCheck);
+            if (columnDataTypes[column] == INTEGER_DATATYPE) {
+                return Morsels::minMax(integerData[column].data(), rows).minRows;
             }
-
-            return results;
+            return Morsels::minMax(floatData[column].data(), rows).minRows;
         }
 
         // get the name of the storage type
@@ -121,14 +276,86 @@ class ColumnStoreMM : public ColumnStoreAbstract {
             return "main_memory";
         }
 
-        // print the first few values of each column
+        // get values of a specfic cell, nullopt if the cell is null
+        optional<Object> getValue(string column, int index) override {
+            if (isInvalidColumn(column)) {
+                cout << "Column is not registered with this column store." << endl;
+                return nullopt;
+            }
+            if (index < 0 || (size_t) index >= rowCount(column)) {
+                cout << "Index is out of bounds." << endl;
+                return nullopt;
+            }
+
+            switch (columnDataTypes[column]) {
+                case INTEGER_DATATYPE: {
+                    int32_t value = integerData[column][index];
+                    if (value == NULL_INTEGER) { return nullopt; }
+                    return Object((int) value);
+                }
+                case FLOAT_DATATYPE: {
+                    float value = floatData[column][index];
+                    if (isnan(value)) { return nullopt; }
+                    return Object(value);
+                }
+                case TIME_DATATYPE: {
+                    int64_t value = timeData[column][index];
+                    if (value == NULL_TIME) { return nullopt; }
+                    return Object((long long) value);
+                }
+                default: {
+                    const DictionaryColumn& values = stringData[column];
+                    if (values.codeAt(index) == StringDictionary::NULL_CODE) { return nullopt; }
+                    return Object(values.at(index));
+                }
+            }
+        }
+
+        // get the values of the given indexes of a column, runs of consecutive indexes are copied at once
+        using ColumnStoreAbstract::getValues;
+
+        bool getValues(string column, const Selection& indexes, int32_t* values) override {
+            if (!validationCheckForDataType(column, INTEGER_DATATYPE)) { return false; }
+            copyValues(integerData[column], indexes, (int32_t) NULL_INTEGER, values);
+            return true;
+        }
+
+        bool getValues(string column, const Selection& indexes, float* values) override {
+            if (!validationCheckForDataType(column, FLOAT_DATATYPE)) { return false; }
+            copyValues(floatData[column], indexes, NULL_FLOAT, values);
+            return true;
+        }
+
+        bool getValues(string column, const Selection& indexes, int64_t* values) override {
+            if (!validationCheckForDataType(column, TIME_DATATYPE)) { return false; }
+            copyValues(timeData[column], indexes, (int64_t) NULL_TIME, values);
+            return true;
+        }
+
+        bool getValues(string column, const Selection& indexes, string_view* values) override {
+            if (!validationCheckForDataType(column, STRING_DATATYPE)) { return false; }
+            const DictionaryColumn& data = stringData[column];
+            indexes.forEach([&](uint32_t i) {
+                *values++ = data.getDictionary().decode(i < data.size() ? data.codeAt(i) : StringDictionary::NULL_CODE);
+            });
+            return true;
+        }
+
+        // print the first few values of each column, "M" for nulls like the disk stores
         void printHead(int until) override {
             for (string column : columnHeaders) {
                 cout << column << ": ";
-                for (int i = 0; i < until; i++) {
-                    cout << data[column][i].fval << " ";
+                int size = min((int) rowCount(column), until);
+                for (int i = 0; i < size; i++) {
+                    switch (columnDataTypes[column]) {
+                        case INTEGER_DATATYPE: printValue(integerData[column][i], integerData[column][i] == NULL_INTEGER); break;
+                        case FLOAT_DATATYPE: printValue(floatData[column][i], isnan(floatData[column][i])); break;
+                        case TIME_DATATYPE: printValue(timeData[column][i], timeData[column][i] == NULL_TIME); break;
+                        default: cout << stringData[column].at(i) << ","; // nulls are decoded as "M"
+                    }
                 }
                 cout << endl;
             }
         }
-};
\ No newline at end of file
+
+};
@@ -7,7 +7,14 @@
 #include <vector>
 #include <map>
 #include <functional>
+#include <cstdint>
+#include <string_view>
+#include <optional>
 #include "ColumnStoreAbstract.h"
+#include "MinMaxKernels.h"
+#include "StringDictionary.h"
+#include "CalendarColumns.h"
+#include "Morsels.h"
 
 
 using namespace std;
@@ -15,7 +22,33 @@ using namespace std;
 // a column store implementation where the data is stored in main memory
 class ColumnStoreMM : public ColumnStoreAbstract {
     private:
-        map<string, vector<Object>> data; // a map of column names to vectors of objects
+        // typed, contiguous buffers, one per column depending on its data type
+        unordered_map<string, vector<int32_t>> integerData; // INTEGER_DATATYPE, null is NULL_INTEGER
+        unordered_map<string, vector<float>> floatData; // FLOAT_DATATYPE, null is NULL_FLOAT
+        unordered_map<string, vector<int64_t>> timeData; // TIME_DATATYPE as epoch seconds, null is NULL_TIME
+        unordered_map<string, DictionaryColumn> stringData; // STRING_DATATYPE as dictionary codes, null is NULL_CODE
+        unordered_map<string, CalendarColumns> calendarData; // dates of the TIME_DATATYPE columns, if storeCalendarColumns
+
+        // number of rows stored in a column
+        size_t rowCount(string column);
+
+        // the calendar columns of a TIME column, nullptr if it has none covering all its rows
+        const CalendarColumns* calendarFor(string& column);
+
+        // print a value followed by a comma, "M" if it is null
+        template <typename T>
+        static void printValue(T value, bool isNullValue);
+
+        // the indexes to check that are rows of the column, with an error if some are out of bounds
+        Selection storedRows(string& column, const Selection& indexesToCheck);
+
+        // evaluate the predicate directly on the typed buffer of a column: scanRows(matches) returns the rows for which matches(row) holds
+        template <typename ScanRows>
+        Selection filterTyped(string& column, const Predicate& predicate, ScanRows scanRows);
+
+        // copy data[i] for every index into values, null past the end of data
+        template <typename T>
+        static void copyValues(const vector<T>& data, const Selection& indexes, T null, T* values);
 
     public:
         // constructor that takes a map of column names and data types
@@ -25,27 +58,46 @@ class ColumnStoreMM : public ColumnStoreAbstract {
         void store(string column, string value) override;
 
         // store all values in a buffer
-        void storeAll(unordered_map<string, vector<string>> buffer) override;
+        void storeAll(const unordered_map<string, vector<string>>& buffer) override;
+
+        // store a batch of parsed rows, the typed values are appended as they are
+        void storeBatch(const ColumnBatch& batch) override;
+
+        // append parsed values to the typed buffer of their column
+        void append(const ColumnBatch::Column& values);
 
         // filter a column by a predicate and return the indexes of matching values
-        vector<int> filter(string column, bool predicate) override;
+        Selection filter(string column, const Predicate& predicate) override;
 
         // filter a column by a predicate and return the indexes of matching values from a given list of indexes
-        vector<int> filter(string column, bool predicate, vector<int> indexesToCheck);
+        Selection filter(string column, const Predicate& predicate, const Selection& indexesToCheck) override;
+
+        // filter a TIME column by year, comparing the stored years when the column has calendar columns
+        Selection filterYear(string column, int year) override;
+
+        // filter the given indexes of a TIME column by month, comparing the stored years and months when the column has calendar columns
+        Selection filterMonth(string column, int year, int month, const Selection& indexesToCheck) override;
 
         // get the maximum value in a column from a given list of indexes
-        vector<int> getMax(string column, vector<int> indexesToCheck) override;
+        Selection getMax(string column, const Selection& indexesToCheck) override;
 
         // get the minimum value in a column from a given list of indexes
-        vector<int> getMin(string column, vector<int> indexesToCheck) override;
+        Selection getMin(string column, const Selection& indexesToCheck) override;
 
         // get the name of the storage type
         string getName() override;
 
-        // get values of a specfic cell
-        Object* getValue(string column, int index);
+        // get values of a specfic cell, nullopt if the cell is null
+        optional<Object> getValue(string column, int index) override;
+
+        // get the values of the given indexes of a column, runs of consecutive indexes are copied at once
+        using ColumnStoreAbstract::getValues;
+        bool getValues(string column, const Selection& indexes, int32_t* values) override;
+        bool getValues(string column, const Selection& indexes, float* values) override;
+        bool getValues(string column, const Selection& indexes, int64_t* values) override;
+        bool getValues(string column, const Selection& indexes, string_view* values) override;
 
-        // print the first few values of each column
+        // print the first few values of each column, "M" for nulls like the disk stores
         void printHead(int until) override;
 };
 
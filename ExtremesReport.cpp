@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <unordered_set>
+#include "ExtremesReport.h"
+#include "GroupBy.h"
+#include "Predicate.h"
+#include "TimeFormat.h"
+
+using namespace std;
+
+Selection ExtremesReport::select(ColumnStoreAbstract& store, int year, const string& station) {
+    Selection yearRows = store.filterYear("Timestamp", year);
+    return store.filter("Station", Predicate::equals(station), yearRows);
+}
+
+vector<ExtremesReport::Extreme> ExtremesReport::aggregate(ColumnStoreAbstract& store, const Selection& rows) {
+    // A single pass finds the extremes of both columns in every month
+    GroupBy byMonth({GroupBy::Key::month("Timestamp")}, {"Humidity", "Temperature"});
+    vector<Extreme> extremes;
+    for (GroupBy::Group& month : byMonth.run(store, rows)) {
+        GroupBy::Aggregate& humidity = month.aggregates[0];
+        GroupBy::Aggregate& temperature = month.aggregates[1];
+        // The values were read as floats, so they convert back exactly
+        extremes.push_back({Output::MAX_HUMIDITY, (float) humidity.max, move(humidity.maxRows)});
+        extremes.push_back({Output::MIN_HUMIDITY, (float) humidity.min, move(humidity.minRows)});
+        extremes.push_back({Output::MAX_TEMP, (float) temperature.max, move(temperature.maxRows)});
+        extremes.push_back({Output::MIN_TEMP, (float) temperature.min, move(temperature.minRows)});
+    }
+    return extremes;
+}
+
+vector<Output> ExtremesReport::materialize(ColumnStoreAbstract& store, const vector<Extreme>& extremes, const string& station) {
+    vector<Output> result;
+    Selection winners;
+    for (const Extreme& extreme : extremes) {
+        winners = winners | extreme.rows;
+    }
+
+    // The only values read after the aggregate
+    vector<int> rows = winners.toVector();
+    vector<int64_t> timestamps(rows.size());
+    if (!store.getValues("Timestamp", winners, timestamps.data())) { return result; }
+
+    for (const Extreme& extreme : extremes) {
+        unordered_set<int64_t> addedDays;
+        size_t position = 0; // the rows of an extreme are in increasing order, so the search goes on from the last one
+        extreme.rows.forEach([&](uint32_t row) {
+            position = lower_bound(rows.begin() + position, rows.end(), (int) row) - rows.begin();
+            int64_t timestamp = timestamps[position];
+            if (timestamp == ColumnStoreAbstract::NULL_TIME) { return; }
+            // we do not want duplicate days, as each day has 48 different times
+            if (addedDays.insert(TimeFormat::daysFromEpoch(timestamp)).second) {
+                result.push_back(Output((time_t) timestamp, station, extreme.type, extreme.value));
+            }
+        });
+    }
+    return result;
+}
+
+vector<Output> ExtremesReport::run(ColumnStoreAbstract& store, int year, const string& station) {
+    return materialize(store, aggregate(store, select(store, year, station)), station);
+}
@@ -0,0 +1,48 @@
+// ExtremesReport.h
+
+#ifndef EXTREMESREPORT_H
+#define EXTREMESREPORT_H
+
+#include <string>
+#include <vector>
+#include "ColumnStoreAbstract.h"
+#include "Output.h"
+#include "Selection.h"
+
+using namespace std;
+
+// The monthly extremes report of ScanResult.csv, run as a pipeline of operators that pass row positions along.
+//
+//   select:      filterYear("Timestamp") -> filter("Station")        positions only
+//   aggregate:   GroupBy month of "Timestamp" -> min/max of "Humidity" and "Temperature"
+//                                                                     the rows holding each extreme, and its value
+//   materialize: one getValues("Timestamp") over the rows of every extreme together
+//                                                                     one Output per extreme and day
+//
+// The aggregate already knows the value every winning row holds, so only the timestamps of the winning rows are
+// ever fetched, in a single batched gather instead of one per month and category.
+class ExtremesReport {
+    public:
+        // The rows holding the minimum or maximum of "Humidity" or "Temperature" in a month.
+        struct Extreme {
+            int type; // Output::MAX_HUMIDITY, MIN_HUMIDITY, MAX_TEMP or MIN_TEMP
+            float value;
+            Selection rows;
+        };
+
+        // The rows of the station in the year.
+        static Selection select(ColumnStoreAbstract& store, int year, const string& station);
+
+        // The extremes of every month holding some of the rows, by month, each month in the order of the report:
+        // max humidity, min humidity, max temperature, min temperature. An extreme of a month with only nulls has no rows.
+        static vector<Extreme> aggregate(ColumnStoreAbstract& store, const Selection& rows);
+
+        // The outputs of the extremes, in their order, keeping the first row of every day of an extreme.
+        // The timestamps of the rows of all the extremes are read at once.
+        static vector<Output> materialize(ColumnStoreAbstract& store, const vector<Extreme>& extremes, const string& station);
+
+        // select(), aggregate() and materialize() one after the other.
+        static vector<Output> run(ColumnStoreAbstract& store, int year, const string& station);
+};
+
+#endif
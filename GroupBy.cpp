@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+#include "GroupBy.h"
+#include "Morsels.h"
+#include "TimeFormat.h"
+
+using namespace std;
+
+namespace {
+    struct KeyHash {
+        size_t operator()(const vector<int64_t>& key) const {
+            uint64_t hash = 14695981039346656037ULL;
+            for (int64_t part : key) {
+                hash = (hash ^ (uint64_t) part) * 1099511628211ULL;
+                hash ^= hash >> 29;
+            }
+            return hash;
+        }
+    };
+}
+
+GroupBy::Key GroupBy::Key::value(string column) { return {column, VALUE}; }
+
+GroupBy::Key GroupBy::Key::year(string column) { return {column, YEAR}; }
+
+GroupBy::Key GroupBy::Key::month(string column) { return {column, MONTH}; }
+
+GroupBy::Key GroupBy::Key::date(string column) { return {column, DATE}; }
+
+double GroupBy::Aggregate::avg() const {
+    return count == 0 ? numeric_limits<double>::quiet_NaN() : sum / count;
+}
+
+void GroupBy::Aggregate::add(double value, uint32_t row) {
+    if (count == 0 || value < min) {
+        min = value;
+        minRows = Selection();
+    }
+    if (count == 0 || value > max) {
+        max = value;
+        maxRows = Selection();
+    }
+    if (value == min) { minRows.add(row); }
+    if (value == max) { maxRows.add(row); }
+    count++;
+    sum += value;
+}
+
+GroupBy::GroupBy(vector<Key> keys, vector<string> valueColumns) : keys(keys), valueColumns(valueColumns) {}
+
+bool GroupBy::validate(ColumnStoreAbstract& store) const {
+    for (const Key& key : keys) {
+        auto dataType = store.columnDataTypes.find(key.column);
+        if (dataType == store.columnDataTypes.end()) {
+            cout << "Column is not registered with this column store." << endl;
+            return false;
+        }
+        bool valid = key.part == Key::VALUE
+            ? dataType->second == ColumnStoreAbstract::STRING_DATATYPE || dataType->second == ColumnStoreAbstract::INTEGER_DATATYPE
+            : dataType->second == ColumnStoreAbstract::TIME_DATATYPE;
+        if (!valid) {
+            cout << "Cannot group by the " << (key.part == Key::VALUE ? "values" : "dates") << " of column " << key.column << "." << endl;
+            return false;
+        }
+    }
+    for (const string& column : valueColumns) {
+        if (!store.validationCheckForMinMax(column)) { return false; }
+    }
+    return true;
+}
+
+vector<GroupBy::Group> GroupBy::run(ColumnStoreAbstract& store, const Selection& rows) const {
+    vector<Group> groups;
+    if (!validate(store)) { return groups; }
+
+    // Every column is read once per morsel, even when several key parts come from it
+    vector<string> columns;
+    auto columnIndex = [&columns](const string& column) {
+        size_t index = find(columns.begin(), columns.end(), column) - columns.begin();
+        if (index == columns.size()) { columns.push_back(column); }
+        return index;
+    };
+    vector<size_t> keyColumns, valueIndexes;
+    for (const Key& key : keys) { keyColumns.push_back(columnIndex(key.column)); }
+    for (const string& column : valueColumns) { valueIndexes.push_back(columnIndex(column)); }
+    vector<int> dataTypes;
+    for (const string& column : columns) { dataTypes.push_back(store.columnDataTypes[column]); }
+
+    // STRING key values are numbered in the order they are first seen
+    deque<string> strings; // stable, the numbers map views of them
+    unordered_map<string_view, int64_t> stringNumbers;
+    string_view previousString;
+    int64_t previousNumber = 0;
+    auto numberOf = [&](string_view value) {
+        // A view of the same store value as the previous row, without hashing it
+        if (value.data() == previousString.data() && value.size() == previousString.size()) { return previousNumber; }
+        auto it = stringNumbers.find(value);
+        if (it == stringNumbers.end()) {
+            strings.push_back(string(value));
+            it = stringNumbers.emplace(strings.back(), strings.size() - 1).first;
+        }
+        previousString = value;
+        previousNumber = it->second;
+        return previousNumber;
+    };
+
+    // The date is worked out once per day rather than once per row
+    int64_t cachedDays = numeric_limits<int64_t>::min();
+    int year = 0, month = 0, day = 0;
+    auto datePart = [&](int64_t time, Key::Part part) -> int64_t {
+        int64_t days = TimeFormat::daysFromEpoch(time);
+        if (days != cachedDays) {
+            TimeFormat::civilFromDays(days, year, month, day);
+            cachedDays = days;
+        }
+        return part == Key::YEAR ? year : part == Key::MONTH ? month : days;
+    };
+
+    unordered_map<vector<int64_t>, size_t, KeyHash> groupIndexes;
+    vector<vector<int64_t>> groupKeys;
+    vector<int64_t> key(keys.size());
+    size_t group = groups.size(); // of the previous row, none yet
+
+    uint64_t upperBound = rows.upperBound();
+    for (uint64_t first = 0; first < upperBound; first += Morsels::MORSEL_ROWS) {
+        Selection morsel = rows.slice(first, min<uint64_t>(first + Morsels::MORSEL_ROWS, upperBound));
+        if (morsel.empty()) { continue; }
+        vector<ColumnBatch::Column> values;
+        for (size_t column = 0; column < columns.size(); column++) {
+            values.emplace_back(columns[column], dataTypes[column]);
+            store.getValues(columns[column], morsel, values.back());
+        }
+
+        size_t position = 0;
+        morsel.forEach([&](uint32_t row) {
+            size_t i = position++;
+            for (size_t part = 0; part < keys.size(); part++) {
+                const ColumnBatch::Column& column = values[keyColumns[part]];
+                if (column.dataType == ColumnStoreAbstract::TIME_DATATYPE) {
+                    int64_t time = column.times[i];
+                    if (time == ColumnStoreAbstract::NULL_TIME) { return; }
+                    key[part] = datePart(time, keys[part].part);
+                } else if (column.dataType == ColumnStoreAbstract::INTEGER_DATATYPE) {
+                    int32_t value = column.integers[i];
+                    if (value == ColumnStoreAbstract::NULL_INTEGER) { return; }
+                    key[part] = value;
+                } else {
+                    string_view value = column.strings[i];
+                    if (value == "M") { return; }
+                    key[part] = numberOf(value);
+                }
+            }
+
+            if (group == groups.size() || key != groupKeys[group]) {
+                auto it = groupIndexes.find(key);
+                if (it == groupIndexes.end()) {
+                    it = groupIndexes.emplace(key, groups.size()).first;
+                    groupKeys.push_back(key);
+                    groups.emplace_back();
+                    groups.back().aggregates.resize(valueColumns.size());
+                }
+                group = it->second;
+            }
+
+            Group& current = groups[group];
+            current.rowCount++;
+            for (size_t v = 0; v < valueIndexes.size(); v++) {
+                const ColumnBatch::Column& column = values[valueIndexes[v]];
+                if (column.dataType == ColumnStoreAbstract::INTEGER_DATATYPE) {
+                    int32_t value = column.integers[i];
+                    if (value != ColumnStoreAbstract::NULL_INTEGER) { current.aggregates[v].add(value, row); }
+                } else {
+                    float value = column.floats[i];
+                    if (!isnan(value)) { current.aggregates[v].add(value, row); }
+                }
+            }
+        });
+    }
+
+    // Sort by key, STRING parts by their values
+    vector<size_t> order(groups.size());
+    for (size_t i = 0; i < order.size(); i++) { order[i] = i; }
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        for (size_t part = 0; part < keys.size(); part++) {
+            int64_t left = groupKeys[a][part], right = groupKeys[b][part];
+            if (left == right) { continue; }
+            if (dataTypes[keyColumns[part]] == ColumnStoreAbstract::STRING_DATATYPE) { return strings[left] < strings[right]; }
+            return left < right;
+        }
+        return false;
+    });
+
+    vector<Group> sorted;
+    for (size_t index : order) {
+        Group& current = groups[index];
+        for (size_t part = 0; part < keys.size(); part++) {
+            int64_t value = groupKeys[index][part];
+            if (keys[part].part == Key::DATE) {
+                current.key.push_back(Object((long long) (value * 86400)));
+            } else if (dataTypes[keyColumns[part]] == ColumnStoreAbstract::STRING_DATATYPE) {
+                current.key.push_back(Object(strings[value]));
+            } else {
+                current.key.push_back(Object((int) value));
+            }
+        }
+        sorted.push_back(move(current));
+    }
+    return sorted;
+}
@@ -0,0 +1,84 @@
+// GroupBy.h
+
+#ifndef GROUPBY_H
+#define GROUPBY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ColumnStoreAbstract.h"
+#include "Selection.h"
+
+using namespace std;
+
+// Grouped aggregation of the selected rows of a column store in a single pass.
+//
+// Every row goes to the group of its key, e.g. (Station, year, month) or (Station, date), and the
+// aggregates of each value column are updated in place: count, sum, average, and the minimum and maximum
+// together with every row holding them. The rows are read a morsel at a time through getValues(), so the
+// operator works the same on every store and only holds one morsel of each column in memory.
+//
+// Groups are found through a hash table on the key, encoded as one integer per key part (STRING values
+// are numbered once per distinct value). Consecutive rows with the same key, the common case for data
+// stored in station and time order, reuse the group of the previous row without a lookup.
+class GroupBy {
+    public:
+        // One part of the key: the value of a STRING or INTEGER column, or the year, month or date of a TIME column.
+        class Key {
+            public:
+                enum Part {VALUE, YEAR, MONTH, DATE};
+
+                string column;
+                Part part;
+
+                static Key value(string column);
+                static Key year(string column);
+                // The month (1-12), usually grouped together with the year.
+                static Key month(string column);
+                // The day, together with its month and year.
+                static Key date(string column);
+        };
+
+        // The aggregates of one value column over the rows of a group. Null values are skipped.
+        class Aggregate {
+            public:
+                size_t count = 0; // non-null values
+                double sum = 0;
+                double min = 0; // min and max are only set once count > 0
+                double max = 0;
+                Selection minRows; // every row holding the minimum
+                Selection maxRows; // every row holding the maximum
+
+                // sum / count, NaN if there were only nulls.
+                double avg() const;
+
+                // Adds the value of a row. Rows are added in increasing order.
+                void add(double value, uint32_t row);
+        };
+
+        // The rows sharing one key.
+        class Group {
+            public:
+                // One value per key part: the STRING or INTEGER value, the year or month as an INT,
+                // the date as the TIME of its start.
+                vector<Object> key;
+                size_t rowCount = 0;
+                vector<Aggregate> aggregates; // one per value column, INTEGER or FLOAT
+        };
+
+        GroupBy(vector<Key> keys, vector<string> valueColumns);
+
+        // The groups of the selected rows, sorted by key. A row with a null key part belongs to no group.
+        // Returns no groups if a column is not registered or does not have a data type it can be used with.
+        vector<Group> run(ColumnStoreAbstract& store, const Selection& rows) const;
+
+    private:
+        vector<Key> keys;
+        vector<string> valueColumns;
+
+        // Whether every column can be used with the store, printing why not otherwise
+        bool validate(ColumnStoreAbstract& store) const;
+};
+
+#endif
@@ -12,9 +12,16 @@
 #include "ColumnDiskStore.h" // this is a header file that defines the disk-based column store class
 #include "ColumnDiskStoreEnhanced.h" // this is a header file that defines the enhanced disk-based column store class
 #include "Output.h" // this is a header file that defines the output class
+#include "Predicate.h" // this is a header file that defines the filter predicates
+#include "Selection.h" // this is a header file that defines the compressed index selections
+#include "TimeFormat.h" // this is a header file that defines the conversions of TIME values
+#include "ExtremesReport.h" // this is a header file that defines the pipeline of the monthly extremes report
 
 using namespace std;
 
+vector<Output> getExtremeValues(ColumnStoreAbstract* data, int year, string station);
+void writeOutput(string filepath, vector<Output> toWrite);
+
 int main() {
     // create a map of data types
     unordered_map<string, int> dataTypes;
@@ -58,72 +65,18 @@ int main() {
 
 /**
  * Gets the extreme values for each month in the year specified and station specified.
+ * The rows are passed along as indexes until the timestamps of the rows holding the extremes are read, all at once.
  * paramater data the column store
  * paramater year the year given
  * paramater station the station given
  * return a vector of Output objects representing the extreme values.
  */
 vector<Output> getExtremeValues(ColumnStoreAbstract* data, int year, string station) {
-    if (dynamic_cast<ColumnStoreDiskEnhanced*>(data)) {
-        return getExtremeValues(data, year, station); //use custom implementation
-    }
-
-    vector<int> yearIndices = data->filter("Timestamp", Object(year).flag);
-    vector<int> stationAndYearIndices = data->filter("Station", Object(station).flag, yearIndices);
-    vector<Output> result;
-    for (int month = 1; month <= 12; month++) {
-        int m = month; //need to use a final variable in lambda functions
-        vector<int> currentMonthIndices = data->filter("Timestamp", Object(station).flag, stationAndYearIndices);
-        result.insert(result.end(), processMonth(data, currentMonthIndices, "Humidity", "max", station).begin(), processMonth(data, currentMonthIndices, "Humidity", "min", station).begin());
-        result.insert(result.end(), processMonth(data, currentMonthIndices, "Temperature", "max", station).begin(), processMonth(data, currentMonthIndices, "Temperature", "min", station).begin());
-    }
-
-    return result;
-};
-
-/**
- * gets the extreme values for the specified month in the given column for the given station.
- * paramater data the column store
- * paramater currMonth the vector of indexes representing the current month (and year)
- * paramater column the column given
- * paramater valueType "max" or "min"
- * paramater stationName the station given
- * return a list of Output objects representing the extreme values.
- */
-vector<Output> processMonth(ColumnStoreAbstract* data, vector<int> currMonth, string column, string valueType, string stationName) {
-    vector<Output> result;
-    set<int> addedDays;
-    if (column.compare("Humidity") != 0 && column.compare("Temperature") != 0) {
-        cout << "This is a specific function that only accepts Humidity or Temperature columns." << endl;
-        return result;
-    }
-
-    if (valueType.compare("min") != 0 && valueType.compare("max") != 0) {
-        cout << "Value type must be 'min' or 'max' only!" << endl;
-        return result;
-    }
-
-    vector<int> qualifiedIndexes = valueType.compare("max") == 0 ? data->getMax(column, currMonth) : data->getMin(column, currMonth);
-    for (int index: qualifiedIndexes) {
-        Object* timestamp = data->getValue("Timestamp", index);
-        if (addedDays.find(timestamp->fval) != addedDays.end()) {
-            continue; // we do not want duplicate days, we only want duplicate months
-        } else { addedDays.insert(timestamp->fval); }
-
-        float value = (float) data->getValue(column, index)->fval;
-        int outputType = -1;
-        if (column.compare("Humidity") == 0) {
-            if (valueType.compare("min") == 0) { outputType = Output::MIN_HUMIDITY; }
-            else { outputType = Output::MAX_HUMIDITY; }
-        } else {
-            if (valueType.compare("min") == 0) { outputType = Output::MIN_TEMP; }
-            else { outputType = Output::MAX_TEMP; }
-        }
-
-        result.push_back(Output(*timestamp, stationName, outputType, value));
+    if (ColumnStoreDiskEnhanced* enhanced = dynamic_cast<ColumnStoreDiskEnhanced*>(data)) {
+        return enhanced->getExtremeValues(year, station); //use custom implementation
     }
 
-    return result;
+    return ExtremesReport::run(*data, year, station);
 }
 
 /**
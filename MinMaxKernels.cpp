@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <limits>
+#include "MinMaxKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MINMAX_X86 1
+#endif
+
+using namespace std;
+
+namespace {
+
+    // Kernels over one block of values. reduce() skips nulls and leaves min/max at their starting
+    // values (+inf/-inf, INT_MAX/INT_MIN) when the block holds no value.
+    // collect() writes the offsets of the values equal to target into out and returns how many.
+    struct FloatKernels {
+        const char* name;
+        void (*reduce)(const float* values, size_t count, float& min, float& max);
+        size_t (*collect)(const float* values, size_t count, float target, uint32_t* out);
+    };
+
+    struct IntegerKernels {
+        void (*reduce)(const int32_t* values, size_t count, int32_t& min, int32_t& max);
+        size_t (*collect)(const int32_t* values, size_t count, int32_t target, uint32_t* out);
+    };
+
+    void reduceFloatScalar(const float* values, size_t count, float& min, float& max) {
+        for (size_t i = 0; i < count; i++) {
+            float value = values[i];
+            if (value < min) { min = value; } // comparisons with NaN are false, so nulls are skipped
+            if (value > max) { max = value; }
+        }
+    }
+
+    size_t collectFloatScalar(const float* values, size_t count, float target, uint32_t* out) {
+        size_t found = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (values[i] == target) { out[found++] = i; }
+        }
+        return found;
+    }
+
+    void reduceIntegerScalar(const int32_t* values, size_t count, int32_t& min, int32_t& max) {
+        for (size_t i = 0; i < count; i++) {
+            int32_t value = values[i];
+            if (value == INT_MIN) { continue; } // null
+            if (value < min) { min = value; }
+            if (value > max) { max = value; }
+        }
+    }
+
+    size_t collectIntegerScalar(const int32_t* values, size_t count, int32_t target, uint32_t* out) {
+        size_t found = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (values[i] == target) { out[found++] = i; }
+        }
+        return found;
+    }
+
+#ifdef MINMAX_X86
+    // Appends the offsets of the set bits of a movemask result.
+    inline size_t appendMask(unsigned mask, uint32_t base, uint32_t* out, size_t found) {
+        while (mask != 0) {
+            out[found++] = base + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+        return found;
+    }
+
+    // _mm*_min_ps(x, acc) returns acc when x is NaN, so nulls are skipped without a mask.
+    __attribute__((target("avx2")))
+    void reduceFloatAvx2(const float* values, size_t count, float& min, float& max) {
+        __m256 mins = _mm256_set1_ps(min), maxs = _mm256_set1_ps(max);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256 x = _mm256_loadu_ps(values + i);
+            mins = _mm256_min_ps(x, mins);
+            maxs = _mm256_max_ps(x, maxs);
+        }
+        float lanesMin[8], lanesMax[8];
+        _mm256_storeu_ps(lanesMin, mins);
+        _mm256_storeu_ps(lanesMax, maxs);
+        for (int lane = 0; lane < 8; lane++) {
+            if (lanesMin[lane] < min) { min = lanesMin[lane]; }
+            if (lanesMax[lane] > max) { max = lanesMax[lane]; }
+        }
+        reduceFloatScalar(values + i, count - i, min, max);
+    }
+
+    __attribute__((target("avx2")))
+    size_t collectFloatAvx2(const float* values, size_t count, float target, uint32_t* out) {
+        __m256 targets = _mm256_set1_ps(target);
+        size_t found = 0, i = 0;
+        for (; i + 8 <= count; i += 8) {
+            unsigned mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(values + i), targets, _CMP_EQ_OQ));
+            found = appendMask(mask, i, out, found);
+        }
+        for (; i < count; i++) {
+            if (values[i] == target) { out[found++] = i; }
+        }
+        return found;
+    }
+
+    __attribute__((target("avx2")))
+    void reduceIntegerAvx2(const int32_t* values, size_t count, int32_t& min, int32_t& max) {
+        __m256i mins = _mm256_set1_epi32(min), maxs = _mm256_set1_epi32(max);
+        __m256i nulls = _mm256_set1_epi32(INT_MIN), largest = _mm256_set1_epi32(INT_MAX);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i x = _mm256_loadu_si256((const __m256i*) (values + i));
+            // INT_MIN never wins a max, but has to be replaced by INT_MAX so that it never wins a min
+            __m256i forMin = _mm256_blendv_epi8(x, largest, _mm256_cmpeq_epi32(x, nulls));
+            mins = _mm256_min_epi32(mins, forMin);
+            maxs = _mm256_max_epi32(maxs, x);
+        }
+        int32_t lanesMin[8], lanesMax[8];
+        _mm256_storeu_si256((__m256i*) lanesMin, mins);
+        _mm256_storeu_si256((__m256i*) lanesMax, maxs);
+        for (int lane = 0; lane < 8; lane++) {
+            min = std::min(min, lanesMin[lane]);
+            max = std::max(max, lanesMax[lane]);
+        }
+        reduceIntegerScalar(values + i, count - i, min, max);
+    }
+
+    __attribute__((target("avx2")))
+    size_t collectIntegerAvx2(const int32_t* values, size_t count, int32_t target, uint32_t* out) {
+        __m256i targets = _mm256_set1_epi32(target);
+        size_t found = 0, i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*) (values + i)), targets);
+            found = appendMask(_mm256_movemask_ps(_mm256_castsi256_ps(equal)), i, out, found);
+        }
+        for (; i < count; i++) {
+            if (values[i] == target) { out[found++] = i; }
+        }
+        return found;
+    }
+
+    __attribute__((target("sse4.1")))
+    void reduceFloatSse(const float* values, size_t count, float& min, float& max) {
+        __m128 mins = _mm_set1_ps(min), maxs = _mm_set1_ps(max);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 x = _mm_loadu_ps(values + i);
+            mins = _mm_min_ps(x, mins);
+            maxs = _mm_max_ps(x, maxs);
+        }
+        float lanesMin[4], lanesMax[4];
+        _mm_storeu_ps(lanesMin, mins);
+        _mm_storeu_ps(lanesMax, maxs);
+        for (int lane = 0; lane < 4; lane++) {
+            if (lanesMin[lane] < min) { min = lanesMin[lane]; }
+            if (lanesMax[lane] > max) { max = lanesMax[lane]; }
+        }
+        reduceFloatScalar(values + i, count - i, min, max);
+    }
+
+    __attribute__((target("sse4.1")))
+    size_t collectFloatSse(const float* values, size_t count, float target, uint32_t* out) {
+        __m128 targets = _mm_set1_ps(target);
+        size_t found = 0, i = 0;
+        for (; i + 4 <= count; i += 4) {
+            found = appendMask(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(values + i), targets)), i, out, found);
+        }
+        for (; i < count; i++) {
+            if (values[i] == target) { out[found++] = i; }
+        }
+        return found;
+    }
+
+    __attribute__((target("sse4.1")))
+    void reduceIntegerSse(const int32_t* values, size_t count, int32_t& min, int32_t& max) {
+        __m128i mins = _mm_set1_epi32(min), maxs = _mm_set1_epi32(max);
+        __m128i nulls = _mm_set1_epi32(INT_MIN), largest = _mm_set1_epi32(INT_MAX);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i x = _mm_loadu_si128((const __m128i*) (values + i));
+            __m128i forMin = _mm_blendv_epi8(x, largest, _mm_cmpeq_epi32(x, nulls));
+            mins = _mm_min_epi32(mins, forMin);
+            maxs = _mm_max_epi32(maxs, x);
+        }
+        int32_t lanesMin[4], lanesMax[4];
+        _mm_storeu_si128((__m128i*) lanesMin, mins);
+        _mm_storeu_si128((__m128i*) lanesMax, maxs);
+        for (int lane = 0; lane < 4; lane++) {
+            min = std::min(min, lanesMin[lane]);
+            max = std::max(max, lanesMax[lane]);
+        }
+        reduceIntegerScalar(values + i, count - i, min, max);
+    }
+
+    __attribute__((target("sse4.1")))
+    size_t collectIntegerSse(const int32_t* values, size_t count, int32_t target, uint32_t* out) {
+        __m128i targets = _mm_set1_epi32(target);
+        size_t found = 0, i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*) (values + i)), targets);
+            found = appendMask(_mm_movemask_ps(_mm_castsi128_ps(equal)), i, out, found);
+        }
+        for (; i < count; i++) {
+            if (values[i] == target) { out[found++] = i; }
+        }
+        return found;
+    }
+#endif
+
+    // Picks the widest instruction set supported by the CPU, once.
+    int instructionSet() {
+        static const int picked = [] {
+#ifdef MINMAX_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) { return 2; }
+            if (__builtin_cpu_supports("sse4.1")) { return 1; }
+#endif
+            return 0;
+        }();
+        return picked;
+    }
+
+    const FloatKernels& floatKernels() {
+        static const FloatKernels kernels = [] {
+#ifdef MINMAX_X86
+            if (instructionSet() == 2) { return FloatKernels{"avx2", reduceFloatAvx2, collectFloatAvx2}; }
+            if (instructionSet() == 1) { return FloatKernels{"sse4.1", reduceFloatSse, collectFloatSse}; }
+#endif
+            return FloatKernels{"scalar", reduceFloatScalar, collectFloatScalar};
+        }();
+        return kernels;
+    }
+
+    const IntegerKernels& integerKernels() {
+        static const IntegerKernels kernels = [] {
+#ifdef MINMAX_X86
+            if (instructionSet() == 2) { return IntegerKernels{reduceIntegerAvx2, collectIntegerAvx2}; }
+            if (instructionSet() == 1) { return IntegerKernels{reduceIntegerSse, collectIntegerSse}; }
+#endif
+            return IntegerKernels{reduceIntegerScalar, collectIntegerScalar};
+        }();
+        return kernels;
+    }
+
+    // Type specific entry points used by MinMaxAccumulator.
+    void reduce(const float* values, size_t count, float& min, float& max) {
+        min = numeric_limits<float>::infinity();
+        max = -numeric_limits<float>::infinity();
+        floatKernels().reduce(values, count, min, max);
+    }
+
+    void reduce(const int32_t* values, size_t count, int32_t& min, int32_t& max) {
+        min = INT_MAX;
+        max = INT_MIN;
+        integerKernels().reduce(values, count, min, max);
+    }
+
+    size_t collect(const float* values, size_t count, float target, uint32_t* out) {
+        return floatKernels().collect(values, count, target, out);
+    }
+
+    size_t collect(const int32_t* values, size_t count, int32_t target, uint32_t* out) {
+        return integerKernels().collect(values, count, target, out);
+    }
+
+    // NaN and INT_MIN are the null sentinels, they are never an extreme value.
+    bool isNullValue(float value) { return isnan(value); }
+    bool isNullValue(int32_t value) { return value == INT_MIN; }
+}
+
+template <typename T>
+template <typename RowOf>
+void MinMaxAccumulator<T>::addBlock(const T* values, size_t count, RowOf rowOf) {
+    T blockMin, blockMax;
+    reduce(values, count, blockMin, blockMax);
+
+    // A block that held only nulls leaves blockMin/blockMax at their starting values. Collecting
+    // those finds nothing (NaN never compares equal) or only real INT_MAX/infinity values.
+    uint32_t offsets[BLOCK_SIZE];
+    bool wasFound = state.found;
+    if (!isNullValue(blockMin) && (!wasFound || blockMin <= state.min)) {
+        size_t found = collect(values, count, blockMin, offsets);
+        if (found > 0) {
+            if (!wasFound || blockMin < state.min) {
+                state.min = blockMin;
+                state.minRows = Selection();
+            }
+            for (size_t i = 0; i < found; i++) { state.minRows.add(rowOf(offsets[i])); }
+            state.found = true;
+        }
+    }
+    if (!isNullValue(blockMax) && (!wasFound || blockMax >= state.max)) {
+        size_t found = collect(values, count, blockMax, offsets);
+        if (found > 0) {
+            if (!wasFound || blockMax > state.max) {
+                state.max = blockMax;
+                state.maxRows = Selection();
+            }
+            for (size_t i = 0; i < found; i++) { state.maxRows.add(rowOf(offsets[i])); }
+            state.found = true;
+        }
+    }
+}
+
+template <typename T>
+void MinMaxAccumulator<T>::addDense(const T* values, size_t count, uint32_t firstRow) {
+    for (size_t start = 0; start < count; start += BLOCK_SIZE) {
+        uint32_t blockRow = firstRow + start;
+        addBlock(values + start, min(BLOCK_SIZE, count - start), [blockRow](uint32_t offset) { return blockRow + offset; });
+    }
+}
+
+template <typename T>
+void MinMaxAccumulator<T>::addGathered(const T* values, const uint32_t* rows, size_t count) {
+    for (size_t start = 0; start < count; start += BLOCK_SIZE) {
+        const uint32_t* blockRows = rows + start;
+        addBlock(values + start, min(BLOCK_SIZE, count - start), [blockRows](uint32_t offset) { return blockRows[offset]; });
+    }
+}
+
+template <typename T>
+void MinMaxAccumulator<T>::merge(const MinMax<T>& other) {
+    if (!other.found) { return; }
+    if (!state.found) {
+        state = other;
+        return;
+    }
+    if (other.min < state.min) {
+        state.min = other.min;
+        state.minRows = other.minRows;
+    } else if (other.min == state.min) {
+        state.minRows = state.minRows | other.minRows;
+    }
+    if (other.max > state.max) {
+        state.max = other.max;
+        state.maxRows = other.maxRows;
+    } else if (other.max == state.max) {
+        state.maxRows = state.maxRows | other.maxRows;
+    }
+}
+
+template <typename T>
+MinMax<T> minMax(const T* column, const Selection& rows) {
+    // Runs at least this long are scanned in place instead of being gathered.
+    const uint32_t DENSE_RUN = 64;
+
+    MinMaxAccumulator<T> accumulator;
+    T values[MinMaxAccumulator<T>::BLOCK_SIZE];
+    uint32_t positions[MinMaxAccumulator<T>::BLOCK_SIZE];
+    size_t pending = 0;
+    auto flush = [&]() {
+        accumulator.addGathered(values, positions, pending);
+        pending = 0;
+    };
+
+    rows.forEachRun([&](uint32_t start, uint32_t end) {
+        if (end - start >= DENSE_RUN) {
+            flush();
+            accumulator.addDense(column + start, end - start, start);
+            return;
+        }
+        for (uint32_t row = start; row < end; row++) {
+            values[pending] = column[row];
+            positions[pending++] = row;
+            if (pending == MinMaxAccumulator<T>::BLOCK_SIZE) { flush(); }
+        }
+    });
+    flush();
+    return accumulator.result();
+}
+
+const char* minMaxKernelName() {
+    return floatKernels().name;
+}
+
+template class MinMaxAccumulator<float>;
+template class MinMaxAccumulator<int32_t>;
+template MinMax<float> minMax(const float* column, const Selection& rows);
+template MinMax<int32_t> minMax(const int32_t* column, const Selection& rows);
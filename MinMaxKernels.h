@@ -0,0 +1,60 @@
+// MinMaxKernels.h
+
+#ifndef MINMAXKERNELS_H
+#define MINMAXKERNELS_H
+
+#include <cstdint>
+#include <cstddef>
+#include "Selection.h"
+
+using namespace std;
+
+// The minimum and maximum of the scanned values of an INTEGER (int32) or FLOAT column,
+// together with every row holding them (ties are kept, like getMax()/getMin() require).
+// Null values (INT_MIN and NaN) are skipped.
+template <typename T>
+struct MinMax {
+    bool found = false; // false if every scanned value was null
+    T min = T();
+    T max = T();
+    Selection minRows;
+    Selection maxRows;
+};
+
+// Computes MinMax in one pass over values fed in increasing row order.
+//
+// Values are processed in blocks of BLOCK_SIZE: a vectorized kernel (AVX2 or SSE4.1, picked at
+// runtime, with a scalar fallback) reduces the block to its min and max, and only when the block
+// reaches or beats the running extremes is it compared again (still in cache) to collect the tied rows.
+template <typename T>
+class MinMaxAccumulator {
+    public:
+        static constexpr size_t BLOCK_SIZE = 2048;
+
+        // Adds the values of the consecutive rows [firstRow, firstRow + count).
+        void addDense(const T* values, size_t count, uint32_t firstRow);
+
+        // Adds values[i] as the value of rows[i].
+        void addGathered(const T* values, const uint32_t* rows, size_t count);
+
+        // Merges the result of a scan over rows disjoint from the rows added so far, in any order.
+        void merge(const MinMax<T>& other);
+
+        const MinMax<T>& result() const { return state; }
+
+    private:
+        MinMax<T> state;
+
+        template <typename RowOf>
+        void addBlock(const T* values, size_t count, RowOf rowOf);
+};
+
+// Computes MinMax of column[row] for every selected row. Long runs of consecutive rows are
+// scanned in place, the remaining rows are gathered into blocks first.
+template <typename T>
+MinMax<T> minMax(const T* column, const Selection& rows);
+
+// The instruction set of the kernels picked for this CPU: "avx2", "sse4.1" or "scalar".
+const char* minMaxKernelName();
+
+#endif
@@ -0,0 +1,99 @@
+// Morsels.h
+
+#ifndef MORSELS_H
+#define MORSELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Selection.h"
+#include "MinMaxKernels.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+// Parallel scans of a single column, shared by the stores.
+//
+// The rows of the column are split into morsels of MORSEL_ROWS consecutive rows, which the workers
+// of the shared ThreadPool pick up one at a time, so that a slow morsel never holds up the others.
+// Every morsel produces a partial result of its own, merged on the calling thread once all are done.
+// A morsel is one chunk of a Selection, so the per-morsel selections are concatenated without
+// touching their rows.
+//
+// The functions given to the morsels run concurrently: they may only read the column and must
+// not look anything up in the maps of the store.
+namespace Morsels {
+    const uint32_t MORSEL_ROWS = Selection::CHUNK_SIZE;
+
+    // Calls process(morsel, first, end) for every morsel [first, end) of the rows [0, rowCount).
+    // Runs on the calling thread when there is a single morsel or a single worker.
+    template <typename Process>
+    void forEach(size_t rowCount, Process process) {
+        size_t morselCount = (rowCount + MORSEL_ROWS - 1) / MORSEL_ROWS;
+        auto run = [&process, rowCount](size_t morsel) {
+            size_t first = morsel * MORSEL_ROWS;
+            process(morsel, (uint32_t) first, (uint32_t) min(rowCount, first + MORSEL_ROWS));
+        };
+
+        if (morselCount <= 1 || ThreadPool::shared().workerCount() <= 1) {
+            for (size_t morsel = 0; morsel < morselCount; morsel++) { run(morsel); }
+            return;
+        }
+        TaskGroup group;
+        for (size_t morsel = 0; morsel < morselCount; morsel++) {
+            group.run([&run, morsel]() { run(morsel); });
+        }
+        group.wait();
+    }
+
+    // Calls process(morsel, rows) with the selected rows of every morsel holding any.
+    template <typename Process>
+    void forEach(const Selection& rows, Process process) {
+        forEach(rows.upperBound(), [&rows, &process](size_t morsel, uint32_t first, uint32_t end) {
+            Selection slice = rows.slice(first, end);
+            if (!slice.empty()) { process(morsel, slice); }
+        });
+    }
+
+    // The rows of [0, rowCount) selected by scan(first, end), which returns the matching rows of one morsel.
+    template <typename Scan>
+    Selection filter(size_t rowCount, Scan scan) {
+        vector<Selection> parts((rowCount + MORSEL_ROWS - 1) / MORSEL_ROWS);
+        forEach(rowCount, [&parts, &scan](size_t morsel, uint32_t first, uint32_t end) {
+            parts[morsel] = scan(first, end);
+        });
+
+        Selection results;
+        for (Selection& part : parts) { results.append(move(part)); }
+        return results;
+    }
+
+    // The rows among rows selected by scan(slice), which returns the matching rows of one morsel.
+    template <typename Scan>
+    Selection filter(const Selection& rows, Scan scan) {
+        vector<Selection> parts((rows.upperBound() + (size_t) MORSEL_ROWS - 1) / MORSEL_ROWS);
+        forEach(rows, [&parts, &scan](size_t morsel, const Selection& slice) {
+            parts[morsel] = scan(slice);
+        });
+
+        Selection results;
+        for (Selection& part : parts) { results.append(move(part)); }
+        return results;
+    }
+
+    // MinMax of column[row] for every selected row, computed per morsel and merged.
+    // Ties across morsels are merged like ties within one, so every row holding an extreme is kept.
+    template <typename T>
+    MinMax<T> minMax(const T* column, const Selection& rows) {
+        vector<MinMax<T>> parts((rows.upperBound() + (size_t) MORSEL_ROWS - 1) / MORSEL_ROWS);
+        forEach(rows, [column, &parts](size_t morsel, const Selection& slice) {
+            parts[morsel] = ::minMax(column, slice);
+        });
+
+        MinMaxAccumulator<T> accumulator;
+        for (const MinMax<T>& part : parts) { accumulator.merge(part); }
+        return accumulator.result();
+    }
+}
+
+#endif
@@ -79,9 +79,10 @@ class Output {
 
         // override the << operator for printing
         friend ostream& operator<<(ostream& os, const Output& out) {
-            // use strftime to format the date
+            // use strftime to format the date, dates are stored as wall-clock epoch seconds (see TimeFormat)
             char buffer[20];
-            strftime(buffer, 20, "%Y-%m-%d", localtime(&out.date));
+            tm date;
+            strftime(buffer, 20, "%Y-%m-%d", gmtime_r(&out.date, &date));
             os << buffer << "," << out.stationName << "," << out.value;
             return os;
         }
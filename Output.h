@@ -19,10 +19,14 @@ class Output {
         static const int MIN_HUMIDITY = 2;
         static const int MIN_TEMP = 3;
 
+        time_t date; // use time_t to store date and time
+        string stationName;
+        int type;
+        float value;
+
         // constructors
         Output();
         Output(time_t date, string station, int type, float value);
-        Output(Object date, string station, int type, float value);
 
         // getters
         time_t getDate();
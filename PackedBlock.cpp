@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include "PackedBlock.h"
+
+using namespace std;
+
+namespace {
+    // Number of bits needed for values from 0 to range
+    int bitsFor(uint64_t range) {
+        return range == 0 ? 0 : 64 - __builtin_clzll(range);
+    }
+
+    uint64_t maskFor(int width) {
+        return width == 64 ? ~0ULL : (1ULL << width) - 1;
+    }
+
+    // The index-th value of width bits, the bits being followed by PackedBlock::PADDING bytes
+    inline uint64_t unpack(const char* bits, size_t index, int width, uint64_t mask) {
+        size_t bit = index * width;
+        uint64_t word;
+        memcpy(&word, bits + bit / 8, 8);
+        uint64_t value = word >> (bit % 8);
+        if (bit % 8 + width > 64) { value |= (uint64_t) (uint8_t) bits[bit / 8 + 8] << (64 - bit % 8); }
+        return value & mask;
+    }
+
+    // Stores the index-th value of width bits into zeroed bits
+    void pack(char* bits, size_t index, int width, uint64_t value) {
+        size_t bit = index * width;
+        uint64_t word;
+        memcpy(&word, bits + bit / 8, 8);
+        word |= value << (bit % 8);
+        memcpy(bits + bit / 8, &word, 8);
+        if (bit % 8 + width > 64) { bits[bit / 8 + 8] |= (char) (value >> (64 - bit % 8)); }
+    }
+
+    bool isNullAt(const char* nulls, size_t index) {
+        return (nulls[index / 8] >> (index % 8)) & 1;
+    }
+
+    // The inclusive bounds [lower, upper] of the values matching an EQ or RANGE predicate on integers,
+    // false for any other predicate. lower > upper when nothing matches.
+    bool integerBounds(const Predicate& predicate, long long& lower, long long& upper) {
+        if (predicate.kind == Predicate::EQ && !predicate.literals[0].isText) {
+            lower = upper = predicate.literals[0].integer;
+            return true;
+        }
+        if (predicate.kind != Predicate::RANGE) { return false; }
+        if ((predicate.hasLower && predicate.literals[0].isText) || (predicate.hasUpper && predicate.literals[1].isText)) { return false; }
+
+        lower = LLONG_MIN;
+        upper = LLONG_MAX;
+        if (predicate.hasLower) {
+            lower = predicate.literals[0].integer;
+            if (!predicate.lowerInclusive) {
+                if (lower == LLONG_MAX) { upper = LLONG_MIN; return true; }
+                lower++;
+            }
+        }
+        if (predicate.hasUpper) {
+            upper = min(upper, predicate.literals[1].integer);
+            if (!predicate.upperInclusive) {
+                if (upper == LLONG_MIN) { lower = LLONG_MAX; return true; }
+                upper--;
+            }
+        }
+        return true;
+    }
+
+    // Where the null bitmap and the packed values of a block start
+    const char* nullsOf(const char* block) {
+        return block + sizeof(PackedBlock::Header);
+    }
+
+    const char* bitsOf(const char* block, const PackedBlock::Header& header) {
+        return nullsOf(block) + (header.hasNulls ? (header.count + 7) / 8 : 0);
+    }
+}
+
+template <typename T>
+void PackedBlock::encode(const T* values, size_t count, T null, vector<char>& out) {
+    Header header = {};
+    header.count = count;
+
+    // Frame of reference: the values relative to the minimum
+    bool hasValues = false;
+    int64_t minValue = 0, maxValue = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (values[i] == null) {
+            header.hasNulls = 1;
+            continue;
+        }
+        if (!hasValues || values[i] < minValue) { minValue = values[i]; }
+        if (!hasValues || values[i] > maxValue) { maxValue = values[i]; }
+        hasValues = true;
+    }
+    int width = bitsFor((uint64_t) maxValue - (uint64_t) minValue);
+
+    // Delta: the differences to the previous value relative to the smallest one, wrapping around like the values do
+    bool sorted = !header.hasNulls;
+    int64_t minDelta = 0, maxDelta = 0;
+    for (size_t i = 1; i < count && !header.hasNulls; i++) {
+        int64_t delta = (int64_t) ((uint64_t) (int64_t) values[i] - (uint64_t) (int64_t) values[i - 1]);
+        if (i == 1 || delta < minDelta) { minDelta = delta; }
+        if (i == 1 || delta > maxDelta) { maxDelta = delta; }
+        if (values[i] < values[i - 1]) { sorted = false; }
+    }
+    int deltaWidth = bitsFor((uint64_t) maxDelta - (uint64_t) minDelta);
+    bool useDelta = !header.hasNulls && count > 1 && (uint64_t) (count - 1) * deltaWidth < (uint64_t) count * width;
+
+    header.sorted = sorted;
+    header.encoding = useDelta ? DELTA : FRAME_OF_REFERENCE;
+    header.width = useDelta ? deltaWidth : width;
+    header.base = useDelta ? minDelta : minValue;
+    header.first = useDelta ? (int64_t) values[0] : 0;
+
+    size_t start = out.size();
+    size_t nullBytes = header.hasNulls ? (count + 7) / 8 : 0;
+    size_t packedCount = useDelta ? count - 1 : count;
+    out.resize(start + sizeof(Header) + nullBytes + (packedCount * header.width + 7) / 8 + PADDING, 0);
+    memcpy(&out[start], &header, sizeof(Header));
+    char* nulls = &out[start + sizeof(Header)];
+    char* bits = nulls + nullBytes;
+
+    for (size_t i = 0; i < packedCount; i++) {
+        uint64_t packed;
+        if (useDelta) {
+            packed = (uint64_t) (int64_t) values[i + 1] - (uint64_t) (int64_t) values[i] - (uint64_t) minDelta;
+        } else if (values[i] == null) {
+            nulls[i / 8] |= (char) (1 << (i % 8));
+            continue;
+        } else {
+            packed = (uint64_t) (int64_t) values[i] - (uint64_t) minValue;
+        }
+        if (packed != 0) { pack(bits, i, header.width, packed); }
+    }
+}
+
+PackedBlock::Header PackedBlock::header(const char* block) {
+    Header header;
+    memcpy(&header, block, sizeof(Header));
+    return header;
+}
+
+template <typename T>
+void PackedBlock::decode(const char* block, T null, T* out) {
+    Header header = PackedBlock::header(block);
+    const char* bits = bitsOf(block, header);
+    int width = header.width;
+    uint64_t mask = maskFor(width);
+
+    if (header.encoding == DELTA) {
+        uint64_t value = header.first;
+        out[0] = (T) (int64_t) value;
+        for (size_t i = 1; i < header.count; i++) {
+            value += (uint64_t) header.base + unpack(bits, i - 1, width, mask);
+            out[i] = (T) (int64_t) value;
+        }
+        return;
+    }
+
+    if (width == 0) {
+        fill_n(out, header.count, (T) header.base);
+    } else {
+        for (size_t i = 0; i < header.count; i++) {
+            out[i] = (T) (int64_t) ((uint64_t) header.base + unpack(bits, i, width, mask));
+        }
+    }
+    if (header.hasNulls) {
+        const char* nulls = nullsOf(block);
+        for (size_t i = 0; i < header.count; i++) {
+            if (isNullAt(nulls, i)) { out[i] = null; }
+        }
+    }
+}
+
+template <typename T>
+T PackedBlock::at(const char* block, size_t index, T null) {
+    Header header = PackedBlock::header(block);
+    const char* bits = bitsOf(block, header);
+    uint64_t mask = maskFor(header.width);
+
+    if (header.encoding == DELTA) {
+        uint64_t value = (uint64_t) header.first + index * (uint64_t) header.base;
+        for (size_t i = 0; i < index && header.width > 0; i++) {
+            value += unpack(bits, i, header.width, mask);
+        }
+        return (T) (int64_t) value;
+    }
+    if (header.hasNulls && isNullAt(nullsOf(block), index)) { return null; }
+    return (T) (int64_t) ((uint64_t) header.base + unpack(bits, index, header.width, mask));
+}
+
+template <typename T>
+void PackedBlock::filter(const char* block, T null, uint32_t firstRow, const Predicate& predicate, Selection& result) {
+    Header header = PackedBlock::header(block);
+    if (header.count == 0) { return; }
+    long long lower, upper;
+    bool bounded = integerBounds(predicate, lower, upper);
+    if (bounded && lower > upper) { return; }
+
+    if (bounded && header.encoding == FRAME_OF_REFERENCE) {
+        // Compare the packed values against the bounds minus the base, nulls are packed as 0 and checked separately
+        if (upper < header.base) { return; }
+        uint64_t mask = maskFor(header.width);
+        uint64_t lowerPacked = lower <= header.base ? 0 : (uint64_t) lower - (uint64_t) header.base;
+        uint64_t upperPacked = min(mask, (uint64_t) upper - (uint64_t) header.base);
+        if (lowerPacked > upperPacked) { return; }
+
+        const char* bits = bitsOf(block, header);
+        const char* nulls = nullsOf(block);
+        if (lowerPacked == 0 && upperPacked == mask && !header.hasNulls) { // Every value is within the bounds
+            result.addRange(firstRow, firstRow + header.count);
+            return;
+        }
+        if (header.sorted) { // The matching values are consecutive
+            auto firstAbove = [&](uint64_t bound) { // First index whose packed value is greater than bound
+                size_t low = 0, high = header.count;
+                while (low < high) {
+                    size_t middle = (low + high) / 2;
+                    if (unpack(bits, middle, header.width, mask) <= bound) { low = middle + 1; }
+                    else { high = middle; }
+                }
+                return low;
+            };
+            size_t start = lowerPacked == 0 ? 0 : firstAbove(lowerPacked - 1);
+            size_t end = firstAbove(upperPacked);
+            if (start < end) { result.addRange(firstRow + start, firstRow + end); }
+            return;
+        }
+        uint64_t span = upperPacked - lowerPacked;
+        for (size_t i = 0; i < header.count; i++) {
+            if (unpack(bits, i, header.width, mask) - lowerPacked <= span && !(header.hasNulls && isNullAt(nulls, i))) {
+                result.add(firstRow + i);
+            }
+        }
+        return;
+    }
+
+    vector<T> values(header.count);
+    decode(block, null, values.data());
+    if (bounded && header.sorted) {
+        size_t start = lower_bound(values.begin(), values.end(), lower, [](T value, long long bound) { return value < bound; }) - values.begin();
+        size_t end = upper_bound(values.begin(), values.end(), upper, [](long long bound, T value) { return bound < value; }) - values.begin();
+        if (start < end) { result.addRange(firstRow + start, firstRow + end); }
+        return;
+    }
+    for (size_t i = 0; i < values.size(); i++) {
+        if (predicate.matchesInteger(values[i], values[i] == null)) { result.add(firstRow + i); }
+    }
+}
+
+template void PackedBlock::encode<int32_t>(const int32_t*, size_t, int32_t, vector<char>&);
+template void PackedBlock::encode<int64_t>(const int64_t*, size_t, int64_t, vector<char>&);
+template void PackedBlock::decode<int32_t>(const char*, int32_t, int32_t*);
+template void PackedBlock::decode<int64_t>(const char*, int64_t, int64_t*);
+template int32_t PackedBlock::at<int32_t>(const char*, size_t, int32_t);
+template int64_t PackedBlock::at<int64_t>(const char*, size_t, int64_t);
+template void PackedBlock::filter<int32_t>(const char*, int32_t, uint32_t, const Predicate&, Selection&);
+template void PackedBlock::filter<int64_t>(const char*, int64_t, uint32_t, const Predicate&, Selection&);
@@ -0,0 +1,64 @@
+// PackedBlock.h
+
+#ifndef PACKEDBLOCK_H
+#define PACKEDBLOCK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Predicate.h"
+#include "Selection.h"
+
+using namespace std;
+
+// Bit-packed encoding of a block of INTEGER (int32_t) or TIME (int64_t) values, one block per zone.
+//
+// A block starts with a Header holding the base and bit width of its values, followed by a bitmap
+// of its nulls (only if it has any) and the packed values, width bits each:
+//   - FRAME_OF_REFERENCE stores value - base, base being the minimum of the block. Nulls are stored as 0.
+//   - DELTA stores the difference to the previous value - base, base being the smallest difference, and
+//     the first value in the header. Used for blocks without nulls whose values grow steadily, such as
+//     timestamps taken every 30 minutes, which need no bits at all.
+// The encoding taking fewer bits is picked per block.
+//
+// Range and equality predicates are evaluated on the packed values of FRAME_OF_REFERENCE blocks: the bounds
+// are shifted by the base once, then compared against the packed values, and blocks whose values never
+// decrease are binary searched instead. DELTA blocks and other predicates are evaluated on the decoded values.
+class PackedBlock {
+    public:
+        enum Encoding : uint8_t {FRAME_OF_REFERENCE = 0, DELTA = 1};
+
+        struct Header {
+            uint8_t encoding;
+            uint8_t width; // bits per packed value, 0 to 64
+            uint8_t hasNulls;
+            uint8_t sorted; // no nulls and the values never decrease
+            uint32_t count; // number of values
+            int64_t base;
+            int64_t first; // first value of a DELTA block
+        };
+
+        // Bytes after the packed values, so that packed values can be read with unaligned 8 byte loads.
+        static const size_t PADDING = 8;
+
+        // Appends the block encoding the count values to out. Values equal to null are nulls.
+        template <typename T>
+        static void encode(const T* values, size_t count, T null, vector<char>& out);
+
+        // The header of the block starting at the pointer.
+        static Header header(const char* block);
+
+        // Decodes the values of the block into out, which has room for header(block).count values.
+        template <typename T>
+        static void decode(const char* block, T null, T* out);
+
+        // The index-th value of the block. Only decodes the values before it for a DELTA block.
+        template <typename T>
+        static T at(const char* block, size_t index, T null);
+
+        // Adds the rows of the block matching the predicate to the result, its first value being the row firstRow.
+        template <typename T>
+        static void filter(const char* block, T null, uint32_t firstRow, const Predicate& predicate, Selection& result);
+};
+
+#endif
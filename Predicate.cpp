@@ -0,0 +1,305 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdio>
+#include <charconv>
+#include <stdexcept>
+#include <cmath>
+#include <climits>
+#include "Predicate.h"
+
+using namespace std;
+
+namespace {
+    // The real truncated to an integer, saturated at the limits of long long, 0 for NaN
+    long long truncated(double value) {
+        if (isnan(value)) { return 0; }
+        if (value >= 9223372036854775808.0) { return LLONG_MAX; }
+        if (value < -9223372036854775808.0) { return LLONG_MIN; }
+        return (long long) value;
+    }
+}
+
+Predicate::Literal::Literal(int value) : Literal((long long) value) {}
+
+Predicate::Literal::Literal(long value) : Literal((long long) value) {}
+
+Predicate::Literal::Literal(long long value) : isText(false), integer(value), real((double) value), text(to_string(value)) {}
+
+Predicate::Literal::Literal(float value) : Literal((double) value) {}
+
+Predicate::Literal::Literal(double value) : isText(false), integer(truncated(value)), real(value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%g", value);
+    text = buffer;
+}
+
+Predicate::Literal::Literal(string value) : isText(true), integer(0), real(0), text(value) {}
+
+Predicate::Literal::Literal(const char* value) : Literal(string(value)) {}
+
+Predicate::Predicate(Kind kind) : kind(kind), hasLower(false), lowerInclusive(false), hasUpper(false), upperInclusive(false) {}
+
+Predicate Predicate::equals(Literal value) {
+    Predicate predicate(EQ);
+    predicate.literals.push_back(value);
+    return predicate;
+}
+
+Predicate Predicate::notEquals(Literal value) {
+    Predicate predicate(NE);
+    predicate.literals.push_back(value);
+    return predicate;
+}
+
+Predicate Predicate::range(Literal lower, bool lowerInclusive, bool hasLower,
+                           Literal upper, bool upperInclusive, bool hasUpper) {
+    Predicate predicate(RANGE);
+    predicate.literals.push_back(lower);
+    predicate.literals.push_back(upper);
+    predicate.hasLower = hasLower;
+    predicate.lowerInclusive = lowerInclusive;
+    predicate.hasUpper = hasUpper;
+    predicate.upperInclusive = upperInclusive;
+    return predicate;
+}
+
+Predicate Predicate::between(Literal lower, Literal upper) {
+    return range(lower, true, true, upper, true, true);
+}
+
+Predicate Predicate::halfOpenRange(Literal lower, Literal upper) {
+    return range(lower, true, true, upper, false, true);
+}
+
+Predicate Predicate::greaterThan(Literal lower) {
+    return range(lower, false, true, lower, false, false);
+}
+
+Predicate Predicate::atLeast(Literal lower) {
+    return range(lower, true, true, lower, false, false);
+}
+
+Predicate Predicate::lessThan(Literal upper) {
+    return range(upper, false, false, upper, false, true);
+}
+
+Predicate Predicate::atMost(Literal upper) {
+    return range(upper, false, false, upper, true, true);
+}
+
+Predicate Predicate::in(vector<Literal> values) {
+    Predicate predicate(IN);
+    predicate.literals = values;
+    return predicate;
+}
+
+Predicate Predicate::isNull() {
+    return Predicate(IS_NULL);
+}
+
+Predicate Predicate::allOf(vector<Predicate> predicates) {
+    Predicate predicate(AND);
+    predicate.children = predicates;
+    return predicate;
+}
+
+Predicate Predicate::anyOf(vector<Predicate> predicates) {
+    Predicate predicate(OR);
+    predicate.children = predicates;
+    return predicate;
+}
+
+Predicate Predicate::negate(Predicate child) {
+    Predicate predicate(NOT);
+    predicate.children.push_back(child);
+    return predicate;
+}
+
+Predicate Predicate::bind(ValueType type) const {
+    Predicate bound = *this;
+    for (Literal& literal : bound.literals) {
+        if (type == TEXT_VALUES) { continue; }
+        if (literal.isText) {
+            const char* first = literal.text.data();
+            const char* last = first + literal.text.size();
+            if (type == INTEGER_VALUES) {
+                long long value;
+                from_chars_result parsed = from_chars(first, last, value);
+                if (parsed.ec != errc() || parsed.ptr != last) {
+                    throw invalid_argument("Cannot compare integer values with \"" + literal.text + "\", it is not an integer.");
+                }
+                literal = Literal(value);
+            } else {
+                // Parsed as a float, the way FLOAT values are stored, so that "23.1" equals the stored 23.1
+                float value;
+                from_chars_result parsed = from_chars(first, last, value);
+                if (parsed.ec != errc() || parsed.ptr != last) {
+                    throw invalid_argument("Cannot compare real values with \"" + literal.text + "\", it is not a number.");
+                }
+                literal = Literal(value);
+            }
+        } else if (type == REAL_VALUES) {
+            literal = Literal((float) literal.real);
+        }
+    }
+    for (Predicate& child : bound.children) {
+        child = child.bind(type);
+    }
+    return type == INTEGER_VALUES ? bound.bindFractions() : bound;
+}
+
+Predicate Predicate::bindFractions() const {
+    // Literals of integers, and reals holding whole numbers, compare as they are
+    auto isInteger = [](const Literal& literal) { return (double) literal.integer == literal.real; };
+    auto nothing = []() { return Predicate(IN); }; // IN without literals never matches
+
+    switch (kind) {
+        case EQ: return isInteger(literals[0]) ? *this : nothing();
+        case NE: return isInteger(literals[0]) ? *this : negate(isNull()); // every value differs from a fraction
+        case IN: {
+            Predicate bound(IN);
+            for (const Literal& literal : literals) {
+                if (isInteger(literal)) { bound.literals.push_back(literal); }
+            }
+            return bound;
+        }
+        case RANGE: {
+            // value >= 2.5 or value > 2.5 holds for value >= 3, value <= 2.5 or value < 2.5 for value <= 2
+            Predicate bound = *this;
+            if (hasLower && !isInteger(literals[0])) {
+                double lower = ceil(literals[0].real);
+                if (isnan(lower) || lower >= 9223372036854775808.0) { return nothing(); }
+                if (lower < -9223372036854775808.0) { bound.hasLower = false; }
+                else { bound.literals[0] = Literal((long long) lower); }
+                bound.lowerInclusive = true;
+            }
+            if (hasUpper && !isInteger(literals[1])) {
+                double upper = floor(literals[1].real);
+                if (isnan(upper) || upper < -9223372036854775808.0) { return nothing(); }
+                if (upper >= 9223372036854775808.0) { bound.hasUpper = false; }
+                else { bound.literals[1] = Literal((long long) upper); }
+                bound.upperInclusive = true;
+            }
+            return bound;
+        }
+        default: return *this;
+    }
+}
+
+template <typename Compare>
+bool Predicate::evaluate(bool isNullValue, const Compare& compare) const {
+    switch (kind) {
+        case IS_NULL: return isNullValue;
+        case AND:
+            for (const Predicate& child : children) {
+                if (!child.evaluate(isNullValue, compare)) { return false; }
+            }
+            return true;
+        case OR:
+            for (const Predicate& child : children) {
+                if (child.evaluate(isNullValue, compare)) { return true; }
+            }
+            return false;
+        case NOT: return !children[0].evaluate(isNullValue, compare);
+        default: break;
+    }
+
+    if (isNullValue) { return false; } // comparisons never match a null value
+
+    switch (kind) {
+        case EQ: return compare(literals[0]) == 0;
+        case NE: return compare(literals[0]) != 0;
+        case IN:
+            for (const Literal& literal : literals) {
+                if (compare(literal) == 0) { return true; }
+            }
+            return false;
+        case RANGE: {
+            if (hasLower) {
+                int result = compare(literals[0]);
+                if (result < 0 || (result == 0 && !lowerInclusive)) { return false; }
+            }
+            if (hasUpper) {
+                int result = compare(literals[1]);
+                if (result > 0 || (result == 0 && !upperInclusive)) { return false; }
+            }
+            return true;
+        }
+        default: return false;
+    }
+}
+
+bool Predicate::matchesInteger(long long value, bool isNullValue) const {
+    return evaluate(isNullValue, [value](const Literal& literal) {
+        return value < literal.integer ? -1 : (value > literal.integer ? 1 : 0);
+    });
+}
+
+bool Predicate::matchesFloat(double value, bool isNullValue) const {
+    return evaluate(isNullValue, [value](const Literal& literal) {
+        return value < literal.real ? -1 : (value > literal.real ? 1 : 0);
+    });
+}
+
+bool Predicate::matchesString(string_view value, bool isNullValue) const {
+    return evaluate(isNullValue, [value](const Literal& literal) {
+        return value.compare(literal.text);
+    });
+}
+
+bool Predicate::mayMatchRange(double min, double max, bool hasNulls, bool hasValues) const {
+    switch (kind) {
+        case IS_NULL: return hasNulls;
+        case AND:
+            for (const Predicate& child : children) {
+                if (!child.mayMatchRange(min, max, hasNulls, hasValues)) { return false; }
+            }
+            return true;
+        case OR:
+            for (const Predicate& child : children) {
+                if (child.mayMatchRange(min, max, hasNulls, hasValues)) { return true; }
+            }
+            return false;
+        case NOT:
+            if (children[0].kind == IS_NULL) { return hasValues; }
+            return true; // cannot tell from min/max alone
+        default: break;
+    }
+
+    if (!hasValues) { return false; } // comparisons never match a null value
+
+    auto inRange = [min, max](const Literal& literal) {
+        return literal.isText || (literal.real >= min && literal.real <= max);
+    };
+    switch (kind) {
+        case EQ: return inRange(literals[0]);
+        case NE: return literals[0].isText || min != max || min != literals[0].real;
+        case IN:
+            for (const Literal& literal : literals) {
+                if (inRange(literal)) { return true; }
+            }
+            return false;
+        case RANGE:
+            if (hasLower && !literals[0].isText) {
+                if (max < literals[0].real || (max == literals[0].real && !lowerInclusive)) { return false; }
+            }
+            if (hasUpper && !literals[1].isText) {
+                if (min > literals[1].real || (min == literals[1].real && !upperInclusive)) { return false; }
+            }
+            return true;
+        default: return true;
+    }
+}
+
+Predicate operator&&(const Predicate& left, const Predicate& right) {
+    return Predicate::allOf({left, right});
+}
+
+Predicate operator||(const Predicate& left, const Predicate& right) {
+    return Predicate::anyOf({left, right});
+}
+
+Predicate operator!(const Predicate& predicate) {
+    return Predicate::negate(predicate);
+}
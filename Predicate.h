@@ -0,0 +1,141 @@
+// Predicate.h
+
+#ifndef PREDICATE_H
+#define PREDICATE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+
+using namespace std;
+
+// A typed predicate over the values of a single column.
+//
+// Predicates are built with the static factory functions below and combined with
+// allOf()/anyOf()/negate() (or the &&, || and ! operators). Column stores evaluate them
+// directly on their storage representation through matchesInteger(), matchesFloat() and
+// matchesString(), so no Object has to be created per scanned value.
+//
+// Comparisons never match a null value, only isNull() does. negate() simply inverts its child.
+class Predicate {
+    public:
+        enum Kind {EQ, NE, RANGE, IN, IS_NULL, AND, OR, NOT};
+
+        // The values of the column a predicate is evaluated on: INTEGER and TIME columns hold integers,
+        // FLOAT columns reals and STRING columns text.
+        enum ValueType {INTEGER_VALUES, REAL_VALUES, TEXT_VALUES};
+
+        // A literal to compare column values against.
+        // INTEGER and TIME columns compare against the integer form (TIME as epoch seconds),
+        // FLOAT columns against the real form and STRING columns against the text form.
+        class Literal {
+            public:
+                bool isText;
+                long long integer;
+                double real;
+                string text;
+
+                Literal(int value);
+                Literal(long value);
+                Literal(long long value);
+                Literal(float value);
+                Literal(double value);
+                Literal(string value);
+                Literal(const char* value);
+        };
+
+        Kind kind;
+
+        // Operands of EQ, NE and IN (for RANGE: lower and upper bound).
+        vector<Literal> literals;
+
+        // Whether the RANGE bounds are included, and whether the bounds are present at all.
+        bool hasLower, lowerInclusive;
+        bool hasUpper, upperInclusive;
+
+        // Operands of AND, OR and NOT.
+        vector<Predicate> children;
+
+        // value == literal
+        static Predicate equals(Literal value);
+
+        // value != literal
+        static Predicate notEquals(Literal value);
+
+        // lower <= value <= upper
+        static Predicate between(Literal lower, Literal upper);
+
+        // lower <= value < upper, useful for time ranges such as a year or a month
+        static Predicate halfOpenRange(Literal lower, Literal upper);
+
+        // value > lower
+        static Predicate greaterThan(Literal lower);
+
+        // value >= lower
+        static Predicate atLeast(Literal lower);
+
+        // value < upper
+        static Predicate lessThan(Literal upper);
+
+        // value <= upper
+        static Predicate atMost(Literal upper);
+
+        // value is one of the literals
+        static Predicate in(vector<Literal> values);
+
+        // value is null ("M" or empty in the CSV)
+        static Predicate isNull();
+
+        // every predicate matches
+        static Predicate allOf(vector<Predicate> predicates);
+
+        // at least one predicate matches
+        static Predicate anyOf(vector<Predicate> predicates);
+
+        // the predicate does not match
+        static Predicate negate(Predicate predicate);
+
+        // A copy of the predicate whose literals all have the form of the values it is evaluated on, so that nothing is
+        // converted per value. Text literals of an INTEGER_VALUES or REAL_VALUES predicate are parsed as numbers here,
+        // throws invalid_argument if one is not a number of the type. Column stores bind predicates before scanning.
+        //
+        // REAL_VALUES literals become the float a FLOAT column would store for them, so that 23.1 equals the stored 23.1.
+        // INTEGER_VALUES literals that are fractions are rounded towards the values they admit: a lower bound up,
+        // an upper bound down, and EQ (or a value of IN) with a fraction matches nothing.
+        Predicate bind(ValueType type) const;
+
+        // Evaluates the predicate, bound to INTEGER_VALUES, on a value of an INTEGER or TIME column.
+        bool matchesInteger(long long value, bool isNullValue) const;
+
+        // Evaluates the predicate, bound to REAL_VALUES, on a value of a FLOAT column.
+        bool matchesFloat(double value, bool isNullValue) const;
+
+        // Evaluates the predicate on a value of a STRING column.
+        bool matchesString(string_view value, bool isNullValue) const;
+
+        // Whether some value in a block whose non-null values lie within [min, max] may match.
+        // Used to skip blocks using their zone map statistics, so it may be true when nothing matches,
+        // but is never false when something does.
+        bool mayMatchRange(double min, double max, bool hasNulls, bool hasValues) const;
+
+    private:
+        Predicate(Kind kind);
+
+        // The predicate, whose children are bound to INTEGER_VALUES already, with its fractional literals rounded, see bind().
+        Predicate bindFractions() const;
+
+        static Predicate range(Literal lower, bool lowerInclusive, bool hasLower,
+                               Literal upper, bool upperInclusive, bool hasUpper);
+
+        // Shared evaluation of the tree, `compare` returns <0, 0 or >0 when comparing
+        // the scanned value against a literal.
+        template <typename Compare>
+        bool evaluate(bool isNullValue, const Compare& compare) const;
+};
+
+Predicate operator&&(const Predicate& left, const Predicate& right);
+Predicate operator||(const Predicate& left, const Predicate& right);
+Predicate operator!(const Predicate& predicate);
+
+#endif
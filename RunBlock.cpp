@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <cstring>
+#include "RunBlock.h"
+#include "StringDictionary.h"
+
+using namespace std;
+
+void RunBlock::encode(const uint32_t* values, size_t count, vector<char>& out) {
+    vector<Run> runs;
+    appendRuns(runs, values, count, 0);
+    uint32_t maxValue = count == 0 ? 0 : *max_element(values, values + count);
+
+    Header header = {};
+    header.count = count;
+    header.width = StringDictionary::widthFor((size_t) maxValue + 1);
+    header.encoding = runs.size() * sizeof(Run) < count * header.width ? RUNS : VALUES;
+    header.runCount = header.encoding == RUNS ? runs.size() : 0;
+
+    size_t start = out.size();
+    out.resize(start + sizeof(Header));
+    memcpy(&out[start], &header, sizeof(Header));
+    if (header.encoding == RUNS) {
+        out.resize(out.size() + runs.size() * sizeof(Run));
+        memcpy(&out[start + sizeof(Header)], runs.data(), runs.size() * sizeof(Run));
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            StringDictionary::appendCode(out, header.width, values[i]);
+        }
+    }
+}
+
+RunBlock::Header RunBlock::header(const char* block) {
+    Header header;
+    memcpy(&header, block, sizeof(Header));
+    return header;
+}
+
+void RunBlock::decode(const char* block, uint32_t* out) {
+    forEachRun(block, [out](uint32_t start, uint32_t end, uint32_t value) {
+        fill(out + start, out + end, value);
+    });
+}
+
+uint32_t RunBlock::at(const char* block, size_t index) {
+    Header header = RunBlock::header(block);
+    if (header.encoding == VALUES) { return readValue(payload(block), header.width, index); }
+
+    // The first run ending after the index
+    size_t low = 0, high = header.runCount - 1;
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+        if (readRun(payload(block), middle).end <= index) { low = middle + 1; }
+        else { high = middle; }
+    }
+    return readRun(payload(block), low).value;
+}
+
+uint32_t RunBlock::readValue(const char* values, int width, size_t index) {
+    return StringDictionary::readCode(values, width, index);
+}
+
+RunBlock::Run RunBlock::readRun(const char* runs, size_t index) {
+    Run run;
+    memcpy(&run, runs + index * sizeof(Run), sizeof(Run));
+    return run;
+}
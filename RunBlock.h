@@ -0,0 +1,106 @@
+// RunBlock.h
+
+#ifndef RUNBLOCK_H
+#define RUNBLOCK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Run-length encoding of small unsigned values, such as the dictionary codes of a STRING column or the
+// year, month or day of a TIME column.
+//
+// Data stored in station and time order holds the same station, and the same date, for many rows in a row.
+// Such rows are kept as a single Run, so a predicate is evaluated once per run and a matching run adds
+// its rows as one range.
+//
+// A block holds the values of one zone. Its Header is followed by either its runs (RUNS) or, when the
+// values change too often for runs to pay off, by the values themselves in the fewest bytes that fit
+// them (VALUES, see StringDictionary::readCode()). The encoding is picked per block.
+class RunBlock {
+    public:
+        enum Encoding : uint8_t {VALUES = 0, RUNS = 1};
+
+        struct Header {
+            uint8_t encoding;
+            uint8_t width; // bytes per value of a VALUES block
+            uint16_t reserved;
+            uint32_t count; // number of values
+            uint32_t runCount; // number of runs of a RUNS block
+        };
+
+        // Consecutive rows holding the same value, ending before the row end.
+        struct Run {
+            uint32_t value;
+            uint32_t end;
+        };
+
+        // Appends the values of the rows [firstRow, firstRow + count) to the runs, extending the last run if it holds the first value.
+        template <typename T>
+        static void appendRuns(vector<Run>& runs, const T* values, size_t count, uint32_t firstRow);
+
+        // Appends the block encoding the count values to out.
+        static void encode(const uint32_t* values, size_t count, vector<char>& out);
+
+        // The header of the block starting at the pointer.
+        static Header header(const char* block);
+
+        // Decodes the values of the block into out, which has room for header(block).count values.
+        static void decode(const char* block, uint32_t* out);
+
+        // The index-th value of the block, found by a binary search over the runs of a RUNS block.
+        static uint32_t at(const char* block, size_t index);
+
+        // Calls process(start, end, value) for the runs [start, end) of the block, in order. Consecutive equal values of
+        // a VALUES block are reported as a single run as well.
+        template <typename Process>
+        static void forEachRun(const char* block, Process process);
+
+    private:
+        // The values of a VALUES block, or the runs of a RUNS block
+        static const char* payload(const char* block) { return block + sizeof(Header); }
+
+        static uint32_t readValue(const char* values, int width, size_t index);
+        static Run readRun(const char* runs, size_t index);
+};
+
+template <typename T>
+void RunBlock::appendRuns(vector<Run>& runs, const T* values, size_t count, uint32_t firstRow) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value = (uint32_t) values[i];
+        if (!runs.empty() && runs.back().value == value && runs.back().end == firstRow + i) {
+            runs.back().end++;
+        } else {
+            runs.push_back(Run{value, (uint32_t) (firstRow + i + 1)});
+        }
+    }
+}
+
+template <typename Process>
+void RunBlock::forEachRun(const char* block, Process process) {
+    Header header = RunBlock::header(block);
+    if (header.encoding == RUNS) {
+        uint32_t start = 0;
+        for (size_t i = 0; i < header.runCount; i++) {
+            Run run = readRun(payload(block), i);
+            process(start, run.end, run.value);
+            start = run.end;
+        }
+        return;
+    }
+    if (header.count == 0) { return; }
+    uint32_t start = 0;
+    uint32_t value = readValue(payload(block), header.width, 0);
+    for (uint32_t i = 1; i <= header.count; i++) {
+        uint32_t next = i < header.count ? readValue(payload(block), header.width, i) : value;
+        if (i == header.count || next != value) {
+            process(start, i, value);
+            start = i;
+            value = next;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include "ColumnStoreAbstract.h"
+#include "PackedBlock.h"
+#include "Segment.h"
+#include "XorBlock.h"
+
+using namespace std;
+
+namespace {
+    // Reads the fields of a footer, checking that they do not run past its end
+    class FooterReader {
+        public:
+            FooterReader(const char* bytes, size_t length) : cursor(bytes), end(bytes + length) {}
+
+            template <typename T>
+            T read() {
+                T value;
+                memcpy(&value, take(sizeof(T)), sizeof(T));
+                return value;
+            }
+
+            string readString() {
+                uint32_t length = read<uint32_t>();
+                return string(take(length), length);
+            }
+
+            vector<RunBlock::Run> readRuns() {
+                uint64_t count = read<uint64_t>();
+                if (count > (uint64_t) (end - cursor) / sizeof(RunBlock::Run)) { throw runtime_error("The footer of the segment file is corrupt."); }
+                vector<RunBlock::Run> runs(count);
+                if (count > 0) { memcpy(runs.data(), take(count * sizeof(RunBlock::Run)), count * sizeof(RunBlock::Run)); }
+                return runs;
+            }
+
+        private:
+            const char* cursor;
+            const char* end;
+
+            const char* take(size_t length) {
+                if (length > (size_t) (end - cursor)) { throw runtime_error("The footer of the segment file is corrupt."); }
+                const char* bytes = cursor;
+                cursor += length;
+                return bytes;
+            }
+    };
+
+    // Whether the block of a zone of a column of the data type holds the rows of the zone: it is in an encoding of the data type,
+    // its header counts rowCount values and the values it announces fit in the block. The decoders trust all of these,
+    // writing header.count values into room for rowCount
+    bool blockMatchesZone(const char* block, const ZoneMap::Zone& stats, int dataType) {
+        switch (stats.encoding) {
+            case Segment::PACKED: {
+                if ((dataType != ColumnStoreAbstract::INTEGER_DATATYPE && dataType != ColumnStoreAbstract::TIME_DATATYPE) || stats.byteLength < sizeof(PackedBlock::Header)) { return false; }
+                PackedBlock::Header header = PackedBlock::header(block);
+                if (header.count != stats.rowCount || header.width > 64 || header.encoding > PackedBlock::DELTA) { return false; }
+                size_t nullBytes = header.hasNulls ? (header.count + 7) / 8 : 0;
+                size_t packedCount = header.encoding == PackedBlock::DELTA ? header.count - 1 : header.count;
+                return sizeof(PackedBlock::Header) + nullBytes + (packedCount * header.width + 7) / 8 + PackedBlock::PADDING <= stats.byteLength;
+            }
+            case Segment::XOR: {
+                if (dataType != ColumnStoreAbstract::FLOAT_DATATYPE || stats.byteLength < sizeof(XorBlock::Header)) { return false; }
+                XorBlock::Header header = XorBlock::header(block);
+                return header.count == stats.rowCount && sizeof(XorBlock::Header) + (size_t) header.byteLength + XorBlock::PADDING <= stats.byteLength;
+            }
+            case Segment::RAW:
+                return dataType == ColumnStoreAbstract::FLOAT_DATATYPE && (size_t) stats.rowCount * sizeof(float) <= stats.byteLength;
+            case Segment::RUNS: {
+                if (dataType != ColumnStoreAbstract::STRING_DATATYPE || stats.byteLength < sizeof(RunBlock::Header)) { return false; }
+                RunBlock::Header header = RunBlock::header(block);
+                size_t payloadLength = stats.byteLength - sizeof(RunBlock::Header);
+                if (header.count != stats.rowCount) { return false; }
+                if (header.encoding == RunBlock::VALUES) {
+                    return (header.width == 1 || header.width == 2 || header.width == 4) && (size_t) header.count * header.width <= payloadLength;
+                }
+                if (header.encoding != RunBlock::RUNS || header.runCount == 0 || (size_t) header.runCount * sizeof(RunBlock::Run) > payloadLength) { return false; }
+                // The runs are decoded into the rows [start, end) of the zone, so they must go forward and end with it
+                uint32_t start = 0;
+                for (uint32_t idx = 0; idx < header.runCount; idx++) {
+                    RunBlock::Run run;
+                    memcpy(&run, block + sizeof(RunBlock::Header) + idx * sizeof(RunBlock::Run), sizeof(run));
+                    if (run.end <= start) { return false; }
+                    start = run.end;
+                }
+                return start == header.count;
+            }
+            default:
+                return false;
+        }
+    }
+
+    template <typename T>
+    void write(ostream& outputStream, T value) {
+        outputStream.write((const char*) &value, sizeof(T));
+    }
+
+    void writeString(ostream& outputStream, const string& value) {
+        write<uint32_t>(outputStream, value.size());
+        outputStream.write(value.data(), value.size());
+    }
+
+    void writeRuns(ostream& outputStream, const vector<RunBlock::Run>& runs) {
+        write<uint64_t>(outputStream, runs.size());
+        outputStream.write((const char*) runs.data(), runs.size() * sizeof(RunBlock::Run));
+    }
+}
+
+Segment Segment::open(const string& filepath) {
+    Segment segment;
+    segment.file = ColumnFile::open(filepath);
+    if (!segment.file) { return segment; }
+
+    // The footer length and MAGIC at the end locate the footer
+    const ColumnFile& file = *segment.file;
+    const size_t trailerLength = sizeof(uint64_t) + sizeof(MAGIC);
+    if (file.size() < sizeof(MAGIC) + trailerLength || file.at<uint32_t>(0) != MAGIC) {
+        throw runtime_error(filepath + " is not a segment file.");
+    }
+    uint64_t footerLength;
+    uint32_t magic;
+    memcpy(&footerLength, file.data() + file.size() - trailerLength, sizeof(footerLength));
+    memcpy(&magic, file.data() + file.size() - sizeof(MAGIC), sizeof(MAGIC));
+    if (magic != MAGIC || footerLength > file.size() - sizeof(MAGIC) - trailerLength) {
+        throw runtime_error(filepath + " is not a segment file.");
+    }
+    segment.footerOffset = file.size() - trailerLength - footerLength;
+
+    FooterReader footer(file.data() + segment.footerOffset, footerLength);
+    if (footer.read<uint32_t>() != VERSION || footer.read<uint32_t>() != ZoneMap::ZONE_ROWS) {
+        throw runtime_error(filepath + " was written in another version of the segment format.");
+    }
+    uint32_t columnCount = footer.read<uint32_t>();
+    for (uint32_t idx = 0; idx < columnCount; idx++) {
+        Column column;
+        column.name = footer.readString();
+        column.dataType = footer.read<int32_t>();
+        uint64_t zoneCount = footer.read<uint64_t>();
+        for (uint64_t zone = 0; zone < zoneCount; zone++) {
+            ZoneMap::Zone stats;
+            stats.min = footer.read<double>();
+            stats.max = footer.read<double>();
+            stats.nullCount = footer.read<uint32_t>();
+            stats.rowCount = footer.read<uint32_t>();
+            stats.byteOffset = footer.read<uint64_t>();
+            stats.byteLength = footer.read<uint32_t>();
+            stats.encoding = footer.read<uint8_t>();
+            // Every zone but the last holds ZONE_ROWS rows, and its block the rows of the zone
+            bool rowsFit = stats.rowCount > 0 && stats.nullCount <= stats.rowCount && (zone + 1 == zoneCount ? stats.rowCount <= ZoneMap::ZONE_ROWS : stats.rowCount == ZoneMap::ZONE_ROWS);
+            if (!rowsFit || stats.byteOffset < sizeof(MAGIC) || stats.byteOffset > segment.footerOffset || stats.byteLength > segment.footerOffset - stats.byteOffset
+                || !blockMatchesZone(file.data() + stats.byteOffset, stats, column.dataType)) {
+                throw runtime_error("The footer of the segment file is corrupt.");
+            }
+            column.zoneMap.addZone(stats);
+        }
+        uint32_t dictionarySize = footer.read<uint32_t>();
+        for (uint32_t code = 0; code < dictionarySize; code++) {
+            column.dictionary.push_back(footer.readString());
+        }
+        column.years = footer.readRuns();
+        column.months = footer.readRuns();
+        column.days = footer.readRuns();
+        segment.columns.push_back(move(column));
+    }
+    return segment;
+}
+
+const Segment::Column* Segment::column(const string& name) const {
+    for (const Column& column : columns) {
+        if (column.name == name) { return &column; }
+    }
+    return nullptr;
+}
+
+Segment::Column* Segment::column(const string& name) {
+    for (Column& column : columns) {
+        if (column.name == name) { return &column; }
+    }
+    return nullptr;
+}
+
+size_t Segment::rowGroupCount() const {
+    size_t count = 0;
+    for (const Column& column : columns) {
+        count = max(count, column.zoneMap.zones.size());
+    }
+    return count;
+}
+
+void Segment::writeFooter(ostream& outputStream) const {
+    // Written out whole once its length is known
+    ostringstream footer;
+    write<uint32_t>(footer, VERSION);
+    write<uint32_t>(footer, ZoneMap::ZONE_ROWS);
+    write<uint32_t>(footer, columns.size());
+    for (const Column& column : columns) {
+        writeString(footer, column.name);
+        write<int32_t>(footer, column.dataType);
+        write<uint64_t>(footer, column.zoneMap.zones.size());
+        for (const ZoneMap::Zone& stats : column.zoneMap.zones) {
+            write(footer, stats.min);
+            write(footer, stats.max);
+            write(footer, stats.nullCount);
+            write(footer, stats.rowCount);
+            write(footer, stats.byteOffset);
+            write(footer, stats.byteLength);
+            write(footer, stats.encoding);
+        }
+        write<uint32_t>(footer, column.dictionary.size());
+        for (const string& value : column.dictionary) {
+            writeString(footer, value);
+        }
+        writeRuns(footer, column.years);
+        writeRuns(footer, column.months);
+        writeRuns(footer, column.days);
+    }
+    string bytes = footer.str();
+    outputStream.write(bytes.data(), bytes.size());
+    write<uint64_t>(outputStream, bytes.size());
+    write<uint32_t>(outputStream, MAGIC);
+}
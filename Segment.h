@@ -0,0 +1,75 @@
+// Segment.h
+
+#ifndef SEGMENT_H
+#define SEGMENT_H
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ColumnFile.h"
+#include "RunBlock.h"
+#include "ZoneMap.h"
+
+using namespace std;
+
+// The single file a disk store keeps all of its columns in.
+//
+// Rows are split into row groups of ZoneMap::ZONE_ROWS rows. A row group holds one chunk for every column
+// with rows in it, in the order of the columns of the footer: the values of those rows encoded as one block,
+// tagged with the Encoding it was written in. The footer after the row groups holds the schema and, for every
+// column, the zone map locating its chunks together with their statistics, the dictionary of a STRING column
+// and the calendar runs of a TIME column. The file ends with the length of the footer and MAGIC:
+//
+//   MAGIC | row group 0 | row group 1 | ... | footer | footer length (8 bytes) | MAGIC
+//
+// Readers map the file once and parse the footer from its end, after which a query only touches the chunks it
+// needs. Appending writes the new chunks and then a new footer after the end of the file, leaving the chunks they
+// replace and the old footer behind until the file is compacted, see ColumnStoreDisk::appendColumns(). The chunks
+// of a row group are then not always next to each other, the footer locates each of them.
+class Segment {
+    public:
+        static const uint32_t MAGIC = 0x31474553; // "SEG1"
+        static const uint32_t VERSION = 1;
+
+        // How the values of a chunk are encoded.
+        enum Encoding : uint8_t {
+            PACKED = 1, // INTEGER or TIME values, see PackedBlock
+            XOR = 2, // FLOAT values, see XorBlock
+            RAW = 3, // FLOAT values stored directly, 4 bytes each
+            RUNS = 4 // dictionary codes of STRING values, see RunBlock
+        };
+
+        struct Column {
+            string name;
+            int dataType;
+            ZoneMap zoneMap; // zone k locates the chunk of the column in row group k
+            vector<string> dictionary; // of a STRING column, see StringDictionary::entries()
+            vector<RunBlock::Run> years, months, days; // of a TIME column with calendar runs, see CalendarColumns
+        };
+
+        vector<Column> columns;
+
+        // The mapped file the footer was read from, nullptr if there is none yet.
+        shared_ptr<const ColumnFile> file;
+
+        // Where the row groups end and the footer starts. The end of the file while chunks appended to it have no footer yet.
+        uint64_t footerOffset = sizeof(MAGIC);
+
+        // Maps the segment file at the path and reads its footer, a segment without columns if there is no file.
+        // Throws a runtime_error if the file is not a segment file, or if a zone of its footer does not match the block it locates.
+        static Segment open(const string& filepath);
+
+        // The column with the name, nullptr if there is none.
+        const Column* column(const string& name) const;
+        Column* column(const string& name);
+
+        // Number of row groups, those of the column with the most rows.
+        size_t rowGroupCount() const;
+
+        // Writes the footer and the end of the file to the stream, which is at the end of the row groups.
+        void writeFooter(ostream& outputStream) const;
+};
+
+#endif
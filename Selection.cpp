@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <iterator>
+#include "Selection.h"
+
+using namespace std;
+
+Selection::Selection() {}
+
+Selection Selection::range(uint32_t start, uint32_t end) {
+    Selection selection;
+    selection.addRange(start, end);
+    return selection;
+}
+
+Selection Selection::of(const vector<int>& rows) {
+    vector<int> sorted(rows);
+    sort(sorted.begin(), sorted.end());
+    Selection selection;
+    for (int row : sorted) {
+        selection.add((uint32_t) row);
+    }
+    return selection;
+}
+
+void Selection::add(uint32_t row) {
+    containerFor(row >> 16).add(row & 0xFFFF);
+}
+
+void Selection::addRange(uint32_t start, uint32_t end) {
+    while (start < end) {
+        uint16_t key = start >> 16;
+        uint32_t chunkEnd = min(end, ((uint32_t) key + 1) << 16);
+        if (chunkEnd == 0) { chunkEnd = end; } // the last chunk of the 32-bit range
+        uint32_t low = start & 0xFFFF;
+        uint32_t high = low + (chunkEnd - start); // exclusive
+        Container& container = containerFor(key);
+        if (!container.isBitmap() && container.count + (high - low) <= ARRAY_MAX) {
+            for (uint32_t bit = low; bit < high; bit++) { container.add(bit); }
+        } else {
+            container.toBitmap();
+            for (uint32_t bit = low; bit < high; bit++) {
+                container.bitmap[bit >> 6] |= 1ULL << (bit & 63);
+            }
+            container.count = 0;
+            for (uint64_t word : container.bitmap) { container.count += __builtin_popcountll(word); }
+        }
+        start = chunkEnd;
+    }
+}
+
+bool Selection::contains(uint32_t row) const {
+    const Container* container = findContainer(row >> 16);
+    return container != nullptr && container->contains(row & 0xFFFF);
+}
+
+size_t Selection::cardinality() const {
+    size_t total = 0;
+    for (const Container& container : containers) { total += container.count; }
+    return total;
+}
+
+bool Selection::empty() const {
+    return containers.empty();
+}
+
+uint32_t Selection::upperBound() const {
+    if (containers.empty()) { return 0; }
+    const Container& last = containers.back();
+    uint32_t high = (uint32_t) last.key << 16;
+    if (!last.isBitmap()) { return high + last.array.back() + 1; }
+    for (size_t word = last.bitmap.size(); word-- > 0;) {
+        if (last.bitmap[word] != 0) {
+            return high + (uint32_t) (word * 64 + 63 - __builtin_clzll(last.bitmap[word])) + 1;
+        }
+    }
+    return high;
+}
+
+Selection Selection::operator&(const Selection& other) const {
+    Selection result;
+    size_t i = 0, j = 0;
+    while (i < containers.size() && j < other.containers.size()) {
+        if (containers[i].key < other.containers[j].key) { i++; }
+        else if (containers[i].key > other.containers[j].key) { j++; }
+        else {
+            Container container = intersect(containers[i++], other.containers[j++]);
+            if (container.count > 0) { result.containers.push_back(move(container)); }
+        }
+    }
+    return result;
+}
+
+Selection Selection::operator|(const Selection& other) const {
+    Selection result;
+    size_t i = 0, j = 0;
+    while (i < containers.size() || j < other.containers.size()) {
+        if (j == other.containers.size() || (i < containers.size() && containers[i].key < other.containers[j].key)) {
+            result.containers.push_back(containers[i++]);
+        } else if (i == containers.size() || other.containers[j].key < containers[i].key) {
+            result.containers.push_back(other.containers[j++]);
+        } else {
+            result.containers.push_back(unite(containers[i++], other.containers[j++]));
+        }
+    }
+    return result;
+}
+
+Selection Selection::slice(uint32_t start, uint32_t end) const {
+    Selection result;
+    if (start >= end) { return result; }
+    uint16_t firstKey = start >> 16;
+    uint16_t lastKey = (end - 1) >> 16;
+    auto container = lower_bound(containers.begin(), containers.end(), firstKey,
+                                 [](const Container& c, uint16_t key) { return c.key < key; });
+    for (; container != containers.end() && container->key <= lastKey; ++container) {
+        result.containers.push_back(*container);
+    }
+    if ((start & 0xFFFF) != 0 || (end & 0xFFFF) != 0) { return result & range(start, end); } // partial chunks at the ends
+    return result;
+}
+
+void Selection::append(Selection&& other) {
+    for (Container& container : other.containers) {
+        if (!containers.empty() && containers.back().key == container.key) {
+            containers.back() = unite(containers.back(), container);
+        } else {
+            containers.push_back(move(container));
+        }
+    }
+    other.containers.clear();
+}
+
+bool Selection::operator==(const Selection& other) const {
+    if (cardinality() != other.cardinality()) { return false; }
+    Iterator left = begin(), right = other.begin();
+    for (; left != end(); ++left, ++right) {
+        if (*left != *right) { return false; }
+    }
+    return true;
+}
+
+vector<int> Selection::toVector() const {
+    vector<int> rows;
+    rows.reserve(cardinality());
+    forEach([&rows](uint32_t row) { rows.push_back((int) row); });
+    return rows;
+}
+
+Selection::Iterator Selection::begin() const {
+    return Iterator(this, 0);
+}
+
+Selection::Iterator Selection::end() const {
+    return Iterator(this, containers.size());
+}
+
+Selection::Iterator::Iterator(const Selection* selection, size_t containerIndex)
+    : selection(selection), containerIndex(containerIndex), position(0), current(0) {
+    settle();
+}
+
+Selection::Iterator& Selection::Iterator::operator++() {
+    position++;
+    settle();
+    return *this;
+}
+
+void Selection::Iterator::settle() {
+    const vector<Container>& containers = selection->containers;
+    while (containerIndex < containers.size()) {
+        const Container& container = containers[containerIndex];
+        uint32_t high = (uint32_t) container.key << 16;
+        if (!container.isBitmap()) {
+            if (position < container.array.size()) {
+                current = high | container.array[position];
+                return;
+            }
+        } else {
+            for (size_t word = position >> 6; word < container.bitmap.size(); word++) {
+                uint64_t bits = container.bitmap[word];
+                if (word == (position >> 6)) { bits &= ~0ULL << (position & 63); }
+                if (bits != 0) {
+                    position = word * 64 + __builtin_ctzll(bits);
+                    current = high | (uint32_t) position;
+                    return;
+                }
+            }
+        }
+        containerIndex++;
+        position = 0;
+    }
+}
+
+bool Selection::Container::contains(uint16_t low) const {
+    if (isBitmap()) { return (bitmap[low >> 6] >> (low & 63)) & 1; }
+    return binary_search(array.begin(), array.end(), low);
+}
+
+void Selection::Container::add(uint16_t low) {
+    if (isBitmap()) {
+        uint64_t& word = bitmap[low >> 6];
+        uint64_t bit = 1ULL << (low & 63);
+        if ((word & bit) == 0) {
+            word |= bit;
+            count++;
+        }
+        return;
+    }
+
+    if (array.empty() || array.back() < low) {
+        array.push_back(low);
+    } else {
+        auto position = lower_bound(array.begin(), array.end(), low);
+        if (*position == low) { return; }
+        array.insert(position, low);
+    }
+    count++;
+    if (count > ARRAY_MAX) { toBitmap(); }
+}
+
+void Selection::Container::toBitmap() {
+    if (isBitmap()) { return; }
+    bitmap.assign(CHUNK_SIZE / 64, 0);
+    for (uint16_t low : array) {
+        bitmap[low >> 6] |= 1ULL << (low & 63);
+    }
+    array.clear();
+    array.shrink_to_fit();
+}
+
+void Selection::Container::toArrayIfSparse() {
+    if (!isBitmap() || count > ARRAY_MAX) { return; }
+    array.reserve(count);
+    for (size_t word = 0; word < bitmap.size(); word++) {
+        uint64_t bits = bitmap[word];
+        while (bits != 0) {
+            array.push_back((uint16_t) (word * 64 + __builtin_ctzll(bits)));
+            bits &= bits - 1;
+        }
+    }
+    bitmap.clear();
+    bitmap.shrink_to_fit();
+}
+
+Selection::Container& Selection::containerFor(uint16_t key) {
+    if (containers.empty() || containers.back().key < key) {
+        containers.push_back(Container{key, 0, {}, {}});
+        return containers.back();
+    }
+    if (containers.back().key == key) { return containers.back(); }
+
+    auto position = lower_bound(containers.begin(), containers.end(), key,
+                                [](const Container& container, uint16_t key) { return container.key < key; });
+    if (position == containers.end() || position->key != key) {
+        position = containers.insert(position, Container{key, 0, {}, {}});
+    }
+    return *position;
+}
+
+const Selection::Container* Selection::findContainer(uint16_t key) const {
+    auto position = lower_bound(containers.begin(), containers.end(), key,
+                                [](const Container& container, uint16_t key) { return container.key < key; });
+    if (position == containers.end() || position->key != key) { return nullptr; }
+    return &*position;
+}
+
+Selection::Container Selection::intersect(const Container& left, const Container& right) {
+    Container result{left.key, 0, {}, {}};
+    if (left.isBitmap() && right.isBitmap()) {
+        result.bitmap.resize(left.bitmap.size());
+        for (size_t word = 0; word < left.bitmap.size(); word++) {
+            result.bitmap[word] = left.bitmap[word] & right.bitmap[word];
+            result.count += __builtin_popcountll(result.bitmap[word]);
+        }
+        result.toArrayIfSparse();
+    } else if (left.isBitmap() || right.isBitmap()) {
+        const Container& array = left.isBitmap() ? right : left;
+        const Container& bitmap = left.isBitmap() ? left : right;
+        for (uint16_t low : array.array) {
+            if (bitmap.contains(low)) { result.array.push_back(low); }
+        }
+        result.count = result.array.size();
+    } else {
+        set_intersection(left.array.begin(), left.array.end(), right.array.begin(), right.array.end(),
+                         back_inserter(result.array));
+        result.count = result.array.size();
+    }
+    return result;
+}
+
+Selection::Container Selection::unite(const Container& left, const Container& right) {
+    Container result{left.key, 0, {}, {}};
+    if (!left.isBitmap() && !right.isBitmap()) {
+        set_union(left.array.begin(), left.array.end(), right.array.begin(), right.array.end(),
+                  back_inserter(result.array));
+        result.count = result.array.size();
+        if (result.count > ARRAY_MAX) { result.toBitmap(); }
+        return result;
+    }
+
+    result.bitmap.assign(CHUNK_SIZE / 64, 0);
+    for (const Container* container : {&left, &right}) {
+        if (container->isBitmap()) {
+            for (size_t word = 0; word < result.bitmap.size(); word++) { result.bitmap[word] |= container->bitmap[word]; }
+        } else {
+            for (uint16_t low : container->array) { result.bitmap[low >> 6] |= 1ULL << (low & 63); }
+        }
+    }
+    for (uint64_t word : result.bitmap) { result.count += __builtin_popcountll(word); }
+    return result;
+}
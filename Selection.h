@@ -0,0 +1,172 @@
+// Selection.h
+
+#ifndef SELECTION_H
+#define SELECTION_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+// A compressed set of row indexes, passed between the filter and aggregate stages of a query.
+//
+// Rows are grouped into chunks of 2^16 by their upper 16 bits (roaring-style). A chunk holding
+// few rows stores the lower 16 bits in a sorted array, a chunk holding more than ARRAY_MAX rows
+// is stored as a 2^16-bit bitmap. Iteration is always in increasing row order.
+class Selection {
+    public:
+        static const uint32_t CHUNK_SIZE = 1 << 16;
+
+        // A chunk holding more rows than this is stored as a bitmap.
+        static const size_t ARRAY_MAX = 4096;
+
+        // An empty selection.
+        Selection();
+
+        // Selects the rows [start, end).
+        static Selection range(uint32_t start, uint32_t end);
+
+        // Selects the given rows, which do not need to be sorted.
+        static Selection of(const vector<int>& rows);
+
+        // Adds a row. Appending rows in increasing order is the fast path.
+        void add(uint32_t row);
+
+        // Adds the rows [start, end).
+        void addRange(uint32_t start, uint32_t end);
+
+        // Whether the row is selected.
+        bool contains(uint32_t row) const;
+
+        // Number of rows selected.
+        size_t cardinality() const;
+
+        bool empty() const;
+
+        // Largest row selected plus one, 0 if empty.
+        uint32_t upperBound() const;
+
+        // Rows selected in both.
+        Selection operator&(const Selection& other) const;
+
+        // Rows selected in either.
+        Selection operator|(const Selection& other) const;
+
+        // The selected rows in [start, end).
+        Selection slice(uint32_t start, uint32_t end) const;
+
+        // Adds the rows of other, which must all be larger than the rows selected so far.
+        // Whole chunks of other are moved over instead of being added row by row.
+        void append(Selection&& other);
+
+        bool operator==(const Selection& other) const;
+
+        // The selected rows as a sorted vector.
+        vector<int> toVector() const;
+
+        // Calls visit(row) for every selected row, in increasing order.
+        template <typename Visit>
+        void forEach(Visit visit) const {
+            for (const Container& container : containers) {
+                uint32_t high = (uint32_t) container.key << 16;
+                if (container.isBitmap()) {
+                    for (size_t word = 0; word < container.bitmap.size(); word++) {
+                        uint64_t bits = container.bitmap[word];
+                        while (bits != 0) {
+                            visit(high | (uint32_t) (word * 64 + __builtin_ctzll(bits)));
+                            bits &= bits - 1;
+                        }
+                    }
+                } else {
+                    for (uint16_t low : container.array) { visit(high | low); }
+                }
+            }
+        }
+
+        // Calls visit(start, end) for every maximal run [start, end) of consecutive selected rows, in increasing order.
+        template <typename Visit>
+        void forEachRun(Visit visit) const {
+            bool open = false;
+            uint32_t runStart = 0, runEnd = 0;
+            auto extend = [&](uint32_t start, uint32_t end) {
+                if (open && start == runEnd) {
+                    runEnd = end;
+                    return;
+                }
+                if (open) { visit(runStart, runEnd); }
+                open = true;
+                runStart = start;
+                runEnd = end;
+            };
+
+            for (const Container& container : containers) {
+                uint32_t high = (uint32_t) container.key << 16;
+                if (container.isBitmap()) {
+                    for (size_t word = 0; word < container.bitmap.size(); word++) {
+                        uint64_t bits = container.bitmap[word];
+                        while (bits != 0) {
+                            uint32_t first = __builtin_ctzll(bits);
+                            uint64_t shifted = bits >> first;
+                            uint32_t length = ~shifted == 0 ? 64 - first : __builtin_ctzll(~shifted);
+                            uint32_t start = high + (uint32_t) word * 64 + first;
+                            extend(start, start + length);
+                            bits = first + length >= 64 ? 0 : bits & (~0ULL << (first + length));
+                        }
+                    }
+                } else {
+                    for (uint16_t low : container.array) { extend(high | low, (high | low) + 1); }
+                }
+            }
+            if (open) { visit(runStart, runEnd); }
+        }
+
+        // Forward iterator over the selected rows, in increasing order.
+        class Iterator {
+            public:
+                Iterator(const Selection* selection, size_t containerIndex);
+                uint32_t operator*() const { return current; }
+                Iterator& operator++();
+                bool operator!=(const Iterator& other) const {
+                    return containerIndex != other.containerIndex || position != other.position;
+                }
+
+            private:
+                const Selection* selection;
+                size_t containerIndex;
+                size_t position; // index into the array, or bit number in the bitmap
+                uint32_t current;
+
+                // Moves to the first row at or after the current position, across containers.
+                void settle();
+        };
+
+        Iterator begin() const;
+        Iterator end() const;
+
+    private:
+        struct Container {
+            uint16_t key; // upper 16 bits of the rows in this chunk
+            uint32_t count; // number of rows in this chunk
+            vector<uint16_t> array; // sorted lower 16 bits, used while count <= ARRAY_MAX
+            vector<uint64_t> bitmap; // CHUNK_SIZE bits, used once count > ARRAY_MAX
+
+            bool isBitmap() const { return !bitmap.empty(); }
+            bool contains(uint16_t low) const;
+            void add(uint16_t low);
+            void toBitmap();
+            void toArrayIfSparse();
+        };
+
+        // Sorted by key.
+        vector<Container> containers;
+
+        // The container for the key, created if missing.
+        Container& containerFor(uint16_t key);
+        const Container* findContainer(uint16_t key) const;
+
+        static Container intersect(const Container& left, const Container& right);
+        static Container unite(const Container& left, const Container& right);
+};
+
+#endif
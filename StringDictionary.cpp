@@ -0,0 +1,75 @@
+#include <cstring>
+#include "StringDictionary.h"
+
+using namespace std;
+
+StringDictionary::StringDictionary() : values({"M"}) {}
+
+StringDictionary::StringDictionary(const vector<string>& entries) : StringDictionary() {
+    for (const string& value : entries) {
+        codes[value] = values.size();
+        values.push_back(value);
+    }
+}
+
+uint32_t StringDictionary::encode(string_view value) {
+    if (value == "" || value == "M") { return NULL_CODE; }
+    auto [it, added] = codes.emplace(string(value), values.size());
+    if (added) { values.push_back(it->first); }
+    return it->second;
+}
+
+int StringDictionary::widthFor(size_t codeCount) {
+    if (codeCount <= (1u << 8)) { return 1; }
+    if (codeCount <= (1u << 16)) { return 2; }
+    return 4;
+}
+
+vector<bool> StringDictionary::matchingCodes(const Predicate& predicate) const {
+    vector<bool> matches(values.size());
+    for (size_t code = 0; code < values.size(); code++) {
+        matches[code] = predicate.matchesString(values[code], code == NULL_CODE);
+    }
+    return matches;
+}
+
+uint32_t StringDictionary::readCode(const char* codes, int width, size_t index) {
+    switch (width) {
+        case 1: return (unsigned char) codes[index];
+        case 2: {
+            uint16_t code;
+            memcpy(&code, codes + index * 2, 2);
+            return code;
+        }
+        default: {
+            uint32_t code;
+            memcpy(&code, codes + index * 4, 4);
+            return code;
+        }
+    }
+}
+
+void StringDictionary::appendCode(vector<char>& codes, int width, uint32_t code) {
+    size_t end = codes.size();
+    codes.resize(end + width);
+    memcpy(codes.data() + end, &code, width); // little endian, the low bytes hold the code
+}
+
+vector<char> StringDictionary::widenCodes(const char* codes, size_t count, int fromWidth, int toWidth) {
+    vector<char> widened;
+    widened.reserve(count * toWidth);
+    for (size_t i = 0; i < count; i++) {
+        appendCode(widened, toWidth, readCode(codes, fromWidth, i));
+    }
+    return widened;
+}
+
+void DictionaryColumn::push_back(string_view value) {
+    uint32_t code = dictionary.encode(value);
+    if (dictionary.codeWidth() != width) {
+        codes = StringDictionary::widenCodes(codes.data(), count, width, dictionary.codeWidth());
+        width = dictionary.codeWidth();
+    }
+    StringDictionary::appendCode(codes, width, code);
+    count++;
+}
@@ -0,0 +1,91 @@
+// StringDictionary.h
+
+#ifndef STRINGDICTIONARY_H
+#define STRINGDICTIONARY_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Predicate.h"
+
+using namespace std;
+
+// Dictionary encoding of a STRING column.
+//
+// Every distinct value gets an integer code in the order it is first seen, code 0 being null ("M" or
+// empty). Codes take codeWidth() bytes each: 1 while there are at most 256 codes, then 2, then 4, so
+// a column of a handful of stations costs one byte per row whatever the stations are called.
+// Predicates are evaluated once per dictionary entry (matchingCodes()) instead of once per row.
+class StringDictionary {
+    public:
+        static const uint32_t NULL_CODE = 0;
+
+        // A dictionary holding only the null code.
+        StringDictionary();
+
+        // A dictionary of the entries, which get the codes 1, 2, ... in order (see entries()).
+        explicit StringDictionary(const vector<string>& entries);
+
+        // The values of the codes after the null code, in code order.
+        vector<string> entries() const { return vector<string>(values.begin() + 1, values.end()); }
+
+        // The code of the value, which is added to the dictionary if it is new.
+        uint32_t encode(string_view value);
+
+        // The value of the code, "M" for null.
+        const string& decode(uint32_t code) const { return values[code]; }
+
+        // Number of codes, including the null code.
+        size_t size() const { return values.size(); }
+
+        // Number of bytes each code takes up.
+        int codeWidth() const { return widthFor(values.size()); }
+
+        // Number of bytes needed for codes of a dictionary of codeCount codes.
+        static int widthFor(size_t codeCount);
+
+        // Whether the value of each code matches the predicate, indexed by code.
+        vector<bool> matchingCodes(const Predicate& predicate) const;
+
+        // The index-th code of an array of codes of the given width.
+        static uint32_t readCode(const char* codes, int width, size_t index);
+
+        // Appends a code of the given width to the array of codes.
+        static void appendCode(vector<char>& codes, int width, uint32_t code);
+
+        // Re-encodes count codes of fromWidth bytes into codes of toWidth bytes.
+        static vector<char> widenCodes(const char* codes, size_t count, int fromWidth, int toWidth);
+
+    private:
+        vector<string> values;
+        unordered_map<string, uint32_t> codes;
+};
+
+// A dictionary encoded STRING column held in memory.
+// The codes are packed into codeWidth() bytes each and widened when the dictionary outgrows them.
+class DictionaryColumn {
+    public:
+        // Appends a value to the column.
+        void push_back(string_view value);
+
+        // The code of the value at the given row.
+        uint32_t codeAt(size_t index) const { return StringDictionary::readCode(codes.data(), width, index); }
+
+        // The value at the given row, "M" for null.
+        const string& at(size_t index) const { return dictionary.decode(codeAt(index)); }
+
+        // Number of rows stored.
+        size_t size() const { return count; }
+
+        const StringDictionary& getDictionary() const { return dictionary; }
+
+    private:
+        StringDictionary dictionary;
+        vector<char> codes;
+        int width = 1;
+        size_t count = 0;
+};
+
+#endif
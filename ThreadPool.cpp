@@ -0,0 +1,166 @@
+#include <algorithm>
+#include "ThreadPool.h"
+
+using namespace std;
+
+namespace {
+    // The pool and queue of the worker running on this thread, nullptr outside of any pool
+    thread_local ThreadPool* currentPool = nullptr;
+    thread_local size_t currentQueue = 0;
+
+    atomic<size_t> sharedWorkerCount{0};
+}
+
+ThreadPool::ThreadPool(size_t workerCount) {
+    workerCount = max<size_t>(workerCount, 1);
+    for (size_t i = 0; i < workerCount; i++) {
+        queues.push_back(make_unique<Queue>());
+    }
+    for (size_t i = 0; i < workerCount; i++) {
+        workers.push_back(thread([this, i]() { workerLoop(i); }));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool(sharedWorkerCount > 0 ? sharedWorkerCount.load() : thread::hardware_concurrency());
+    return pool;
+}
+
+void ThreadPool::setSharedWorkerCount(size_t workerCount) {
+    sharedWorkerCount = workerCount;
+}
+
+void ThreadPool::submit(function<void()> task) {
+    // A worker keeps the tasks it creates, others are spread over the queues
+    size_t index = currentPool == this ? currentQueue : nextQueue++ % queues.size();
+    pendingTasks++; // counted first, so that a worker taking the task never sees the count drop below zero
+    {
+        lock_guard<mutex> lock(queues[index]->queueMutex);
+        queues[index]->tasks.push_back(move(task));
+    }
+    {
+        lock_guard<mutex> lock(sleepMutex); // a worker cannot be between checking the count and sleeping
+    }
+    wakeUp.notify_one();
+}
+
+bool ThreadPool::runPendingTask() {
+    function<void()> task;
+    if (!takeTask(currentPool == this ? currentQueue : queues.size(), task)) { return false; }
+    [&task]() noexcept { task(); }(); // see submit(), tasks must not throw
+    return true;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentQueue = index;
+    while (true) {
+        if (runPendingTask()) { continue; }
+
+        unique_lock<mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this]() { return stopping || pendingTasks > 0; });
+        if (stopping && pendingTasks == 0) { return; }
+    }
+}
+
+bool ThreadPool::takeTask(size_t index, function<void()>& task) {
+    if (index < queues.size()) { // the most recent task of its own queue, whose data is likely still in cache
+        Queue& queue = *queues[index];
+        lock_guard<mutex> lock(queue.queueMutex);
+        if (!queue.tasks.empty()) {
+            task = move(queue.tasks.back());
+            queue.tasks.pop_back();
+            pendingTasks--;
+            return true;
+        }
+    }
+    for (size_t i = 1; i <= queues.size(); i++) { // steal the oldest task of another queue
+        size_t victim = (index + i) % queues.size();
+        if (victim == index) { continue; }
+        Queue& queue = *queues[victim];
+        lock_guard<mutex> lock(queue.queueMutex);
+        if (!queue.tasks.empty()) {
+            task = move(queue.tasks.front());
+            queue.tasks.pop_front();
+            pendingTasks--;
+            return true;
+        }
+    }
+    return false;
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool) : pool(pool) {}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+        // the exception was not waited for, the tasks are finished all the same
+    }
+}
+
+void TaskGroup::run(function<void()> task) {
+    {
+        lock_guard<mutex> lock(state->groupMutex);
+        state->tasks.push_back(move(task));
+        state->remaining++;
+    }
+    state->changed.notify_all(); // a waiting thread can run it
+
+    // The pool gets a turn to run a task of the group, which finds nothing to do if the waiting thread ran them all
+    pool.submit([state = state]() { runNextTask(*state); });
+}
+
+bool TaskGroup::runNextTask(State& state) {
+    function<void()> task;
+    {
+        lock_guard<mutex> lock(state.groupMutex);
+        if (state.tasks.empty()) { return false; }
+        task = move(state.tasks.front());
+        state.tasks.pop_front();
+    }
+
+    exception_ptr thrown;
+    try {
+        task();
+    } catch (...) {
+        thrown = current_exception();
+    }
+    {
+        lock_guard<mutex> lock(state.groupMutex);
+        if (thrown && !state.error) { state.error = thrown; }
+        if (--state.remaining > 0) { return true; }
+    }
+    state.changed.notify_all();
+    return true;
+}
+
+void TaskGroup::wait() {
+    unique_lock<mutex> lock(state->groupMutex);
+    while (state->remaining > 0) {
+        if (state->tasks.empty()) { // every task has started, and may still add some to the group
+            state->changed.wait(lock, [this]() { return state->remaining == 0 || !state->tasks.empty(); });
+            continue;
+        }
+        lock.unlock();
+        runNextTask(*state); // help instead of blocking
+        lock.lock();
+    }
+
+    if (state->error) {
+        exception_ptr thrown = state->error;
+        state->error = nullptr;
+        rethrow_exception(thrown);
+    }
+}
@@ -0,0 +1,119 @@
+// ThreadPool.h
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// A pool of worker threads that run submitted tasks, shared by every store and operator of the process.
+//
+// Every worker has its own queue. Tasks submitted from a worker go to the back of its own queue and
+// it takes them back from there, so nested work stays on the core that produced it. Tasks submitted
+// from other threads are spread over the queues. An idle worker steals from the front of the other
+// queues, so unbalanced work still keeps every worker busy.
+//
+// Tasks are usually run through a TaskGroup, which waits for all of its tasks.
+class ThreadPool {
+    public:
+        // Starts workerCount workers (at least one).
+        explicit ThreadPool(size_t workerCount);
+
+        // Runs the tasks still queued, then stops the workers.
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // The process-wide pool, started on first use.
+        static ThreadPool& shared();
+
+        // Number of workers of the process-wide pool, one per hardware thread by default.
+        // Only has an effect before the first call to shared().
+        static void setSharedWorkerCount(size_t workerCount);
+
+        size_t workerCount() const { return workers.size(); }
+
+        // Queues the task to be run by a worker.
+        // The task must not throw: nothing waits for it, so an exception escaping it terminates the process,
+        // as one escaping a thread does. Run the task through a TaskGroup to get its exception back.
+        void submit(function<void()> task);
+
+        // Runs one queued task on the calling thread, false if there was none.
+        // Lets a thread outside the pool help with the queued tasks.
+        bool runPendingTask();
+
+    private:
+        struct Queue {
+            mutex queueMutex;
+            deque<function<void()>> tasks;
+        };
+
+        vector<unique_ptr<Queue>> queues;
+        vector<thread> workers;
+
+        // Number of queued tasks, and the workers sleeping until there are some
+        atomic<size_t> pendingTasks{0};
+        mutex sleepMutex;
+        condition_variable wakeUp;
+        bool stopping = false;
+
+        // Where the next task from outside the pool is queued
+        atomic<size_t> nextQueue{0};
+
+        void workerLoop(size_t index);
+
+        // Takes a task from the back of the queue at index, or else from the front of another queue
+        bool takeTask(size_t index, function<void()>& task);
+};
+
+// A set of tasks run on a ThreadPool that can be waited for together.
+//
+// wait() returns when every task of the group has finished. The waiting thread runs the tasks of the group
+// no worker has started yet, and only those, so a wait nested in a task is never stuck behind unrelated work
+// and nested waits go no deeper than the groups do. Once every task has started, it sleeps until they finish.
+// If a task throws, the first exception is rethrown by wait().
+class TaskGroup {
+    public:
+        explicit TaskGroup(ThreadPool& pool = ThreadPool::shared());
+
+        // Waits for the tasks still running, without rethrowing their exceptions.
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        // Queues a task of the group.
+        void run(function<void()> task);
+
+        // Waits until every task of the group has finished.
+        void wait();
+
+    private:
+        // The state of a group, shared with the turns it queued on the pool, which may outlive the group
+        struct State {
+            mutex groupMutex;
+            condition_variable changed; // a task finished or was added
+            deque<function<void()>> tasks; // not started yet
+            size_t remaining = 0;
+            exception_ptr error;
+        };
+
+        ThreadPool& pool;
+        shared_ptr<State> state = make_shared<State>();
+
+        // Runs the oldest task of the group that has not started yet, false if there is none
+        static bool runNextTask(State& state);
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include <cctype>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include "TimeFormat.h"
+
+using namespace std;
+
+namespace {
+    // Whether the 8 bytes are ASCII digits wherever digitMask has 0xFF bytes, and equal to separators elsewhere.
+    // All 8 bytes are checked at once: a digit is a byte 0x30..0x3F that stays below 0x40 when 6 is added.
+    bool matchesLayout(const char* bytes, uint64_t digitMask, uint64_t separators) {
+        const uint64_t highNibbles = 0xF0F0F0F0F0F0F0F0ULL;
+        const uint64_t zeros = 0x3030303030303030ULL;
+        const uint64_t sixes = 0x0606060606060606ULL;
+        uint64_t word;
+        memcpy(&word, bytes, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        word = __builtin_bswap64(word); // the masks list the first byte in the lowest bits
+#endif
+        // The separators are checked first, so that no byte of the sum below carries into the next one
+        return (word & ~digitMask) == separators
+            && (word & highNibbles & digitMask) == (zeros & digitMask)
+            && ((word + sixes) & highNibbles & digitMask) == (zeros & digitMask);
+    }
+
+    int digitsAt(string_view value, size_t position, size_t count) {
+        int number = 0;
+        for (size_t i = position; i < position + count; i++) {
+            number = number * 10 + (value[i] - '0');
+        }
+        return number;
+    }
+
+    bool isLeapYear(int year) {
+        return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    }
+
+    int daysInMonth(int year, int month) {
+        static const int DAYS[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        return month == 2 && isLeapYear(year) ? 29 : DAYS[month - 1];
+    }
+
+    bool epochOf(int year, int month, int day, int hour, int minute, int second, int64_t& epoch) {
+        if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)) { return false; }
+        if (hour > 23 || minute > 59 || second > 59) { return false; }
+        epoch = TimeFormat::daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+        return true;
+    }
+}
+
+bool TimeFormat::parse(string_view value, int64_t& epoch) {
+    // "YYYY-MM-DD" + " HH:MM"
+    if (value.size() != 16 && value.size() != 19) { return false; }
+    if (!matchesLayout(value.data(), 0x00FFFF00FFFFFFFFULL, 0x2D00002D00000000ULL)) { return false; }
+    if (!matchesLayout(value.data() + 8, 0xFFFF00FFFF00FFFFULL, 0x00003A0000200000ULL)) { return false; }
+
+    int second = 0;
+    if (value.size() == 19) { // ":SS"
+        if (value[16] != ':' || !isdigit((unsigned char) value[17]) || !isdigit((unsigned char) value[18])) { return false; }
+        second = digitsAt(value, 17, 2);
+    }
+    return epochOf(digitsAt(value, 0, 4), digitsAt(value, 5, 2), digitsAt(value, 8, 2),
+                   digitsAt(value, 11, 2), digitsAt(value, 14, 2), second, epoch);
+}
+
+bool TimeFormat::parse(string_view value, const string& format, int64_t& epoch) {
+    tm t = {};
+    istringstream ss{string(value)};
+    ss >> get_time(&t, format.c_str());
+    if (ss.fail()) { return false; }
+    return epochOf(t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec, epoch);
+}
+
+int64_t TimeFormat::toEpoch(int year, int month, int day) {
+    int64_t months = (int64_t) year * 12 + (month - 1);
+    int64_t normalizedYear = months >= 0 ? months / 12 : (months - 11) / 12;
+    return (daysFromCivil(normalizedYear, months - normalizedYear * 12 + 1, 1) + day - 1) * 86400;
+}
+
+// Howard Hinnant's days_from_civil(), counting in eras of 400 years that all have the same number of days
+int64_t TimeFormat::daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1; // counted from March 1st
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+// The inverse of daysFromCivil()
+void TimeFormat::civilFromDays(int64_t days, int& year, int& month, int& day) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t monthFromMarch = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * monthFromMarch + 2) / 5 + 1;
+    month = monthFromMarch < 10 ? monthFromMarch + 3 : monthFromMarch - 9;
+    year = yearOfEra + era * 400 + (month <= 2);
+}
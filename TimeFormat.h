@@ -0,0 +1,44 @@
+// TimeFormat.h
+
+#ifndef TIMEFORMAT_H
+#define TIMEFORMAT_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+// Conversions between the text of TIME values and the epoch seconds they are stored as.
+//
+// TIME values in the CSV are wall-clock times without a time zone. They are stored as the epoch seconds
+// of that wall-clock time read as UTC, and converted with calendar arithmetic instead of mktime() and
+// localtime(), which consult the time zone and take a global lock on every call. The same seconds come
+// back as the same wall-clock time through civilFromDays() or gmtime_r().
+class TimeFormat {
+    public:
+        // The format parse(value, epoch) reads, the default DTFORMATSTRING.
+        static constexpr const char* FORMAT = "%Y-%m-%d %H:%M";
+
+        // Parses "YYYY-MM-DD HH:MM", optionally followed by ":SS", without going through a stream.
+        // Returns false, leaving epoch unchanged, if the value is not a valid time in this format.
+        static bool parse(string_view value, int64_t& epoch);
+
+        // Parses a value in any get_time() format, for stores configured with a format other than FORMAT.
+        static bool parse(string_view value, const string& format, int64_t& epoch);
+
+        // Epoch seconds of the start of the day. Months outside 1..12 roll over into the neighbouring years,
+        // so the end of December is toEpoch(year, 13, 1).
+        static int64_t toEpoch(int year, int month, int day);
+
+        // Days since 1970-01-01 of the date, the month being 1..12.
+        static int64_t daysFromCivil(int year, int month, int day);
+
+        // Date of the number of days since 1970-01-01.
+        static void civilFromDays(int64_t days, int& year, int& month, int& day);
+
+        // Days since 1970-01-01 of epoch seconds, rounding down for times before 1970.
+        static int64_t daysFromEpoch(int64_t epoch) { return (epoch >= 0 ? epoch : epoch - 86399) / 86400; }
+};
+
+#endif
@@ -0,0 +1,160 @@
+#include <cstring>
+#include "XorBlock.h"
+
+using namespace std;
+
+namespace {
+    // Appends bits to a buffer, least significant bit first
+    class BitWriter {
+        public:
+            explicit BitWriter(vector<char>& out) : out(out) {}
+
+            // Appends the lowest count bits of value, count being at most 32
+            void write(uint64_t value, int count) {
+                bits |= value << used;
+                used += count;
+                if (used >= 32) {
+                    char word[4];
+                    uint32_t low = (uint32_t) bits;
+                    memcpy(word, &low, 4);
+                    out.insert(out.end(), word, word + 4);
+                    bits >>= 32;
+                    used -= 32;
+                }
+            }
+
+            // Appends the bits still buffered
+            void flush() {
+                for (; used > 0; used -= 8) {
+                    out.push_back((char) bits);
+                    bits >>= 8;
+                }
+                used = 0;
+            }
+
+        private:
+            vector<char>& out;
+            uint64_t bits = 0;
+            int used = 0;
+    };
+
+    // Reads bits written by BitWriter, followed by XorBlock::PADDING bytes
+    class BitReader {
+        public:
+            explicit BitReader(const char* bits) : bits(bits) {}
+
+            // The next count bits, count being at most 32
+            uint32_t read(int count) {
+                uint64_t word;
+                memcpy(&word, bits + position / 8, 8);
+                word >>= position % 8;
+                position += count;
+                return (uint32_t) (word & ((1ULL << count) - 1));
+            }
+
+        private:
+            const char* bits;
+            size_t position = 0;
+    };
+
+    // Decodes values one at a time, keeping the window of meaningful bits of the previous value
+    class Decoder {
+        public:
+            explicit Decoder(const char* bits) : reader(bits) {}
+
+            uint32_t first() {
+                previous = reader.read(32);
+                return previous;
+            }
+
+            uint32_t next() {
+                if (reader.read(1) == 0) { return previous; }
+                if (reader.read(1) == 1) {
+                    leading = reader.read(5);
+                    length = reader.read(5) + 1;
+                }
+                previous ^= reader.read(length) << (32 - leading - length);
+                return previous;
+            }
+
+        private:
+            BitReader reader;
+            uint32_t previous = 0;
+            int leading = 0;
+            int length = 32;
+    };
+
+    uint32_t bitsOf(float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, 4);
+        return bits;
+    }
+
+    float floatOf(uint32_t bits) {
+        float value;
+        memcpy(&value, &bits, 4);
+        return value;
+    }
+}
+
+void XorBlock::encode(const float* values, size_t count, vector<char>& out) {
+    size_t start = out.size();
+    out.resize(start + sizeof(Header));
+    BitWriter writer(out);
+
+    if (count > 0) { writer.write(bitsOf(values[0]), 32); }
+    uint32_t previous = count > 0 ? bitsOf(values[0]) : 0;
+    int leading = 33, trailing = 33; // no window yet
+    for (size_t i = 1; i < count; i++) {
+        uint32_t current = bitsOf(values[i]);
+        uint32_t difference = current ^ previous;
+        previous = current;
+        if (difference == 0) {
+            writer.write(0, 1);
+            continue;
+        }
+
+        int newLeading = __builtin_clz(difference);
+        int newTrailing = __builtin_ctz(difference);
+        if (newLeading >= leading && newTrailing >= trailing) { // Fits in the window of the previous value
+            writer.write(0b01, 2);
+            writer.write(difference >> trailing, 32 - leading - trailing);
+            continue;
+        }
+        leading = newLeading;
+        trailing = newTrailing;
+        int length = 32 - leading - trailing;
+        writer.write(0b11 | leading << 2 | (length - 1) << 7, 12);
+        writer.write(difference >> trailing, length);
+    }
+    writer.flush();
+
+    Header header = {(uint32_t) count, (uint32_t) (out.size() - start - sizeof(Header))};
+    memcpy(&out[start], &header, sizeof(Header));
+    out.resize(out.size() + PADDING, 0);
+}
+
+XorBlock::Header XorBlock::header(const char* block) {
+    Header header;
+    memcpy(&header, block, sizeof(Header));
+    return header;
+}
+
+void XorBlock::decode(const char* block, float* out) {
+    Header header = XorBlock::header(block);
+    if (header.count == 0) { return; }
+    Decoder decoder(block + sizeof(Header));
+    out[0] = floatOf(decoder.first());
+    for (size_t i = 1; i < header.count; i++) {
+        out[i] = floatOf(decoder.next());
+    }
+}
+
+float XorBlock::at(const char* block, size_t index) {
+    Decoder decoder(block + sizeof(Header));
+    uint32_t value = decoder.first();
+    for (size_t i = 0; i < index; i++) {
+        value = decoder.next();
+    }
+    return floatOf(value);
+}
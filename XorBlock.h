@@ -0,0 +1,46 @@
+// XorBlock.h
+
+#ifndef XORBLOCK_H
+#define XORBLOCK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// XOR encoding of a block of FLOAT values (as in Facebook's Gorilla), one block per zone.
+//
+// The first value is stored as its 32 bits. Every next value is XORed with the previous one, and since
+// consecutive readings of a sensor differ little, the result mostly has long runs of leading and trailing
+// zeros. Only the bits in between are stored:
+//   - '0' when the value repeats,
+//   - '10' followed by the bits within the leading/trailing zero window of the previous value, if they fit,
+//   - '11', 5 bits of leading zeros, 5 bits of length - 1 and the bits themselves otherwise, opening a new window.
+// Nulls are stored as their NaN bits like any other value.
+//
+// Blocks are decoded on their own, so a value is found by decoding the block of its zone up to it.
+class XorBlock {
+    public:
+        struct Header {
+            uint32_t count; // number of values
+            uint32_t byteLength; // of the encoded bits, without the padding
+        };
+
+        // Bytes after the encoded bits, so that they can be read with unaligned 8 byte loads.
+        static const size_t PADDING = 8;
+
+        // Appends the block encoding the count values to out.
+        static void encode(const float* values, size_t count, vector<char>& out);
+
+        // The header of the block starting at the pointer.
+        static Header header(const char* block);
+
+        // Decodes the values of the block into out, which has room for header(block).count values.
+        static void decode(const char* block, float* out);
+
+        // The index-th value of the block, decoding the values before it.
+        static float at(const char* block, size_t index);
+};
+
+#endif
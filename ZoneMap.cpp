@@ -0,0 +1,66 @@
+#include <limits>
+#include <algorithm>
+#include "ZoneMap.h"
+
+using namespace std;
+
+ZoneMap::Zone& ZoneMap::nextZone() {
+    if (zones.empty() || zones.back().rowCount == ZONE_ROWS) {
+        zones.push_back(Zone{numeric_limits<double>::infinity(), -numeric_limits<double>::infinity(), 0, 0, 0, 0, 0});
+    }
+    return zones.back();
+}
+
+void ZoneMap::addValue(double value) {
+    Zone& zone = nextZone();
+    zone.min = min(zone.min, value);
+    zone.max = max(zone.max, value);
+    zone.rowCount++;
+    rowCount++;
+}
+
+void ZoneMap::addNull() {
+    Zone& zone = nextZone();
+    zone.nullCount++;
+    zone.rowCount++;
+    rowCount++;
+}
+
+void ZoneMap::addUnknown() {
+    Zone& zone = nextZone();
+    zone.min = -numeric_limits<double>::infinity();
+    zone.max = numeric_limits<double>::infinity();
+    zone.rowCount++;
+    rowCount++;
+}
+
+void ZoneMap::addZone(const Zone& zone) {
+    zones.push_back(zone);
+    rowCount += zone.rowCount;
+}
+
+void ZoneMap::setLastBlock(uint64_t byteOffset, uint32_t byteLength, uint8_t encoding) {
+    zones.back().byteOffset = byteOffset;
+    zones.back().byteLength = byteLength;
+    zones.back().encoding = encoding;
+}
+
+void ZoneMap::removeLastZone() {
+    rowCount -= zones.back().rowCount;
+    zones.pop_back();
+}
+
+bool ZoneMap::mayMatch(size_t zone, const Predicate& predicate) const {
+    const Zone& stats = zones[zone];
+    return predicate.mayMatchRange(stats.min, stats.max, stats.nullCount > 0, stats.nullCount < stats.rowCount);
+}
+
+Selection ZoneMap::candidateRows(const Predicate& predicate) const {
+    Selection rows;
+    for (size_t zone = 0; zone < zones.size(); zone++) {
+        if (mayMatch(zone, predicate)) {
+            rows.addRange(firstRow(zone), firstRow(zone) + zones[zone].rowCount);
+        }
+    }
+    return rows;
+}
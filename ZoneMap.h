@@ -0,0 +1,70 @@
+// ZoneMap.h
+
+#ifndef ZONEMAP_H
+#define ZONEMAP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Predicate.h"
+#include "Selection.h"
+
+using namespace std;
+
+// Per-block statistics of a column, kept in the footer of the segment file holding it (see Segment).
+//
+// The rows of a column are split into zones of ZONE_ROWS consecutive rows. For each zone the
+// minimum, maximum and number of nulls are kept, together with where the block encoding its rows
+// is in the segment file, so that range predicates and min/max queries can skip whole zones and
+// jump straight to the ones they need.
+class ZoneMap {
+    public:
+        static const uint32_t ZONE_ROWS = 4096;
+
+        struct Zone {
+            double min; // -infinity/+infinity when the zone holds values without statistics (e.g. strings)
+            double max;
+            uint32_t nullCount;
+            uint32_t rowCount;
+            uint64_t byteOffset; // where the block of the zone starts in the segment file
+            uint32_t byteLength; // of the block
+            uint8_t encoding; // of the block, see Segment::Encoding
+        };
+
+        vector<Zone> zones;
+
+        // Number of rows recorded so far.
+        uint64_t rowCount = 0;
+
+        // Records the next row of the column.
+        void addValue(double value);
+        void addNull();
+        // A non-null value no statistics are kept for.
+        void addUnknown();
+
+        // Appends a zone recorded before, e.g. read from a footer or copied to another place.
+        void addZone(const Zone& zone);
+
+        // Records where the block of the last zone was written.
+        void setLastBlock(uint64_t byteOffset, uint32_t byteLength, uint8_t encoding);
+
+        // Forgets the last zone and its rows, e.g. to write its block again together with the rows after it.
+        void removeLastZone();
+
+        bool empty() const { return zones.empty(); }
+
+        // First row of the zone.
+        uint32_t firstRow(size_t zone) const { return zone * ZONE_ROWS; }
+
+        // Whether some row of the zone may match the predicate.
+        bool mayMatch(size_t zone, const Predicate& predicate) const;
+
+        // The rows of every zone that may match the predicate.
+        Selection candidateRows(const Predicate& predicate) const;
+
+    private:
+        // The zone the next row goes into, started if needed.
+        Zone& nextZone();
+};
+
+#endif
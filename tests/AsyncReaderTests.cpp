@@ -0,0 +1,189 @@
+// AsyncReaderTests.cpp
+//
+// Batched reads through io_uring and through the pread() fallback: both deliver the same bytes, into buffers of the
+// caller or of the reader, short past the end of the file, and fail the same way. Reads the kernel does not take at
+// once are submitted later.
+//
+// AsyncReader.cpp is included here, so that the tests can stand in for io_uring_enter().
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -pthread -I. tests/AsyncReaderTests.cpp ThreadPool.cpp -o async_reader_tests && ./async_reader_tests
+
+#undef NDEBUG
+#include <fcntl.h>
+#include <unistd.h>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "AsyncReader.cpp"
+
+using namespace std;
+
+const size_t FILE_SIZE = 1000000;
+
+char byteAt(uint64_t offset) { return (char) (offset * 31 % 251); }
+
+// A file of FILE_SIZE bytes of byteAt(), in a directory of its own removed once the tests are done
+string testFile() {
+    static const filesystem::path directory = filesystem::temp_directory_path() / "column_store_async_reader_tests";
+    filesystem::create_directories(directory);
+    string filepath = (directory / "bytes").string();
+    ofstream outputStream(filepath, ios::binary | ios::trunc);
+    for (uint64_t offset = 0; offset < FILE_SIZE; offset++) { outputStream.put(byteAt(offset)); }
+    return filepath;
+}
+
+// The bytes every read delivered, by index, checking that each completes exactly once
+vector<string> readAll(AsyncReader& reader, const vector<AsyncReader::Read>& reads) {
+    vector<string> bytes(reads.size());
+    vector<int> completions(reads.size());
+    mutex completionMutex;
+    reader.readAll(reads, [&](size_t index, const char* buffer, size_t byteCount) {
+        lock_guard<mutex> lock(completionMutex);
+        if (reads[index].buffer) { assert(buffer == reads[index].buffer); }
+        bytes[index].assign(buffer, byteCount);
+        completions[index]++;
+    });
+    for (int count : completions) { assert(count == 1); }
+    return bytes;
+}
+
+void testReads(AsyncReader& reader, int fd) {
+    // More reads than the queue holds, of every size, some into buffers of the caller
+    vector<AsyncReader::Read> reads;
+    vector<vector<char>> buffers;
+    for (uint64_t i = 0; i < 100; i++) {
+        uint64_t offset = (i * 7919 * 13) % FILE_SIZE;
+        size_t length = 1 + (i * 104729) % 70000;
+        reads.push_back({fd, offset, length});
+    }
+    buffers.reserve(reads.size());
+    for (size_t i = 0; i < reads.size(); i += 3) {
+        buffers.emplace_back(reads[i].length);
+        reads[i].buffer = buffers.back().data();
+    }
+
+    // Short reads: across the end of the file, at its end and past it
+    reads.push_back({fd, FILE_SIZE - 10, 4096});
+    reads.push_back({fd, FILE_SIZE, 100});
+    reads.push_back({fd, FILE_SIZE + 5000, 100});
+    buffers.emplace_back(4096);
+    reads.push_back({fd, FILE_SIZE - 4000, 4096, buffers.back().data()});
+
+    vector<string> bytes = readAll(reader, reads);
+    for (size_t i = 0; i < reads.size(); i++) {
+        size_t expectedLength = reads[i].offset >= FILE_SIZE ? 0 : min<uint64_t>(reads[i].length, FILE_SIZE - reads[i].offset);
+        assert(bytes[i].size() == expectedLength);
+        for (size_t j = 0; j < bytes[i].size(); j++) { assert(bytes[i][j] == byteAt(reads[i].offset + j)); }
+    }
+    assert(bytes[100].size() == 10 && bytes[101].empty() && bytes[102].empty() && bytes[103].size() == 4000);
+
+    // Nothing to read calls nothing
+    readAll(reader, {});
+
+    // A file that cannot be read fails the batch, a read that works or not
+    bool thrown = false;
+    try {
+        readAll(reader, {{fd, 0, 100}, {-1, 0, 100}, {fd, 200, 100}});
+    } catch (runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // So does a failing completion, once the reads in flight are done, and the reader can be used again
+    thrown = false;
+    try {
+        reader.readAll({{fd, 0, 100}, {fd, 100, 100}}, [](size_t, const char*, size_t) { throw runtime_error("Failed"); });
+    } catch (runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    assert(readAll(reader, {{fd, 5, 3}})[0] == string({byteAt(5), byteAt(6), byteAt(7)}));
+}
+
+void testRingAndPread(const string& filepath) {
+    int fd = open(filepath.c_str(), O_RDONLY);
+    assert(fd >= 0);
+
+    AsyncReader preadReader(4, false);
+    assert(!preadReader.usesIoUring());
+    testReads(preadReader, fd);
+
+    // io_uring may be unavailable (old kernel, seccomp), the reader falls back to pread() then. Either way it reads the same
+    for (size_t depth : {(size_t) 1, (size_t) 4, AsyncReader::QUEUE_DEPTH}) {
+        AsyncReader ringReader(depth, true);
+        if (!ringReader.usesIoUring()) { cout << "io_uring is not available, testing its pread() fallback instead." << endl; }
+        testReads(ringReader, fd);
+    }
+
+    // A queue of a single read at a time still reads everything
+    AsyncReader singleReader(0);
+    testReads(singleReader, fd);
+    close(fd);
+}
+
+// The kernel takes one read of those submitted, and none on the next submit before a wait, as when it is short of resources.
+// The reads it did not take stay queued and go with the next submit
+bool tookRead = false;
+size_t refusedSubmits = 0;
+
+long enterTakingOne(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    if (toSubmit > 0 && tookRead) {
+        refusedSubmits++;
+        errno = EAGAIN;
+        return -1;
+    }
+    tookRead = toSubmit > 0;
+    return syscall(__NR_io_uring_enter, ringFd, min(toSubmit, 1u), minComplete, flags, nullptr, 0);
+}
+
+long enterTakingNone(int, unsigned toSubmit, unsigned, unsigned) {
+    errno = toSubmit > 0 ? EAGAIN : EINVAL;
+    return -1;
+}
+
+void testShortSubmits(const string& filepath) {
+    int fd = open(filepath.c_str(), O_RDONLY);
+    assert(fd >= 0);
+    AsyncReader reader(8, true);
+    if (!reader.usesIoUring()) {
+        cout << "io_uring is not available, not testing short submits." << endl;
+        close(fd);
+        return;
+    }
+    auto kernelEnter = enterRing;
+
+    enterRing = enterTakingOne;
+    testReads(reader, fd);
+    assert(refusedSubmits > 100);
+
+    // Taking none of the reads leaves nothing to wait for, the batch fails and the reads are taken back off the queue
+    enterRing = enterTakingNone;
+    bool thrown = false;
+    try {
+        readAll(reader, {{fd, 0, 100}, {fd, 100, 100}});
+    } catch (runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // So the ring reads as before once the kernel takes reads again
+    enterRing = kernelEnter;
+    assert(readAll(reader, {{fd, 5, 3}})[0] == string({byteAt(5), byteAt(6), byteAt(7)}));
+    testReads(reader, fd);
+    close(fd);
+}
+
+int main() {
+    string filepath = testFile();
+    testRingAndPread(filepath);
+    testShortSubmits(filepath);
+    filesystem::remove_all(filesystem::path(filepath).parent_path());
+    cout << "All async reader tests passed." << endl;
+    return 0;
+}
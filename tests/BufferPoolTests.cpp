@@ -0,0 +1,216 @@
+// BufferPoolTests.cpp
+//
+// The pin and eviction rules of the BufferPool: hits and misses, the byte budget, pinned pages over it, released files
+// and the second chance the CLOCK gives to pages read again.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -pthread -I. tests/BufferPoolTests.cpp BufferPool.cpp ColumnFile.cpp -o buffer_pool_tests && ./buffer_pool_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "BufferPool.h"
+
+using namespace std;
+
+const size_t PAGE_SIZE = BufferPool::PAGE_SIZE;
+
+// A file of 10 whole pages and part of an 11th, in a directory of its own removed once the tests are done
+string testFile() {
+    static const filesystem::path directory = filesystem::temp_directory_path() / "column_store_buffer_pool_tests";
+    filesystem::create_directories(directory);
+    string filepath = (directory / "pages").string();
+    ofstream outputStream(filepath, ios::binary | ios::trunc);
+    vector<char> bytes(PAGE_SIZE * 10 + 100, 'x');
+    outputStream.write(bytes.data(), bytes.size());
+    return filepath;
+}
+
+size_t containedPages(const BufferPool& pool, const ColumnFile& file) {
+    size_t count = 0;
+    for (size_t page = 0; page < 11; page++) {
+        if (pool.contains(file, page)) { count++; }
+    }
+    return count;
+}
+
+void testPinning(const string& filepath) {
+    shared_ptr<const ColumnFile> file = ColumnFile::open(filepath);
+    assert(file && file->size() == PAGE_SIZE * 10 + 100);
+    BufferPool pool(PAGE_SIZE * 4);
+    assert(pool.byteBudget() == PAGE_SIZE * 4);
+
+    // A first pin misses, pinning the same page again hits
+    {
+        BufferPool::Pin pin = pool.pin(*file, 0, 10);
+        BufferPool::Statistics statistics = pool.statistics();
+        assert(statistics.misses == 1 && statistics.hits == 0 && statistics.pinnedPages == 1);
+        assert(pool.contains(*file, 0) && !pool.contains(*file, 1));
+    }
+    {
+        BufferPool::Pin pin = pool.pin(*file, 5, 10);
+        BufferPool::Statistics statistics = pool.statistics();
+        assert(statistics.misses == 1 && statistics.hits == 1 && statistics.pinnedPages == 1);
+    }
+
+    // Bytes across a page boundary pin both pages, no bytes pin none
+    {
+        BufferPool::Pin pin = pool.pin(*file, PAGE_SIZE - 1, 2);
+        assert(pool.statistics().pinnedPages == 2 && pool.contains(*file, 1));
+    }
+    {
+        BufferPool::Pin pin = pool.pin(*file, PAGE_SIZE * 3, 0);
+        assert(pool.statistics().pinnedPages == 0 && !pool.contains(*file, 3));
+    }
+
+    // Pinned pages take the pool over its budget, it shrinks back to it once they are unpinned
+    {
+        BufferPool::Pin pin = pool.pin(*file);
+        BufferPool::Statistics statistics = pool.statistics();
+        assert(statistics.pinnedPages == 11 && statistics.residentBytes == 11 * PAGE_SIZE);
+        assert(statistics.evictions == 0 && containedPages(pool, *file) == 11);
+    }
+    BufferPool::Statistics statistics = pool.statistics();
+    assert(statistics.pinnedPages == 0 && statistics.residentBytes == 4 * PAGE_SIZE && statistics.evictions == 7);
+    assert(containedPages(pool, *file) == 4);
+
+    // Moving a pin hands over its pages, which are unpinned once
+    {
+        BufferPool::Pin first = pool.pin(*file, 0, 1);
+        BufferPool::Pin second = move(first);
+        BufferPool::Pin third;
+        third = move(second);
+        assert(pool.statistics().pinnedPages == 1);
+        third = pool.pin(*file, PAGE_SIZE * 2, PAGE_SIZE);
+        assert(pool.statistics().pinnedPages == 1);
+    }
+    assert(pool.statistics().pinnedPages == 0);
+
+    // Readers on many threads, never above the budget once they are done
+    vector<thread> readers;
+    for (size_t reader = 0; reader < 8; reader++) {
+        readers.emplace_back([&, reader] {
+            for (size_t i = 0; i < 5000; i++) {
+                size_t offset = (i * 7919 + reader) % file->size();
+                BufferPool::Pin pin = pool.pin(*file, offset, 70000);
+                assert(file->data()[offset] == 'x');
+            }
+        });
+    }
+    for (thread& reader : readers) { reader.join(); }
+    statistics = pool.statistics();
+    assert(statistics.pinnedPages == 0 && statistics.residentBytes <= 4 * PAGE_SIZE);
+
+    // Once every page is pinned, pins find nothing to evict until some are unpinned, which makes room again
+    {
+        BufferPool::Pin front = pool.pin(*file, 0, 6 * PAGE_SIZE);
+        BufferPool::Pin back = pool.pin(*file, 6 * PAGE_SIZE, 5 * PAGE_SIZE);
+        BufferPool::Pin again = pool.pin(*file, 0, 1);
+        statistics = pool.statistics();
+        assert(statistics.pinnedPages == 11 && statistics.residentBytes == 11 * PAGE_SIZE);
+        front = BufferPool::Pin();
+        statistics = pool.statistics();
+        assert(statistics.pinnedPages == 6 && statistics.residentBytes == 6 * PAGE_SIZE);
+    }
+    assert(pool.statistics().residentBytes == 4 * PAGE_SIZE);
+
+    // A released file has no pages left in the pool
+    pool.release(*file);
+    assert(pool.statistics().residentBytes == 0 && containedPages(pool, *file) == 0);
+}
+
+void testRelease(const string& filepath) {
+    BufferPool pool(PAGE_SIZE * 4);
+
+    // The pool keeps the mapping of its pages alive until the file is released
+    shared_ptr<const ColumnFile> file = ColumnFile::open(filepath);
+    weak_ptr<const ColumnFile> mapping = file;
+    {
+        BufferPool::Pin pin = pool.pin(*file, 0, 1);
+        file.reset();
+        assert(!mapping.expired());
+    }
+    assert(!mapping.expired());
+    pool.release(*mapping.lock());
+    assert(mapping.expired());
+
+    // Pages still pinned when their file is released are retired, and dropped once they are unpinned
+    file = ColumnFile::open(filepath);
+    mapping = file;
+    {
+        BufferPool::Pin pin = pool.pin(*file, 0, PAGE_SIZE * 2);
+        pool.release(*file);
+        file.reset();
+        BufferPool::Statistics statistics = pool.statistics();
+        assert(!mapping.expired() && statistics.pinnedPages == 2 && statistics.residentBytes == 2 * PAGE_SIZE);
+    }
+    assert(mapping.expired());
+    assert(pool.statistics().residentBytes == 0 && pool.statistics().pinnedPages == 0);
+
+    // A retired page pinned again is dropped on its last unpin only, its unpinned neighbours at once
+    file = ColumnFile::open(filepath);
+    {
+        BufferPool::Pin neighbour = pool.pin(*file, PAGE_SIZE, 1);
+    }
+    {
+        BufferPool::Pin retired = pool.pin(*file, 0, 1);
+        pool.release(*file);
+        assert(pool.contains(*file, 0) && !pool.contains(*file, 1));
+        {
+            BufferPool::Pin again = pool.pin(*file, 0, 1);
+            assert(pool.statistics().pinnedPages == 1);
+        }
+        assert(pool.contains(*file, 0) && pool.statistics().residentBytes == PAGE_SIZE);
+    }
+    BufferPool::Statistics statistics = pool.statistics();
+    assert(statistics.pinnedPages == 0 && statistics.residentBytes == 0 && !pool.contains(*file, 0));
+}
+
+// The CLOCK gives pages pinned since the hand last passed a second chance, so the page read least recently goes first
+void testClock(const string& filepath) {
+    shared_ptr<const ColumnFile> file = ColumnFile::open(filepath);
+    BufferPool pool(PAGE_SIZE * 3);
+    for (size_t page = 0; page < 3; page++) {
+        BufferPool::Pin pin = pool.pin(*file, page * PAGE_SIZE, 1);
+    }
+    assert(containedPages(pool, *file) == 3 && pool.statistics().evictions == 0);
+
+    // Every page was pinned since, the hand clears them all and evicts the first unpinned one on its second sweep
+    {
+        BufferPool::Pin pin = pool.pin(*file, 3 * PAGE_SIZE, 1);
+        assert(!pool.contains(*file, 0) && pool.contains(*file, 3) && pool.statistics().evictions == 1);
+    }
+
+    // Page 1 is read again and survives the next eviction, page 2 was not and goes
+    {
+        BufferPool::Pin pin = pool.pin(*file, PAGE_SIZE, 1);
+    }
+    {
+        BufferPool::Pin pin = pool.pin(*file, 4 * PAGE_SIZE, 1);
+    }
+    assert(pool.contains(*file, 1) && !pool.contains(*file, 2) && pool.contains(*file, 4));
+    BufferPool::Statistics statistics = pool.statistics();
+    assert(statistics.evictions == 2 && statistics.residentBytes == 3 * PAGE_SIZE && statistics.hits == 1 && statistics.misses == 5);
+
+    // A pool holding only pinned pages evicts nothing until they are unpinned
+    {
+        BufferPool::Pin pinned = pool.pin(*file, 5 * PAGE_SIZE, 4 * PAGE_SIZE);
+        assert(pool.statistics().evictions == 5 && pool.statistics().residentBytes == 4 * PAGE_SIZE);
+    }
+    assert(pool.statistics().residentBytes == 3 * PAGE_SIZE && pool.statistics().evictions == 6);
+}
+
+int main() {
+    string filepath = testFile();
+    testPinning(filepath);
+    testRelease(filepath);
+    testClock(filepath);
+    filesystem::remove_all(filesystem::path(filepath).parent_path());
+    cout << "All buffer pool tests passed." << endl;
+    return 0;
+}
@@ -0,0 +1,144 @@
+// CSVIngestTests.cpp
+//
+// Parsing a CSV file in chunks on several workers reads every row as a serial parse would, whatever lines the chunks
+// start and end at: CRLF line endings, blank lines, rows short of values or with one too many, unparsable values and
+// quoted fields, which are plain text to the parser and kept with their quotes. Streamed through in windows of a
+// megabyte, the file is stored in batches of at most the rows asked for, and no line is split between windows.
+//
+// The stores define their classes in their .cpp files, which are included here.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -pthread -I. tests/CSVIngestTests.cpp CalendarColumns.cpp ColumnFile.cpp MinMaxKernels.cpp Predicate.cpp Selection.cpp StringDictionary.cpp ThreadPool.cpp TimeFormat.cpp -o csv_ingest_tests && ./csv_ingest_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "ColumnStoreAbstract.cpp"
+#define COLUMNSTOREABSTRACT_H
+#include "ColumnStoreMM.cpp"
+
+using namespace std;
+
+const string STATIONS[] = {"Changi", "Seletar", "\"Paya Lebar\""};
+
+const int INTEGER = ColumnStoreAbstract::INTEGER_DATATYPE;
+const int STRING = ColumnStoreAbstract::STRING_DATATYPE;
+const int FLOAT = ColumnStoreAbstract::FLOAT_DATATYPE;
+const int TIME = ColumnStoreAbstract::TIME_DATATYPE;
+
+const unordered_map<string, int> COLUMNS = {{"Id", INTEGER}, {"Station", STRING}, {"Reading", FLOAT}, {"Timestamp", TIME}};
+
+// Rows of about 45 bytes, enough of them for the file to be split into several chunks of at least a megabyte
+const size_t ROW_COUNT = 120000;
+
+// The values of row i, with nulls. Every 11th row is short of its reading and timestamp
+int32_t idOf(size_t row) { return row % 31 == 7 ? ColumnStoreAbstract::NULL_INTEGER : (int32_t) row; }
+string_view stationOf(size_t row) { return row % 17 == 0 ? string_view("M") : string_view(STATIONS[row % 3]); }
+bool isShort(size_t row) { return row % 11 == 3; }
+float readingOf(size_t row) { return isShort(row) || row % 19 == 0 || row % 23 == 0 ? ColumnStoreAbstract::NULL_FLOAT : row * 0.25f; }
+int64_t timestampOf(size_t row) {
+    if (isShort(row)) { return ColumnStoreAbstract::NULL_TIME; }
+    return TimeFormat::toEpoch(2019, row / (1440 * 28) % 12 + 1, row / 1440 % 28 + 1) + (int64_t) (row % 1440) * 60;
+}
+
+// The line of row i: nulls as "M", a reading that does not parse every 23rd row, a value too many every 13th row,
+// a CRLF line ending every 7th row and a blank line after every 29th row
+string lineOf(size_t row) {
+    string line = (idOf(row) == ColumnStoreAbstract::NULL_INTEGER ? string("M") : to_string(row)) + "," + string(stationOf(row));
+    if (!isShort(row)) {
+        char timestamp[32];
+        snprintf(timestamp, sizeof(timestamp), "2019-%02d-%02d %02d:%02d", (int) (row / (1440 * 28) % 12 + 1), (int) (row / 1440 % 28 + 1), (int) (row % 1440 / 60), (int) (row % 60));
+        string reading = row % 23 == 0 ? "abc" : row % 19 == 0 ? "M" : to_string(row * 0.25);
+        line += "," + reading + "," + timestamp;
+    }
+    if (row % 13 == 0) { line += ",extra"; }
+    line += row % 7 == 0 ? "\r\n" : "\n";
+    if (row % 29 == 0) { line += "\n"; }
+    return line;
+}
+
+// The file of the rows, its last line without a line ending if unterminated
+void writeCSV(const string& filepath, bool unterminated = false) {
+    ofstream outputStream(filepath, ios::binary | ios::trunc);
+    outputStream << "Id,Station,Reading,Timestamp\n";
+    for (size_t row = 0; row + 1 < ROW_COUNT; row++) { outputStream << lineOf(row); }
+    string last = lineOf(ROW_COUNT - 1);
+    outputStream << (unterminated ? last.substr(0, last.find_first_of("\r\n")) : last);
+}
+
+// A main memory store recording the number of rows of every batch it stores
+class BatchCountingStore : public ColumnStoreMM {
+    public:
+        vector<size_t> batchRows;
+
+        BatchCountingStore() : ColumnStoreMM(COLUMNS) {}
+
+        void storeBatch(const ColumnBatch& batch) override {
+            batchRows.push_back(batch.rowCount);
+            ColumnStoreMM::storeBatch(batch);
+        }
+};
+
+// Every row of the store holds the values of its line
+void checkRows(ColumnStoreAbstract& store) {
+    Selection stored = store.filter("Id", Predicate::anyOf({Predicate::isNull(), Predicate::negate(Predicate::isNull())}));
+    assert(stored == Selection::range(0, ROW_COUNT));
+    Selection rows = Selection::range(0, ROW_COUNT);
+    vector<int32_t> ids(ROW_COUNT);
+    vector<string_view> stations(ROW_COUNT);
+    vector<float> readings(ROW_COUNT);
+    vector<int64_t> timestamps(ROW_COUNT);
+    assert(store.getValues("Id", rows, ids.data()) && store.getValues("Station", rows, stations.data()));
+    assert(store.getValues("Reading", rows, readings.data()) && store.getValues("Timestamp", rows, timestamps.data()));
+    for (size_t row = 0; row < ROW_COUNT; row++) {
+        assert(ids[row] == idOf(row) && stations[row] == stationOf(row) && timestamps[row] == timestampOf(row));
+        assert(isnan(readingOf(row)) ? isnan(readings[row]) : readings[row] == readingOf(row));
+    }
+}
+
+// More workers than the file has megabytes, so that it is parsed in several chunks even on a single core
+void testChunks(const string& filepath) {
+    assert(ThreadPool::shared().workerCount() == 4);
+    assert(filesystem::file_size(filepath) > 4 << 20);
+    ColumnStoreMM store(COLUMNS);
+    store.addCSVData(filepath);
+    checkRows(store);
+}
+
+// Windows of a megabyte, each ending at a line, parsed into batches of at most 1000 rows
+void testWindows(const string& filepath) {
+    for (bool unterminated : {false, true}) {
+        writeCSV(filepath, unterminated);
+        BatchCountingStore store;
+        store.addCSVData(filepath, 1000, 1);
+        checkRows(store);
+
+        size_t rowCount = 0;
+        for (size_t rows : store.batchRows) {
+            assert(rows > 0 && rows <= 1000);
+            rowCount += rows;
+        }
+        // Every window and every chunk of it ends with a batch of its own, so a few batches are short
+        assert(rowCount == ROW_COUNT && store.batchRows.size() > ROW_COUNT / 1000 && store.batchRows.size() < ROW_COUNT / 1000 + 40);
+    }
+}
+
+int main() {
+    ThreadPool::setSharedWorkerCount(4);
+    filesystem::path directory = filesystem::temp_directory_path() / "column_store_csv_ingest_tests";
+    filesystem::create_directories(directory);
+    string filepath = (directory / "rows.csv").string();
+    writeCSV(filepath);
+
+    testChunks(filepath);
+    testWindows(filepath);
+    filesystem::remove_all(directory);
+    cout << "All CSV ingest tests passed." << endl;
+    return 0;
+}
@@ -0,0 +1,83 @@
+// CalendarColumnsTests.cpp
+//
+// The year, month and day CalendarColumns derives from epoch seconds, across month and year ends, leap days and
+// times before 1970, with nulls as 0. Appended batch by batch and kept as runs the way the disk store keeps them, rows
+// of the same date make one run even when they arrive in different batches.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -I. tests/CalendarColumnsTests.cpp CalendarColumns.cpp TimeFormat.cpp -o calendar_columns_tests && ./calendar_columns_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "CalendarColumns.h"
+#include "RunBlock.h"
+#include "TimeFormat.h"
+
+using namespace std;
+
+const int64_t NULL_TIME = INT64_MIN;
+
+struct Date {
+    int year, month, day;
+};
+
+void testDates() {
+    vector<int64_t> times = {
+        0, -1, TimeFormat::toEpoch(2019, 12, 31) + 86399, TimeFormat::toEpoch(2020, 1, 1),
+        TimeFormat::toEpoch(2020, 2, 29) + 43200, TimeFormat::toEpoch(2019, 3, 1), NULL_TIME,
+        TimeFormat::toEpoch(2000, 2, 29), TimeFormat::toEpoch(2100, 3, 1) - 1, TimeFormat::toEpoch(2019, 4, 30) + 3600
+    };
+    vector<Date> dates = {
+        {1970, 1, 1}, {1969, 12, 31}, {2019, 12, 31}, {2020, 1, 1}, {2020, 2, 29}, {2019, 3, 1}, {0, 0, 0},
+        {2000, 2, 29}, {2100, 2, 28}, {2019, 4, 30}
+    };
+    CalendarColumns calendar;
+    calendar.append(times, NULL_TIME);
+    assert(calendar.size() == times.size() && calendar.months.size() == times.size() && calendar.days.size() == times.size());
+    for (size_t row = 0; row < times.size(); row++) {
+        assert(calendar.years[row] == dates[row].year && calendar.months[row] == dates[row].month && calendar.days[row] == dates[row].day);
+    }
+
+    // Appending again extends the columns, leaving the rows already there as they were
+    calendar.append({TimeFormat::toEpoch(2024, 7, 15)}, NULL_TIME);
+    assert(calendar.size() == times.size() + 1 && calendar.years[0] == 1970 && calendar.days[1] == 31);
+    assert(calendar.years.back() == 2024 && calendar.months.back() == 7 && calendar.days.back() == 15);
+}
+
+// Hourly times from 30 December 2019 to 2 January 2020, one of them null, stored in two batches split in the middle
+// of 31 December
+void testRuns() {
+    vector<int64_t> times;
+    for (int64_t hour = 0; hour < 96; hour++) { times.push_back(hour == 50 ? NULL_TIME : TimeFormat::toEpoch(2019, 12, 30) + hour * 3600); }
+
+    vector<RunBlock::Run> years, months, days;
+    for (auto [firstRow, count] : {pair<size_t, size_t>(0, 40), pair<size_t, size_t>(40, 56)}) {
+        CalendarColumns calendar;
+        calendar.append(vector<int64_t>(times.begin() + firstRow, times.begin() + firstRow + count), NULL_TIME);
+        RunBlock::appendRuns(years, calendar.years.data(), calendar.size(), firstRow);
+        RunBlock::appendRuns(months, calendar.months.data(), calendar.size(), firstRow);
+        RunBlock::appendRuns(days, calendar.days.data(), calendar.size(), firstRow);
+    }
+
+    auto equals = [](const vector<RunBlock::Run>& runs, const vector<RunBlock::Run>& expected) {
+        if (runs.size() != expected.size()) { return false; }
+        for (size_t i = 0; i < runs.size(); i++) {
+            if (runs[i].value != expected[i].value || runs[i].end != expected[i].end) { return false; }
+        }
+        return true;
+    };
+    assert(equals(years, {{2019, 48}, {2020, 50}, {0, 51}, {2020, 96}}));
+    assert(equals(months, {{12, 48}, {1, 50}, {0, 51}, {1, 96}}));
+    assert(equals(days, {{30, 24}, {31, 48}, {1, 50}, {0, 51}, {1, 72}, {2, 96}}));
+}
+
+int main() {
+    testDates();
+    testRuns();
+    cout << "All calendar columns tests passed." << endl;
+    return 0;
+}
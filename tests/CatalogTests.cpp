@@ -0,0 +1,107 @@
+// CatalogTests.cpp
+//
+// Round trips and edge cases of the Catalog a disk store keeps to reopen without ingesting again, and its checksum.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -I. tests/CatalogTests.cpp Catalog.cpp -o catalog_tests && ./catalog_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "Catalog.h"
+
+using namespace std;
+
+// A file in a directory of its own, removed once the tests are done
+string testPath(const string& name) {
+    static const filesystem::path directory = filesystem::temp_directory_path() / "column_store_catalog_tests";
+    filesystem::create_directories(directory);
+    return (directory / name).string();
+}
+
+void writeBytes(const string& filepath, const string& bytes) {
+    ofstream outputStream(filepath, ios::binary | ios::trunc);
+    outputStream.write(bytes.data(), bytes.size());
+}
+
+void testCatalog() {
+    Catalog written;
+    written.rowCount = 123456789012ULL;
+    written.segmentBytes = 987654321098ULL;
+    written.calendarColumns = true;
+    written.columns.push_back(Catalog::Column{"Timestamp", 3, "packed", 1});
+    written.columns.push_back(Catalog::Column{"Station name", 0, "runs", 2});
+    written.ingests.push_back(Catalog::Ingest{18446744073709551615ULL, 1024, 48, "data/SingaporeWeather.csv"});
+    written.ingests.push_back(Catalog::Ingest{7, 0, 0, "a path/with spaces.csv"});
+    written.unfinishedIngest = Catalog::Ingest{99, 2048, 0, "data/more.csv"};
+    written.committedRowCount = 120;
+    written.committedSegmentBytes = 4096;
+
+    string filepath = testPath("catalog");
+    written.save(filepath);
+    assert(!filesystem::exists(filepath + ".tmp"));
+    optional<Catalog> read = Catalog::load(filepath);
+    assert(read);
+    assert(read->rowCount == written.rowCount && read->segmentBytes == written.segmentBytes && read->calendarColumns);
+    assert(read->columns.size() == 2);
+    const Catalog::Column* station = read->column("Station name");
+    assert(station && station->dataType == 0 && station->format == "runs" && station->formatVersion == 2);
+    assert(!read->column("Station"));
+    assert(read->ingests.size() == 2 && read->ingests[1].source == "a path/with spaces.csv");
+    const Catalog::Ingest* ingest = read->findIngest(18446744073709551615ULL, 1024);
+    assert(ingest && ingest->rowCount == 48 && ingest->source == "data/SingaporeWeather.csv");
+    assert(!read->findIngest(18446744073709551615ULL, 1025));
+    assert(read->unfinishedIngest && read->unfinishedIngest->checksum == 99 && read->unfinishedIngest->source == "data/more.csv");
+    assert(read->committedRowCount == 120 && read->committedSegmentBytes == 4096);
+
+    // Saving again replaces the whole catalog
+    Catalog finished = *read;
+    finished.unfinishedIngest.reset();
+    finished.columns.pop_back();
+    finished.save(filepath);
+    read = Catalog::load(filepath);
+    assert(read && !read->unfinishedIngest && read->columns.size() == 1);
+
+    // Missing, of another version or cut short: there is no usable catalog
+    assert(!Catalog::load(testPath("no catalog")));
+    writeBytes(filepath, "catalog 2\nrows 5\n");
+    assert(!Catalog::load(filepath));
+    writeBytes(filepath, "rows 5\n");
+    assert(!Catalog::load(filepath));
+    writeBytes(filepath, "catalog 1\nrows five\n");
+    assert(!Catalog::load(filepath));
+
+    // Blank and unknown lines are skipped
+    writeBytes(filepath, "catalog 1\n\nnote written by a later version\nrows 5\n");
+    read = Catalog::load(filepath);
+    assert(read && read->rowCount == 5 && read->segmentBytes == 0 && read->columns.empty());
+}
+
+void testChecksum() {
+    string bytes;
+    for (int i = 0; i < 1000; i++) { bytes.push_back((char) (i * 31)); }
+    uint64_t whole = Catalog::checksum(bytes.data(), bytes.size());
+
+    // Summed in parts of multiples of 8 bytes, with the rest in the last part
+    uint64_t parts = Catalog::checksum(bytes.data(), 512);
+    parts = Catalog::checksum(bytes.data() + 512, 256, parts);
+    parts = Catalog::checksum(bytes.data() + 768, bytes.size() - 768, parts);
+    assert(parts == whole);
+
+    assert(Catalog::checksum(bytes.data(), 0) == Catalog::CHECKSUM_SEED);
+    string changed = bytes;
+    changed[999] ^= 1;
+    assert(Catalog::checksum(changed.data(), changed.size()) != whole);
+    assert(Catalog::checksum(bytes.data(), 999) != whole);
+}
+
+int main() {
+    testCatalog();
+    testChecksum();
+    filesystem::remove_all(filesystem::path(testPath("")).parent_path());
+    cout << "All catalog tests passed." << endl;
+    return 0;
+}
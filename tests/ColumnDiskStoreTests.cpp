@@ -0,0 +1,378 @@
+// ColumnDiskStoreTests.cpp
+//
+// Appends to the segment file of a disk store: batches of any size read back whole, the file only grows by what is
+// appended until it is compacted, and reopening the store finds the rows its catalog recorded. An ingest whose batches
+// cannot all be stored is not recorded as finished, and rolled back to the rows stored before it. Rows scattered over
+// many zones read back the same, their pages counted and kept by the BufferPool. Readers decode the strings of the segment they hold while batches add new ones.
+// The start of 1970 is a time, not a null.
+//
+// The stores define their classes in their .cpp files, which are included here.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -pthread -I. tests/ColumnDiskStoreTests.cpp AsyncReader.cpp BufferPool.cpp CalendarColumns.cpp Catalog.cpp ColumnFile.cpp MinMaxKernels.cpp PackedBlock.cpp Predicate.cpp RunBlock.cpp Segment.cpp Selection.cpp StringDictionary.cpp ThreadPool.cpp TimeFormat.cpp XorBlock.cpp ZoneMap.cpp -o column_disk_store_tests && ./column_disk_store_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ColumnStoreAbstract.cpp"
+#define COLUMNSTOREABSTRACT_H
+#include "ColumnDiskStore.cpp"
+
+using namespace std;
+
+const string STATIONS[] = {"Changi", "Paya Lebar", "M"};
+
+const int INTEGER = ColumnStoreAbstract::INTEGER_DATATYPE;
+const int STRING = ColumnStoreAbstract::STRING_DATATYPE;
+const int FLOAT = ColumnStoreAbstract::FLOAT_DATATYPE;
+
+const unordered_map<string, int> COLUMNS = {{"Id", INTEGER}, {"Station", STRING}, {"Reading", FLOAT}};
+
+// The values of row i: its index, one of STATIONS and half of its index, with nulls
+int32_t idOf(size_t row) { return row % 11 == 5 ? ColumnStoreAbstract::NULL_INTEGER : (int32_t) row; }
+string_view stationOf(size_t row) { return STATIONS[row / 1000 % 3]; }
+float readingOf(size_t row) { return row % 7 == 3 ? ColumnStoreAbstract::NULL_FLOAT : row * 0.5f; }
+
+// The rows [first, first + count) as a batch
+ColumnBatch batchOf(size_t first, size_t count) {
+    ColumnBatch batch;
+    batch.columns = {ColumnBatch::Column("Id", INTEGER), ColumnBatch::Column("Station", STRING), ColumnBatch::Column("Reading", FLOAT)};
+    for (size_t row = first; row < first + count; row++) {
+        batch.columns[0].integers.push_back(idOf(row));
+        batch.columns[1].strings.push_back(stationOf(row));
+        batch.columns[2].floats.push_back(readingOf(row));
+    }
+    batch.rowCount = count;
+    return batch;
+}
+
+// The store holds the rows [0, rowCount) and nothing else
+void checkRows(ColumnStoreDisk& store, size_t rowCount) {
+    assert(store.getRowCount() == rowCount);
+    Selection rows = Selection::range(0, rowCount);
+    vector<int32_t> ids(rowCount);
+    vector<string_view> stations(rowCount);
+    vector<float> readings(rowCount);
+    assert(store.getValues("Id", rows, ids.data()));
+    assert(store.getValues("Station", rows, stations.data()));
+    assert(store.getValues("Reading", rows, readings.data()));
+    for (size_t row = 0; row < rowCount; row++) {
+        assert(ids[row] == idOf(row) && stations[row] == stationOf(row));
+        assert(isnan(readingOf(row)) ? isnan(readings[row]) : readings[row] == readingOf(row));
+    }
+}
+
+// A CSV file of the rows [first, first + count), its readings with one decimal so that they are read back exactly
+void writeCSV(const string& filepath, size_t first, size_t count) {
+    ofstream outputStream(filepath, ios::trunc);
+    outputStream << "Id,Station,Reading\n";
+    for (size_t row = first; row < first + count; row++) {
+        if (idOf(row) == ColumnStoreAbstract::NULL_INTEGER) { outputStream << "M,"; }
+        else { outputStream << idOf(row) << ","; }
+        outputStream << stationOf(row) << ",";
+        if (isnan(readingOf(row))) { outputStream << "M\n"; }
+        else { outputStream << row / 2 << (row % 2 ? ".5" : ".0") << "\n"; }
+    }
+}
+
+// A store failing to store its batches once batchesLeft of them are stored, as if it ran out of space
+// Without rollBack, the failed ingest is left as it would be by a process stopped before it could roll it back
+// The size of the segment file the catalog records is kept after every batch stored
+class FailingStore : public ColumnStoreDisk {
+    public:
+        size_t batchesLeft;
+        bool rollBack;
+        vector<uint64_t> recordedBytes;
+
+        FailingStore(size_t batchesLeft, bool rollBack) : ColumnStoreDisk(COLUMNS), batchesLeft(batchesLeft), rollBack(rollBack) {}
+
+        void storeBatch(const ColumnBatch& batch) override {
+            if (batchesLeft == 0) { throw runtime_error("No space left on device"); }
+            batchesLeft--;
+            ColumnStoreDisk::storeBatch(batch);
+            recordedBytes.push_back(Catalog::load("disk/catalog")->segmentBytes);
+        }
+
+    protected:
+        void abortIngest(const string& filepath, const ColumnFile& file) override {
+            if (rollBack) { ColumnStoreDisk::abortIngest(filepath, file); }
+        }
+};
+
+// Runs in a directory of its own, the stores keep their files in "disk" under the working directory
+void enterTestDirectory() {
+    filesystem::path directory = filesystem::temp_directory_path() / "column_store_disk_store_tests";
+    filesystem::remove_all(directory);
+    filesystem::create_directories(directory);
+    filesystem::current_path(directory);
+}
+
+void testAppends() {
+    filesystem::remove_all("disk");
+
+    // Batches ending within a row group have it written again by the next one, batches of whole row groups do not
+    size_t rowCount = 0;
+    {
+        ColumnStoreDisk store(COLUMNS);
+        for (size_t count : vector<size_t>{1000, 1000, 3000, 1, ZoneMap::ZONE_ROWS - 904, 2 * ZoneMap::ZONE_ROWS, 5000, 7, 20000, 100}) {
+            store.storeBatch(batchOf(rowCount, count));
+            rowCount += count;
+            checkRows(store, rowCount);
+        }
+        for (size_t batch = 0; batch < 40; batch++) {
+            store.storeBatch(batchOf(rowCount, 333));
+            rowCount += 333;
+        }
+        checkRows(store, rowCount);
+    }
+
+    // The replaced chunks and footers never take up more bytes than the file written at once holds
+    uintmax_t appendedBytes = filesystem::file_size("disk/segment");
+    filesystem::rename("disk", "appended");
+    {
+        ColumnStoreDisk store(COLUMNS);
+        store.storeBatch(batchOf(0, rowCount));
+        checkRows(store, rowCount);
+    }
+    uintmax_t writtenAtOnceBytes = filesystem::file_size("disk/segment");
+    assert(appendedBytes <= 2 * writtenAtOnceBytes);
+    filesystem::remove_all("disk");
+    filesystem::rename("appended", "disk");
+
+    // Another store finds the rows again, and goes on appending to them
+    {
+        ColumnStoreDisk store(COLUMNS);
+        checkRows(store, rowCount);
+        store.storeBatch(batchOf(rowCount, 1234));
+        rowCount += 1234;
+        checkRows(store, rowCount);
+    }
+    ColumnStoreDisk store(COLUMNS);
+    checkRows(store, rowCount);
+    optional<Catalog> catalog = Catalog::load("disk/catalog");
+    assert(catalog && catalog->segmentBytes == filesystem::file_size("disk/segment"));
+}
+
+void testUnfinishedAppend() {
+    filesystem::remove_all("disk");
+    {
+        ColumnStoreDisk store(COLUMNS);
+        store.storeBatch(batchOf(0, 5000));
+    }
+    uintmax_t committedBytes = filesystem::file_size("disk/segment");
+
+    // Chunks written after the end of the file without a footer, as by an append cut short, are cut off again
+    {
+        ofstream outputStream("disk/segment", ios::app | ios::binary);
+        outputStream << string(10000, 'x');
+    }
+    {
+        ColumnStoreDisk store(COLUMNS);
+        checkRows(store, 5000);
+        assert(filesystem::file_size("disk/segment") == committedBytes);
+        store.storeBatch(batchOf(5000, 100));
+        checkRows(store, 5100);
+    }
+
+    // So is a whole append the catalog was not saved after
+    Catalog saved = *Catalog::load("disk/catalog");
+    {
+        ColumnStoreDisk store(COLUMNS);
+        store.storeBatch(batchOf(5100, 100));
+        checkRows(store, 5200);
+    }
+    saved.save("disk/catalog");
+    ColumnStoreDisk store(COLUMNS);
+    checkRows(store, 5100);
+}
+
+void testFailedIngest() {
+    filesystem::remove_all("disk");
+    {
+        ColumnStoreDisk store(COLUMNS);
+        store.storeBatch(batchOf(0, 2500));
+    }
+    uintmax_t committedBytes = filesystem::file_size("disk/segment");
+    writeCSV("rows.csv", 2500, 10000);
+
+    // A batch that cannot be stored stops the ingest, which is rolled back to the rows stored before it
+    {
+        FailingStore store(3, true);
+        store.addCSVData("rows.csv", 1000, 1);
+        checkRows(store, 2500);
+    }
+    optional<Catalog> catalog = Catalog::load("disk/catalog");
+    assert(catalog && catalog->ingests.empty() && !catalog->unfinishedIngest && catalog->rowCount == 2500);
+    assert(filesystem::file_size("disk/segment") == committedBytes);
+
+    // An ingest a process did not get to roll back is rolled back by the next store opening it
+    // Until then, the rows of its batches are read through the segment of the store, no footer locates them
+    {
+        FailingStore store(5, false);
+        store.addCSVData("rows.csv", 1000, 1);
+        checkRows(store, 7500);
+        assert(filesystem::file_size("disk/segment") > committedBytes);
+    }
+    catalog = Catalog::load("disk/catalog");
+    assert(catalog && catalog->unfinishedIngest && catalog->unfinishedIngest->source == "rows.csv");
+    assert(catalog->committedRowCount == 2500 && catalog->committedSegmentBytes == committedBytes);
+    {
+        ColumnStoreDisk store(COLUMNS);
+        checkRows(store, 2500);
+        assert(filesystem::file_size("disk/segment") == committedBytes);
+    }
+
+    // Once every batch is stored, the ingest is finished: the catalog only records the file then, ending with a single new footer
+    {
+        FailingStore store(10, true);
+        store.addCSVData("rows.csv", 1000, 1);
+        checkRows(store, 12500);
+        assert(store.recordedBytes == vector<uint64_t>(10, committedBytes));
+    }
+    catalog = Catalog::load("disk/catalog");
+    assert(catalog && !catalog->unfinishedIngest && catalog->ingests.size() == 1 && catalog->ingests[0].rowCount == 10000);
+    assert(catalog->segmentBytes == filesystem::file_size("disk/segment"));
+    {
+        ColumnStoreDisk store(COLUMNS);
+        checkRows(store, 12500);
+    }
+
+    // An ingest into an empty store rolls back to no segment file at all
+    filesystem::remove_all("disk");
+    {
+        FailingStore store(2, false);
+        store.addCSVData("rows.csv", 1000, 1);
+    }
+    ColumnStoreDisk store(COLUMNS);
+    assert(store.getRowCount() == 0 && !filesystem::exists("disk/segment"));
+}
+
+// Rows zones apart are read a zone at a time, in more reads than the AsyncReader keeps in flight, and decoded from the bytes read
+void testSparseReads() {
+    filesystem::remove_all("disk");
+    size_t zoneCount = 25 * AsyncReader::QUEUE_DEPTH;
+    size_t rowCount = zoneCount * ZoneMap::ZONE_ROWS;
+    {
+        ColumnStoreDisk store(COLUMNS);
+        store.storeBatch(batchOf(0, rowCount));
+    }
+
+    // Every tenth zone, too far apart for the reads to be coalesced, its first and last row
+    ColumnStoreDisk store(COLUMNS);
+    vector<int> indexes;
+    for (size_t zone = 0; zone < zoneCount; zone += 10) {
+        indexes.push_back(zone * ZoneMap::ZONE_ROWS);
+        indexes.push_back((zone + 1) * ZoneMap::ZONE_ROWS - 1);
+    }
+    Selection rows = Selection::of(indexes);
+    vector<int32_t> ids(indexes.size());
+    vector<string_view> stations(indexes.size());
+    vector<float> readings(indexes.size());
+    BufferPool::Statistics before = BufferPool::shared().statistics();
+    assert(store.getValues("Id", rows, ids.data()));
+
+    // The pages read go through the BufferPool: missed the first time, hit the next, and not pinned after
+    BufferPool::Statistics read = BufferPool::shared().statistics();
+    assert(read.misses > before.misses && read.pinnedPages == 0);
+    assert(store.getValues("Id", rows, ids.data()));
+    BufferPool::Statistics reread = BufferPool::shared().statistics();
+    assert(reread.misses == read.misses && reread.hits >= read.hits + indexes.size() / 2);
+    assert(store.getValues("Station", rows, stations.data()));
+    assert(store.getValues("Reading", rows, readings.data()));
+    for (size_t idx = 0; idx < indexes.size(); idx++) {
+        size_t row = indexes[idx];
+        assert(ids[idx] == idOf(row) && stations[idx] == stationOf(row));
+        assert(isnan(readingOf(row)) ? isnan(readings[idx]) : readings[idx] == readingOf(row));
+    }
+
+    // The zones are evaluated whole, then narrowed down to the rows
+    vector<int> changi, nullIds;
+    for (int row : indexes) {
+        if (stationOf(row) == "Changi") { changi.push_back(row); }
+        if (idOf(row) == ColumnStoreAbstract::NULL_INTEGER) { nullIds.push_back(row); }
+    }
+    assert(store.filter("Station", Predicate::equals("Changi"), rows) == Selection::of(changi));
+    assert(store.filter("Id", Predicate::isNull(), rows) == Selection::of(nullIds) && !nullIds.empty());
+    filesystem::remove_all("disk");
+}
+
+// Batches adding new stations while another thread decodes and filters the stations already stored
+// Every batch grows the dictionary, past the 256 codes of one byte, readers use the one of the segment they hold
+void testDictionarySnapshots() {
+    filesystem::remove_all("disk");
+    const size_t batchCount = 30, batchRows = 500;
+    auto stationAt = [](size_t row) { return "Station " + to_string(row / 20); };
+    ColumnStoreDisk store(COLUMNS);
+    atomic<bool> done{false};
+    thread reader([&]() {
+        while (!done) {
+            size_t count = store.getRowCount();
+            if (count == 0) { continue; }
+            size_t row = count - 1;
+            optional<Object> station = store.getValue("Station", (int) row);
+            assert(station && station->sval == stationAt(row));
+            Selection rows = store.filter("Station", Predicate::equals(stationAt(row)), Selection::range(0, count));
+            assert(rows.contains(row) && rows.cardinality() <= 20);
+        }
+    });
+    for (size_t batch = 0; batch < batchCount; batch++) {
+        ColumnBatch values = batchOf(batch * batchRows, batchRows);
+        vector<string> stations;
+        for (size_t row = batch * batchRows; row < (batch + 1) * batchRows; row++) { stations.push_back(stationAt(row)); }
+        values.columns[1].strings.assign(stations.begin(), stations.end());
+        store.storeBatch(values);
+    }
+    done = true;
+    reader.join();
+
+    vector<string_view> stations(batchCount * batchRows);
+    assert(store.getValues("Station", Selection::range(0, stations.size()), stations.data()));
+    for (size_t row = 0; row < stations.size(); row++) { assert(stations[row] == stationAt(row)); }
+    filesystem::remove_all("disk");
+}
+
+// The start of 1970 is 0 epoch seconds, stored and read back as a time like any other, nulls apart from it
+void testEpochStart() {
+    filesystem::remove_all("disk");
+    const int TIME = ColumnStoreAbstract::TIME_DATATYPE;
+    const int64_t NULL_TIME = ColumnStoreAbstract::NULL_TIME;
+    const unordered_map<string, int> timeColumns = {{"Timestamp", TIME}};
+    vector<int64_t> times = {0, NULL_TIME, 60, -1, 0};
+    {
+        ColumnStoreDisk store(timeColumns);
+        ColumnBatch batch;
+        batch.columns = {ColumnBatch::Column("Timestamp", TIME)};
+        batch.columns[0].times = times;
+        batch.rowCount = times.size();
+        store.storeBatch(batch);
+    }
+    ColumnStoreDisk store(timeColumns);
+    vector<int64_t> stored(times.size());
+    assert(store.getValues("Timestamp", Selection::range(0, times.size()), stored.data()) && stored == times);
+    optional<Object> epochStart = store.getValue("Timestamp", 0);
+    assert(epochStart && epochStart->tval == 0 && !store.getValue("Timestamp", 1));
+    assert(store.filter("Timestamp", Predicate::isNull()) == Selection::of({1}));
+    assert(store.filterYear("Timestamp", 1970) == Selection::of({0, 2, 4}));
+    filesystem::remove_all("disk");
+}
+
+int main() {
+    enterTestDirectory();
+    testAppends();
+    testUnfinishedAppend();
+    testFailedIngest();
+    testSparseReads();
+    testDictionarySnapshots();
+    testEpochStart();
+    filesystem::path directory = filesystem::current_path();
+    filesystem::current_path(directory.parent_path());
+    filesystem::remove_all(directory);
+    cout << "All disk store tests passed." << endl;
+    return 0;
+}
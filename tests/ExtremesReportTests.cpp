@@ -0,0 +1,125 @@
+// ExtremesReportTests.cpp
+//
+// The monthly extremes report on the main memory and disk stores: ExtremesReport::run() gives the outputs the report
+// gave when it filtered every month and read the rows getMax() and getMin() found in it, in the same order, one per
+// day of an extreme however many of its rows tie on that day, and none for the extremes of a month with only nulls.
+//
+// The stores define their classes in their .cpp files, which are included here, before the readings of tests/WeatherReadings.h.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -pthread -I. tests/ExtremesReportTests.cpp AsyncReader.cpp BufferPool.cpp CalendarColumns.cpp Catalog.cpp ColumnFile.cpp MinMaxKernels.cpp PackedBlock.cpp Predicate.cpp RunBlock.cpp Segment.cpp Selection.cpp StringDictionary.cpp ThreadPool.cpp TimeFormat.cpp XorBlock.cpp ZoneMap.cpp -o extremes_report_tests && ./extremes_report_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include "ColumnStoreAbstract.cpp"
+#define COLUMNSTOREABSTRACT_H
+#include "Output.cpp"
+#define OUTPUT_H
+#include "ColumnStoreMM.cpp"
+#include "ColumnDiskStore.cpp"
+#include "GroupBy.cpp"
+#include "ExtremesReport.cpp"
+#include "WeatherReadings.h"
+
+using namespace std;
+
+const int MAX_HUMIDITY = Output::MAX_HUMIDITY;
+const int MIN_HUMIDITY = Output::MIN_HUMIDITY;
+const int MAX_TEMP = Output::MAX_TEMP;
+const int MIN_TEMP = Output::MIN_TEMP;
+
+// The report as it was run before the pipeline: every month filtered on its own, then the timestamps and values of
+// the rows getMax() and getMin() find in it read for every category, keeping the first row of every day
+vector<Output> perMonthReport(ColumnStoreAbstract& store, int year, const string& station) {
+    vector<Output> result;
+    Selection rows = store.filter("Station", Predicate::equals(station), store.filterYear("Timestamp", year));
+    for (int month = 1; month <= 12; month++) {
+        Selection monthRows = store.filterMonth("Timestamp", year, month, rows);
+        if (monthRows.empty()) { continue; }
+        vector<pair<int, Selection>> extremes = {
+            {MAX_HUMIDITY, store.getMax("Humidity", monthRows)}, {MIN_HUMIDITY, store.getMin("Humidity", monthRows)},
+            {MAX_TEMP, store.getMax("Temperature", monthRows)}, {MIN_TEMP, store.getMin("Temperature", monthRows)}};
+        for (const pair<int, Selection>& extreme : extremes) {
+            string column = extreme.first == MAX_HUMIDITY || extreme.first == MIN_HUMIDITY ? "Humidity" : "Temperature";
+            size_t count = extreme.second.cardinality();
+            vector<int64_t> timestamps(count);
+            vector<float> values(count);
+            assert(store.getValues("Timestamp", extreme.second, timestamps.data()) && store.getValues(column, extreme.second, values.data()));
+            set<int64_t> addedDays;
+            for (size_t i = 0; i < count; i++) {
+                if (timestamps[i] == ColumnStoreAbstract::NULL_TIME) { continue; }
+                if (addedDays.insert(TimeFormat::daysFromEpoch(timestamps[i])).second) {
+                    result.push_back(Output((time_t) timestamps[i], station, extreme.first, values[i]));
+                }
+            }
+        }
+    }
+    return result;
+}
+
+void checkSameOutputs(const vector<Output>& outputs, const vector<Output>& expected) {
+    assert(outputs.size() == expected.size());
+    for (size_t i = 0; i < outputs.size(); i++) {
+        assert(outputs[i].date == expected[i].date && outputs[i].stationName == expected[i].stationName);
+        assert(outputs[i].type == expected[i].type && outputs[i].value == expected[i].value);
+    }
+}
+
+void testStore(ColumnStoreAbstract& store) {
+    store.storeBatch(readings());
+
+    for (const string& station : STATIONS) {
+        vector<Output> outputs = ExtremesReport::run(store, 2019, station);
+        checkSameOutputs(outputs, perMonthReport(store, 2019, station));
+
+        // The tied extremes of a month give one output on each of their days, never two on the same day
+        set<pair<int, int64_t>> days;
+        for (const Output& output : outputs) {
+            assert(days.insert({output.type, TimeFormat::daysFromEpoch(output.date)}).second);
+        }
+        assert(outputs.size() > (station == "Seletar" ? 4 : 11 * 4) * 5);
+    }
+
+    // No humidity in April and nothing in May: only the temperature of April is reported for those months of Changi
+    vector<Output> changi = ExtremesReport::run(store, 2019, "Changi");
+    set<int> aprilTypes;
+    for (const Output& output : changi) {
+        int year, month, day;
+        TimeFormat::civilFromDays(TimeFormat::daysFromEpoch(output.date), year, month, day);
+        assert(year == 2019 && month != 5 && month != 8);
+        if (month == 4) { aprilTypes.insert(output.type); }
+    }
+    assert(aprilTypes == set<int>({MAX_TEMP, MIN_TEMP}));
+
+    // A year or station without rows reports nothing
+    assert(ExtremesReport::run(store, 2018, "Changi").empty());
+    assert(ExtremesReport::run(store, 2019, "Jurong").empty());
+}
+
+int main() {
+    ThreadPool::setSharedWorkerCount(4); // so that the morsels of getMax() and getMin() run in parallel too
+    {
+        ColumnStoreMM store(COLUMNS);
+        testStore(store);
+    }
+
+    // The disk store keeps its files in "disk" under the working directory
+    filesystem::path directory = filesystem::temp_directory_path() / "column_store_extremes_report_tests";
+    filesystem::remove_all(directory);
+    filesystem::create_directories(directory);
+    filesystem::current_path(directory);
+    {
+        ColumnStoreDisk store(COLUMNS);
+        testStore(store);
+    }
+    filesystem::current_path(directory.parent_path());
+    filesystem::remove_all(directory);
+    cout << "All extremes report tests passed." << endl;
+    return 0;
+}
@@ -0,0 +1,140 @@
+// GroupByTests.cpp
+//
+// The one-pass GroupBy on the main memory and disk stores: the extremes of every group are the ones getMax() and
+// getMin() find in the rows of its month or day, ties and all, and months with only nulls have no extremes.
+//
+// The stores define their classes in their .cpp files, which are included here, before the readings of tests/WeatherReadings.h.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -pthread -I. tests/GroupByTests.cpp AsyncReader.cpp BufferPool.cpp CalendarColumns.cpp Catalog.cpp ColumnFile.cpp MinMaxKernels.cpp PackedBlock.cpp Predicate.cpp RunBlock.cpp Segment.cpp Selection.cpp StringDictionary.cpp ThreadPool.cpp TimeFormat.cpp XorBlock.cpp ZoneMap.cpp -o group_by_tests && ./group_by_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "ColumnStoreAbstract.cpp"
+#define COLUMNSTOREABSTRACT_H
+#include "ColumnStoreMM.cpp"
+#include "ColumnDiskStore.cpp"
+#include "GroupBy.cpp"
+#include "WeatherReadings.h"
+
+using namespace std;
+
+// The aggregate agrees with getMax() and getMin() over the rows, and with the values read from them
+void checkAggregate(ColumnStoreAbstract& store, const GroupBy::Aggregate& aggregate, const string& column, const Selection& rows) {
+    vector<float> values(rows.cardinality());
+    assert(store.getValues(column, rows, values.data()));
+    size_t count = 0;
+    for (float value : values) { count += !isnan(value); }
+    assert(aggregate.count == count);
+
+    assert(aggregate.maxRows == store.getMax(column, rows) && aggregate.minRows == store.getMin(column, rows));
+    if (count == 0) {
+        assert(aggregate.maxRows.empty() && aggregate.minRows.empty() && isnan(aggregate.avg()));
+        return;
+    }
+    vector<float> extremes(1);
+    assert(store.getValues(column, Selection::of({aggregate.maxRows.toVector().front()}), extremes.data()) && extremes[0] == aggregate.max);
+    assert(store.getValues(column, Selection::of({aggregate.minRows.toVector().front()}), extremes.data()) && extremes[0] == aggregate.min);
+}
+
+void testMonths(ColumnStoreAbstract& store) {
+    Selection changi = store.filter("Station", Predicate::equals("Changi"), store.filterYear("Timestamp", 2019));
+    vector<GroupBy::Group> months = GroupBy({GroupBy::Key::month("Timestamp")}, {"Humidity", "Temperature"}).run(store, changi);
+
+    // Every month with rows, in order, August has none
+    assert(months.size() == 11);
+    size_t group = 0;
+    for (int month = 1; month <= 12; month++) {
+        Selection monthRows = store.filterMonth("Timestamp", 2019, month, changi);
+        vector<int> expected; // across the morsels of the rows
+        changi.forEach([&](uint32_t row) {
+            if (timestampOf(row) != ColumnStoreAbstract::NULL_TIME && monthOf(row) == month) { expected.push_back(row); }
+        });
+        assert(monthRows == Selection::of(expected));
+        if (monthRows.empty()) {
+            assert(month == 8);
+            continue;
+        }
+        const GroupBy::Group& result = months[group++];
+        assert(result.key.size() == 1 && result.key[0].type == Object::INT && result.key[0].ival == month);
+        assert(result.rowCount == monthRows.cardinality());
+        checkAggregate(store, result.aggregates[0], "Humidity", monthRows);
+        checkAggregate(store, result.aggregates[1], "Temperature", monthRows);
+
+        // The humidity extremes are tied on several rows of the same days
+        if (month != 4 && month != 5) {
+            assert(result.aggregates[0].maxRows.cardinality() > 31 && result.aggregates[0].minRows.cardinality() > 31);
+        }
+    }
+    assert(months[3].aggregates[0].count == 0 && months[3].aggregates[1].count > 0);
+    assert(months[4].aggregates[0].count == 0 && months[4].aggregates[1].count == 0);
+
+    // A row without a timestamp belongs to no month
+    size_t grouped = 0, timestamped = 0;
+    for (const GroupBy::Group& month : months) { grouped += month.rowCount; }
+    for (size_t row = 0; row < ROW_COUNT; row++) { timestamped += stationOf(row) == "Changi" && timestampOf(row) != ColumnStoreAbstract::NULL_TIME; }
+    assert(grouped == timestamped && grouped == changi.cardinality());
+}
+
+void testStationsAndDays(ColumnStoreAbstract& store) {
+    // Every station and month of every row, sorted by station first
+    Selection all = Selection::range(0, ROW_COUNT);
+    vector<GroupBy::Group> groups = GroupBy({GroupBy::Key::value("Station"), GroupBy::Key::year("Timestamp"), GroupBy::Key::month("Timestamp")},
+        {"Humidity", "Temperature"}).run(store, all);
+    assert(groups.size() == 11 + 12 + 1);
+    for (size_t group = 0; group < groups.size(); group++) {
+        const vector<Object>& key = groups[group].key;
+        assert(key.size() == 3 && key[0].type == Object::STRING && key[1].ival == 2019);
+        assert(key[0].sval == (group < 11 ? "Changi" : group < 23 ? "Paya Lebar" : "Seletar"));
+        Selection rows = store.filterMonth("Timestamp", 2019, key[2].ival, store.filter("Station", Predicate::equals(key[0].sval)));
+        assert(groups[group].rowCount == rows.cardinality());
+        checkAggregate(store, groups[group].aggregates[0], "Humidity", rows);
+        checkAggregate(store, groups[group].aggregates[1], "Temperature", rows);
+    }
+
+    // Days repeat the extremes of their month, each day group finds them within the day only
+    Selection paya = store.filterMonth("Timestamp", 2019, 2, store.filter("Station", Predicate::equals("Paya Lebar")));
+    vector<GroupBy::Group> days = GroupBy({GroupBy::Key::date("Timestamp")}, {"Humidity", "Temperature"}).run(store, paya);
+    assert(days.size() == 28);
+    for (size_t day = 0; day < days.size(); day++) {
+        long long start = TimeFormat::toEpoch(2019, 2, (int) day + 1);
+        assert(days[day].key[0].type == Object::TIME && days[day].key[0].tval == start);
+        Selection rows = store.filter("Timestamp", Predicate::halfOpenRange(start, start + 86400), paya);
+        assert(days[day].rowCount == rows.cardinality() && rows.cardinality() >= 95);
+        checkAggregate(store, days[day].aggregates[0], "Humidity", rows);
+        checkAggregate(store, days[day].aggregates[1], "Temperature", rows);
+    }
+}
+
+void testStore(ColumnStoreAbstract& store) {
+    store.storeBatch(readings());
+    testMonths(store);
+    testStationsAndDays(store);
+}
+
+int main() {
+    ThreadPool::setSharedWorkerCount(4); // so that the morsels of getMax() and getMin() run in parallel too
+    {
+        ColumnStoreMM store(COLUMNS);
+        testStore(store);
+    }
+
+    // The disk store keeps its files in "disk" under the working directory
+    filesystem::path directory = filesystem::temp_directory_path() / "column_store_group_by_tests";
+    filesystem::remove_all(directory);
+    filesystem::create_directories(directory / "disk");
+    filesystem::current_path(directory);
+    {
+        ColumnStoreDisk store(COLUMNS);
+        testStore(store);
+    }
+    filesystem::current_path(directory.parent_path());
+    filesystem::remove_all(directory);
+    cout << "All group by tests passed." << endl;
+    return 0;
+}
@@ -0,0 +1,107 @@
+// MinMaxKernelsTests.cpp
+//
+// The vectorized MinMax kernels and their accumulators, checked against a plain scan of the same rows.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -I. tests/MinMaxKernelsTests.cpp MinMaxKernels.cpp Selection.cpp -o min_max_kernels_tests && ./min_max_kernels_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <climits>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+#include "Selection.h"
+#include "MinMaxKernels.h"
+
+using namespace std;
+
+// The MinMax of the rows of the values, scanned one at a time
+template <typename T>
+MinMax<T> expectedMinMax(const vector<T>& values, const Selection& rows, T null) {
+    MinMax<T> expected;
+    rows.forEach([&](uint32_t row) {
+        T value = values[row];
+        if (value == null || value != value) { return; } // NaN is the null of floats
+        if (!expected.found || value < expected.min) {
+            expected.min = value;
+            expected.minRows = Selection();
+        }
+        if (!expected.found || value > expected.max) {
+            expected.max = value;
+            expected.maxRows = Selection();
+        }
+        expected.found = true;
+        if (value == expected.min) { expected.minRows.add(row); }
+        if (value == expected.max) { expected.maxRows.add(row); }
+    });
+    return expected;
+}
+
+template <typename T>
+void checkMinMax(const MinMax<T>& actual, const MinMax<T>& expected) {
+    assert(actual.found == expected.found);
+    if (!expected.found) { return; }
+    assert(actual.min == expected.min && actual.max == expected.max);
+    assert(actual.minRows == expected.minRows && actual.maxRows == expected.maxRows);
+}
+
+void testMinMax() {
+    cout << "MinMax kernels: " << minMaxKernelName() << endl;
+    mt19937 random(7);
+    const int32_t nullInteger = INT_MIN;
+    const float nullFloat = numeric_limits<float>::quiet_NaN();
+
+    // Few distinct values, so that the extremes are held by many rows across blocks
+    vector<int32_t> integers(20000);
+    vector<float> floats(20000);
+    for (size_t i = 0; i < integers.size(); i++) {
+        integers[i] = i % 13 == 0 ? nullInteger : (int32_t) (random() % 50) - 25;
+        floats[i] = i % 17 == 0 ? nullFloat : (float) (random() % 40) / 4;
+    }
+    vector<Selection> selections = {Selection::range(0, 20000), Selection::range(3, 2049), Selection::of({1, 5, 19999}), Selection()};
+    Selection scattered;
+    for (uint32_t row = 0; row < 20000; row += 1 + random() % 9) { scattered.add(row); }
+    selections.push_back(scattered);
+    selections.push_back(scattered | Selection::range(4000, 9000));
+
+    for (const Selection& rows : selections) {
+        checkMinMax(minMax(integers.data(), rows), expectedMinMax(integers, rows, nullInteger));
+        checkMinMax(minMax(floats.data(), rows), expectedMinMax(floats, rows, nullFloat));
+    }
+
+    // Only nulls: nothing found
+    vector<int32_t> nulls(5000, nullInteger);
+    assert(!minMax(nulls.data(), Selection::range(0, 5000)).found);
+    vector<float> nanFloats(5000, nullFloat);
+    assert(!minMax(nanFloats.data(), Selection::range(0, 5000)).found);
+
+    // The extremes of the type are values like any other, INT_MIN being the null
+    vector<int32_t> extremes = {INT_MAX, INT_MIN + 1, INT_MIN, INT_MAX, INT_MIN + 1};
+    MinMax<int32_t> extremesMinMax = minMax(extremes.data(), Selection::range(0, 5));
+    assert(extremesMinMax.min == INT_MIN + 1 && extremesMinMax.minRows == Selection::of({1, 4}));
+    assert(extremesMinMax.max == INT_MAX && extremesMinMax.maxRows == Selection::of({0, 3}));
+
+    // Dense and gathered rows added to one accumulator, and partial scans merged in any order
+    MinMaxAccumulator<float> accumulator;
+    accumulator.addDense(floats.data() + 100, 5000, 100);
+    vector<uint32_t> gatheredRows = {7, 9000, 15000, 19999};
+    vector<float> gatheredValues;
+    for (uint32_t row : gatheredRows) { gatheredValues.push_back(floats[row]); }
+    accumulator.addGathered(gatheredValues.data(), gatheredRows.data(), gatheredRows.size());
+    Selection accumulated = Selection::range(100, 5100) | Selection::of({7, 9000, 15000, 19999});
+    checkMinMax(accumulator.result(), expectedMinMax(floats, accumulated, nullFloat));
+
+    MinMaxAccumulator<int32_t> merged;
+    merged.merge(minMax(integers.data(), Selection::range(10000, 20000)));
+    merged.merge(minMax(nulls.data(), Selection::range(0, 10)));
+    merged.merge(minMax(integers.data(), Selection::range(0, 10000)));
+    checkMinMax(merged.result(), expectedMinMax(integers, Selection::range(0, 20000), nullInteger));
+}
+
+int main() {
+    testMinMax();
+    cout << "All MinMax kernel tests passed." << endl;
+    return 0;
+}
@@ -0,0 +1,146 @@
+// MorselsTests.cpp
+//
+// Morsel-driven scans: the morsels cover the rows exactly once at MORSEL_ROWS boundaries, and their partial results
+// are merged in row order whichever morsel finishes first, keeping ties across morsels.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -pthread -I. tests/MorselsTests.cpp Selection.cpp MinMaxKernels.cpp ThreadPool.cpp -o morsels_tests && ./morsels_tests
+
+#undef NDEBUG
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Morsels.h"
+
+using namespace std;
+
+const uint32_t MORSEL_ROWS = Morsels::MORSEL_ROWS;
+
+// The morsels forEach() calls process with, by index, checking that each is called once
+vector<pair<uint32_t, uint32_t>> morselsOf(size_t rowCount) {
+    vector<pair<uint32_t, uint32_t>> morsels((rowCount + MORSEL_ROWS - 1) / MORSEL_ROWS, {1, 0});
+    mutex morselMutex;
+    Morsels::forEach(rowCount, [&](size_t morsel, uint32_t first, uint32_t end) {
+        lock_guard<mutex> lock(morselMutex);
+        assert(morsel < morsels.size() && morsels[morsel].first > morsels[morsel].second);
+        morsels[morsel] = {first, end};
+    });
+    return morsels;
+}
+
+void testBoundaries() {
+    assert(morselsOf(0).empty());
+    for (size_t rowCount : {(size_t) 1, (size_t) MORSEL_ROWS - 1, (size_t) MORSEL_ROWS, (size_t) MORSEL_ROWS + 1, (size_t) 5 * MORSEL_ROWS + 77}) {
+        vector<pair<uint32_t, uint32_t>> morsels = morselsOf(rowCount);
+        assert(morsels.size() == (rowCount + MORSEL_ROWS - 1) / MORSEL_ROWS);
+        for (size_t morsel = 0; morsel < morsels.size(); morsel++) {
+            assert(morsels[morsel].first == morsel * MORSEL_ROWS);
+            assert(morsels[morsel].second == min<size_t>(rowCount, (morsel + 1) * MORSEL_ROWS));
+        }
+    }
+
+    // The selected rows of a morsel are its slice of the selection, morsels without any are skipped
+    Selection rows;
+    rows.addRange(10, 20);
+    rows.addRange(MORSEL_ROWS - 3, MORSEL_ROWS + 3);
+    rows.add(4 * MORSEL_ROWS + 9);
+    vector<Selection> slices(5);
+    vector<int> calls(5);
+    mutex sliceMutex;
+    Morsels::forEach(rows, [&](size_t morsel, const Selection& slice) {
+        lock_guard<mutex> lock(sliceMutex);
+        slices[morsel] = slice;
+        calls[morsel]++;
+    });
+    assert(calls == vector<int>({1, 1, 0, 0, 1}));
+    assert(slices[0].cardinality() == 13 && slices[0].contains(MORSEL_ROWS - 1) && !slices[0].contains(MORSEL_ROWS));
+    assert(slices[1] == Selection::range(MORSEL_ROWS, MORSEL_ROWS + 3));
+    assert(slices[4].cardinality() == 1 && slices[4].contains(4 * MORSEL_ROWS + 9));
+    Selection merged;
+    for (Selection& slice : slices) { merged.append(move(slice)); }
+    assert(merged == rows);
+}
+
+void testMergeOrder() {
+    // The morsels of the front take longest, so they finish last, the rows still come back in order
+    size_t rowCount = 8 * MORSEL_ROWS + 100;
+    auto slowFirst = [](uint32_t first) { this_thread::sleep_for(chrono::milliseconds(first < 2 * MORSEL_ROWS ? 20 : 0)); };
+    auto selected = [](uint32_t row) { return row % 3 == 0 || row % 1000 < 5; };
+    Selection expected;
+    for (uint32_t row = 0; row < rowCount; row++) {
+        if (selected(row)) { expected.add(row); }
+    }
+
+    vector<size_t> finishOrder;
+    mutex orderMutex;
+    Selection filtered = Morsels::filter(rowCount, [&](uint32_t first, uint32_t end) {
+        slowFirst(first);
+        Selection matches;
+        for (uint32_t row = first; row < end; row++) {
+            if (selected(row)) { matches.add(row); }
+        }
+        lock_guard<mutex> lock(orderMutex);
+        finishOrder.push_back(first / MORSEL_ROWS);
+        return matches;
+    });
+    assert(filtered == expected && finishOrder.size() == 9);
+    assert(filtered.toVector() == expected.toVector());
+
+    // Filtering a selection keeps only the rows scan() returns, in order too
+    Selection rows = Selection::range(MORSEL_ROWS / 2, 6 * MORSEL_ROWS);
+    Selection refiltered = Morsels::filter(rows, [&](const Selection& slice) {
+        slowFirst(slice.toVector().front());
+        return slice & expected;
+    });
+    assert(refiltered == (rows & expected));
+
+    // No rows, no morsels
+    assert(Morsels::filter(0, [](uint32_t, uint32_t) -> Selection { assert(false); return Selection(); }).empty());
+}
+
+void testMinMax() {
+    // Extremes tied across morsel boundaries keep every row holding them, nulls never count
+    size_t rowCount = 4 * MORSEL_ROWS;
+    vector<int32_t> column(rowCount);
+    for (size_t row = 0; row < rowCount; row++) { column[row] = (int32_t) (row % 1000); }
+    for (uint32_t row : {MORSEL_ROWS - 1, MORSEL_ROWS, 3 * MORSEL_ROWS + 5}) { column[row] = 5000; }
+    for (uint32_t row : {(uint32_t) 7, 2 * MORSEL_ROWS + 1}) { column[row] = -5; }
+
+    Selection rows = Selection::range(0, rowCount);
+    MinMax<int32_t> result = Morsels::minMax(column.data(), rows);
+    assert(result.found && result.max == 5000 && result.min == -5);
+    assert(result.maxRows == Selection::of({(int) MORSEL_ROWS - 1, (int) MORSEL_ROWS, 3 * (int) MORSEL_ROWS + 5}));
+    assert(result.minRows == Selection::of({7, 2 * (int) MORSEL_ROWS + 1}));
+
+    // Only the selected rows count, morsels without any selected row are skipped
+    Selection some = Selection::range(MORSEL_ROWS + 1, 2 * MORSEL_ROWS);
+    some.add(3 * MORSEL_ROWS + 5);
+    result = Morsels::minMax(column.data(), some);
+    assert(result.max == 5000 && result.maxRows == Selection::of({3 * (int) MORSEL_ROWS + 5}));
+    assert(result.min == 0 && result.minRows.cardinality() == (MORSEL_ROWS - 1) / 1000 + 1);
+
+    // Floats agree with a scan of every row
+    vector<float> floats(rowCount);
+    for (size_t row = 0; row < rowCount; row++) { floats[row] = (row * 7919) % 10007 / 4.0f; }
+    MinMax<float> floatResult = Morsels::minMax(floats.data(), rows);
+    float expectedMax = 0;
+    Selection expectedMaxRows;
+    for (uint32_t row = 0; row < rowCount; row++) {
+        if (floats[row] > expectedMax) { expectedMax = floats[row]; expectedMaxRows = Selection(); }
+        if (floats[row] == expectedMax) { expectedMaxRows.add(row); }
+    }
+    assert(floatResult.max == expectedMax && floatResult.maxRows == expectedMaxRows && expectedMaxRows.cardinality() > 1);
+}
+
+int main() {
+    ThreadPool::setSharedWorkerCount(4); // so that the morsels run in parallel on machines with a single hardware thread too
+    testBoundaries();
+    testMergeOrder();
+    testMinMax();
+    cout << "All morsels tests passed." << endl;
+    return 0;
+}
@@ -0,0 +1,108 @@
+// PackedBlockTests.cpp
+//
+// Round trips, encodings and filters of the bit-packed blocks of INTEGER and TIME chunks, see PackedBlock.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -I. tests/PackedBlockTests.cpp PackedBlock.cpp Predicate.cpp Selection.cpp -o packed_block_tests && ./packed_block_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <climits>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "PackedBlock.h"
+
+using namespace std;
+
+// Encodes the values after a byte of padding, so that the block does not start aligned
+template <typename T>
+vector<char> packed(const vector<T>& values, T null) {
+    vector<char> block(1, 0);
+    PackedBlock::encode(values.data(), values.size(), null, block);
+    return block;
+}
+
+template <typename T>
+void checkPackedRoundTrip(const vector<T>& values, T null) {
+    vector<char> block = packed(values, null);
+    assert(PackedBlock::header(block.data() + 1).count == values.size());
+
+    vector<T> decoded(values.size());
+    PackedBlock::decode(block.data() + 1, null, decoded.data());
+    assert(decoded == values);
+    for (size_t i = 0; i < values.size(); i++) {
+        assert(PackedBlock::at(block.data() + 1, i, null) == values[i]);
+    }
+}
+
+// The rows the filter finds must be those the predicate matches one value at a time
+template <typename T>
+void checkPackedFilter(const vector<T>& values, T null, const Predicate& predicate) {
+    vector<char> block = packed(values, null);
+    Selection found;
+    PackedBlock::filter(block.data() + 1, null, 1000, predicate, found);
+
+    Selection expected;
+    for (size_t i = 0; i < values.size(); i++) {
+        if (predicate.matchesInteger(values[i], values[i] == null)) { expected.add(1000 + i); }
+    }
+    assert(found == expected);
+}
+
+void testPackedBlock() {
+    mt19937 random(5);
+    const int32_t nullInteger = INT_MIN;
+    const int64_t nullTime = 0;
+
+    // Small values with nulls are frame of reference encoded in a few bits
+    vector<int32_t> readings;
+    for (int i = 0; i < 4096; i++) { readings.push_back(i % 11 == 0 ? nullInteger : 20 + (int32_t) (random() % 15)); }
+    checkPackedRoundTrip(readings, nullInteger);
+    PackedBlock::Header header = PackedBlock::header(packed(readings, nullInteger).data() + 1);
+    assert(header.encoding == PackedBlock::FRAME_OF_REFERENCE && header.hasNulls && header.width <= 4);
+
+    // Timestamps every 30 minutes are delta encoded in no bits at all
+    vector<int64_t> timestamps;
+    for (int i = 0; i < 4096; i++) { timestamps.push_back(1577836800LL + i * 1800LL); }
+    checkPackedRoundTrip(timestamps, nullTime);
+    header = PackedBlock::header(packed(timestamps, nullTime).data() + 1);
+    assert(header.encoding == PackedBlock::DELTA && header.width == 0 && header.sorted);
+
+    // The full range of the type needs every bit
+    checkPackedRoundTrip(vector<int32_t>{INT_MIN + 1, INT_MAX, 0, -1, INT_MAX}, nullInteger);
+    checkPackedRoundTrip(vector<int64_t>{LLONG_MIN, LLONG_MAX, 1, -1}, nullTime);
+    checkPackedRoundTrip(vector<int64_t>{LLONG_MIN, nullTime, LLONG_MAX}, nullTime);
+    assert(PackedBlock::header(packed(vector<int64_t>{LLONG_MIN, nullTime, LLONG_MAX}, nullTime).data() + 1).width == 64);
+
+    // A block of one value, of equal values and of only nulls
+    checkPackedRoundTrip(vector<int32_t>{42}, nullInteger);
+    checkPackedRoundTrip(vector<int32_t>(100, 7), nullInteger);
+    checkPackedRoundTrip(vector<int32_t>(100, nullInteger), nullInteger);
+    checkPackedRoundTrip(vector<int64_t>(3, nullTime), nullTime);
+
+    // An empty block only holds its header
+    vector<char> empty;
+    PackedBlock::encode((const int32_t*) nullptr, 0, nullInteger, empty);
+    assert(PackedBlock::header(empty.data()).count == 0);
+
+    // Predicates evaluated on the packed values, on the sorted values and on the decoded values
+    vector<Predicate> predicates = {
+        Predicate::equals(25), Predicate::between(22, 27), Predicate::halfOpenRange(22, 27), Predicate::greaterThan(33),
+        Predicate::atMost(20), Predicate::lessThan(INT_MIN + 1), Predicate::between(30, 20), Predicate::notEquals(25),
+        Predicate::isNull(), Predicate::in({21, 23}), !Predicate::isNull()
+    };
+    for (const Predicate& predicate : predicates) {
+        checkPackedFilter(readings, nullInteger, predicate);
+    }
+    for (const Predicate& predicate : {Predicate::halfOpenRange(1578000000LL, 1579000000LL), Predicate::equals(1577836800LL),
+                                       Predicate::greaterThan(LLONG_MAX), Predicate::atLeast(LLONG_MIN)}) {
+        checkPackedFilter(timestamps, nullTime, predicate);
+    }
+}
+
+int main() {
+    testPackedBlock();
+    cout << "All packed block tests passed." << endl;
+    return 0;
+}
@@ -0,0 +1,165 @@
+// PredicateTests.cpp
+//
+// Binding predicates to the values of a column: literals given as text or as numbers of another type
+// compare the way the values of the column are stored, and the zone maps and packed blocks skipping
+// values agree with a value-by-value evaluation of the bound predicate.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -I. tests/PredicateTests.cpp Predicate.cpp Selection.cpp ZoneMap.cpp PackedBlock.cpp -o predicate_tests && ./predicate_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "Predicate.h"
+#include "Selection.h"
+#include "ZoneMap.h"
+#include "PackedBlock.h"
+
+using namespace std;
+
+// The rows of the values matching the bound predicate, one value at a time
+Selection integerMatches(const vector<int32_t>& values, const Predicate& bound) {
+    Selection rows;
+    for (size_t i = 0; i < values.size(); i++) {
+        if (bound.matchesInteger(values[i], values[i] == INT_MIN)) { rows.add(i); }
+    }
+    return rows;
+}
+
+// The rows of the values the packed blocks of a zone each select
+Selection packedMatches(const vector<int32_t>& values, const Predicate& bound) {
+    Selection rows;
+    for (size_t first = 0; first < values.size(); first += ZoneMap::ZONE_ROWS) {
+        size_t count = min<size_t>(ZoneMap::ZONE_ROWS, values.size() - first);
+        vector<char> block;
+        PackedBlock::encode(values.data() + first, count, (int32_t) INT_MIN, block);
+        PackedBlock::filter(block.data(), (int32_t) INT_MIN, first, bound, rows);
+    }
+    return rows;
+}
+
+// Every way of evaluating the predicate on an INTEGER column holding the values selects the same rows
+size_t countIntegerMatches(const vector<int32_t>& values, const Predicate& predicate) {
+    Predicate bound = predicate.bind(Predicate::INTEGER_VALUES);
+    Selection expected = integerMatches(values, bound);
+    assert(packedMatches(values, bound) == expected);
+
+    ZoneMap zoneMap;
+    for (int32_t value : values) {
+        if (value == INT_MIN) { zoneMap.addNull(); }
+        else { zoneMap.addValue(value); }
+    }
+    assert((zoneMap.candidateRows(bound) & expected) == expected);
+    return expected.cardinality();
+}
+
+void testIntegerBinding() {
+    // 0..19999 in order (so that the packed blocks are binary searched), and shuffled with nulls
+    vector<int32_t> sorted(20000), scattered(20000);
+    for (int32_t i = 0; i < 20000; i++) {
+        sorted[i] = i;
+        scattered[i] = i % 11 == 0 ? INT_MIN : (i * 7919) % 20000;
+    }
+
+    // Fractional bounds admit the integers on their side only, however inclusive
+    assert(countIntegerMatches(sorted, Predicate::atLeast(2.5)) == 19997);
+    assert(countIntegerMatches(sorted, Predicate::greaterThan(2.5)) == 19997);
+    assert(countIntegerMatches(sorted, Predicate::atMost(2.5)) == 3);
+    assert(countIntegerMatches(sorted, Predicate::lessThan(2.5)) == 3);
+    assert(countIntegerMatches(sorted, Predicate::between(-0.5, 9.99)) == 10);
+    assert(countIntegerMatches(sorted, Predicate::halfOpenRange(2.5, 3.5)) == 1);
+    assert(countIntegerMatches(sorted, Predicate::between(2.2, 2.8)) == 0);
+    assert(countIntegerMatches(sorted, Predicate::atLeast(-2.5)) == 20000);
+    assert(countIntegerMatches(sorted, Predicate::atLeast(1e30)) == 0);
+    assert(countIntegerMatches(sorted, Predicate::atMost(1e30)) == 20000);
+    assert(countIntegerMatches(sorted, Predicate::atLeast(numeric_limits<double>::quiet_NaN())) == 0);
+
+    // A fraction equals no integer
+    assert(countIntegerMatches(sorted, Predicate::equals(2.5)) == 0);
+    assert(countIntegerMatches(sorted, Predicate::equals(2.0)) == 1);
+    assert(countIntegerMatches(sorted, Predicate::notEquals(2.5)) == 20000);
+    assert(countIntegerMatches(sorted, Predicate::in({2.5, 3, 4.0})) == 2);
+    assert(countIntegerMatches(sorted, !Predicate::equals(2.5)) == 20000);
+
+    // Whole reals, integers and text compare alike
+    assert(countIntegerMatches(sorted, Predicate::atLeast(19990.0)) == 10);
+    assert(countIntegerMatches(sorted, Predicate::atLeast(19990)) == 10);
+    assert(countIntegerMatches(sorted, Predicate::atLeast("19990")) == 10);
+
+    // Nulls only match isNull(), also once the fractions are rounded
+    size_t nulls = 0;
+    for (int32_t value : scattered) { nulls += value == INT_MIN; }
+    assert(countIntegerMatches(scattered, Predicate::notEquals(2.5)) == scattered.size() - nulls);
+    assert(countIntegerMatches(scattered, !Predicate::equals(2.5)) == scattered.size());
+    assert(countIntegerMatches(scattered, Predicate::isNull() || Predicate::equals(2.5)) == nulls);
+    assert(countIntegerMatches(scattered, Predicate::between(99.5, 200.5) && !Predicate::equals(150.5))
+        == countIntegerMatches(scattered, Predicate::between(100, 200)));
+
+    // Text that is not an integer cannot be bound
+    bool thrown = false;
+    try {
+        Predicate::equals("2.5").bind(Predicate::INTEGER_VALUES);
+    } catch (invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void testRealBinding() {
+    // FLOAT values are stored as floats and compared as doubles
+    vector<float> values = {23.1f, 23.2f, 0.1f, -4.75f, 23.1f, numeric_limits<float>::quiet_NaN(), 1e-3f};
+    auto count = [&values](const Predicate& predicate) {
+        Predicate bound = predicate.bind(Predicate::REAL_VALUES);
+        size_t matches = 0;
+        for (float value : values) { matches += bound.matchesFloat(value, isnan(value)); }
+        return matches;
+    };
+
+    // Text and double literals are the float the column would store for them
+    assert(count(Predicate::equals("23.1")) == 2);
+    assert(count(Predicate::equals(23.1)) == 2);
+    assert(count(Predicate::equals(23.1f)) == 2);
+    assert(count(Predicate::in({"0.1", 0.001})) == 2);
+    assert(count(Predicate::notEquals("23.1")) == 4);
+    assert(count(Predicate::greaterThan("23.1")) == 1);
+    assert(count(Predicate::atLeast("23.1")) == 3);
+    assert(count(Predicate::lessThan(23.1)) == 3);
+    assert(count(Predicate::between("-4.75", "0.1")) == 3);
+    assert(count(Predicate::equals("-4.75")) == 1);
+
+    // So do the statistics of a zone of those values
+    ZoneMap zoneMap;
+    zoneMap.addValue(23.1f);
+    zoneMap.addValue(23.2f);
+    assert(zoneMap.mayMatch(0, Predicate::equals("23.1").bind(Predicate::REAL_VALUES)));
+    assert(zoneMap.mayMatch(0, Predicate::atMost(23.1).bind(Predicate::REAL_VALUES)));
+    assert(!zoneMap.mayMatch(0, Predicate::greaterThan("23.2").bind(Predicate::REAL_VALUES)));
+
+    bool thrown = false;
+    try {
+        Predicate::equals("23,1").bind(Predicate::REAL_VALUES);
+    } catch (invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void testTextBinding() {
+    // STRING columns compare against the text of a literal, whatever its type
+    Predicate bound = Predicate::in({"Changi", 7}).bind(Predicate::TEXT_VALUES);
+    assert(bound.matchesString("Changi", false) && bound.matchesString("7", false));
+    assert(!bound.matchesString("Paya Lebar", false) && !bound.matchesString("M", true));
+}
+
+int main() {
+    testIntegerBinding();
+    testRealBinding();
+    testTextBinding();
+    cout << "All predicate tests passed." << endl;
+    return 0;
+}
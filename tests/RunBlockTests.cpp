@@ -0,0 +1,94 @@
+// RunBlockTests.cpp
+//
+// Round trips, encodings and runs of the run-length encoded blocks of STRING codes, and calendar runs, see RunBlock.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -I. tests/RunBlockTests.cpp RunBlock.cpp StringDictionary.cpp Predicate.cpp -o run_block_tests && ./run_block_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "RunBlock.h"
+
+using namespace std;
+
+// Returns the encoding the block was written in
+RunBlock::Encoding checkRunRoundTrip(const vector<uint32_t>& values) {
+    vector<char> block(1, 0);
+    RunBlock::encode(values.data(), values.size(), block);
+    RunBlock::Header header = RunBlock::header(block.data() + 1);
+    assert(header.count == values.size());
+
+    vector<uint32_t> decoded(values.size());
+    RunBlock::decode(block.data() + 1, decoded.data());
+    assert(decoded == values);
+    for (size_t i = 0; i < values.size(); i++) {
+        assert(RunBlock::at(block.data() + 1, i) == values[i]);
+    }
+
+    // The runs cover every row once, in order, and neighbouring runs hold different values
+    uint32_t next = 0;
+    bool first = true;
+    uint32_t previous = 0;
+    RunBlock::forEachRun(block.data() + 1, [&](uint32_t start, uint32_t end, uint32_t value) {
+        assert(start == next && end > start && (first || value != previous));
+        for (uint32_t row = start; row < end; row++) { assert(values[row] == value); }
+        next = end;
+        previous = value;
+        first = false;
+    });
+    assert(next == values.size());
+    return (RunBlock::Encoding) header.encoding;
+}
+
+void testRunBlock() {
+    mt19937 random(17);
+
+    // A station code repeated for long stretches is kept as runs
+    vector<uint32_t> stations;
+    for (int i = 0; i < 4096; i++) { stations.push_back(1 + i / 1000); }
+    assert(checkRunRoundTrip(stations) == RunBlock::RUNS);
+
+    // Values changing every row are kept as values, in the fewest bytes that hold the largest one
+    for (uint32_t largest : {200u, 60000u, 4000000000u}) {
+        vector<uint32_t> values;
+        for (int i = 0; i < 1000; i++) { values.push_back(random() % largest); }
+        values[500] = largest;
+        assert(checkRunRoundTrip(values) == RunBlock::VALUES);
+
+        vector<char> block;
+        RunBlock::encode(values.data(), values.size(), block);
+        assert(RunBlock::header(block.data()).width == (largest <= 0xFF ? 1 : largest <= 0xFFFF ? 2 : 4));
+    }
+
+    checkRunRoundTrip({0});
+    checkRunRoundTrip({5, 5, 6, 6, 6, 5});
+
+    vector<char> empty;
+    RunBlock::encode(nullptr, 0, empty);
+    assert(RunBlock::header(empty.data()).count == 0);
+    RunBlock::forEachRun(empty.data(), [](uint32_t, uint32_t, uint32_t) { assert(false); });
+
+    // Runs appended in several calls extend the last run when it goes on
+    vector<RunBlock::Run> runs;
+    vector<int16_t> years = {2020, 2020, 2021};
+    RunBlock::appendRuns(runs, years.data(), years.size(), 0);
+    vector<int16_t> more = {2021, 2021, 2022};
+    RunBlock::appendRuns(runs, more.data(), more.size(), 3);
+    assert(runs.size() == 3);
+    assert(runs[0].value == 2020 && runs[0].end == 2);
+    assert(runs[1].value == 2021 && runs[1].end == 5);
+    assert(runs[2].value == 2022 && runs[2].end == 6);
+
+    // A gap between the calls starts a new run even for the same value
+    RunBlock::appendRuns(runs, more.data() + 2, 1, 10);
+    assert(runs.size() == 4 && runs[3].end == 11);
+}
+
+int main() {
+    testRunBlock();
+    cout << "All run block tests passed." << endl;
+    return 0;
+}
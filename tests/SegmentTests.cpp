@@ -0,0 +1,297 @@
+// SegmentTests.cpp
+//
+// Round trips and edge cases of the footer of the Segment file a disk store keeps its columns in, also once appended to.
+// Zones whose rows or blocks do not match what the footer says are corrupt.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -I. tests/SegmentTests.cpp Segment.cpp ColumnFile.cpp PackedBlock.cpp Predicate.cpp RunBlock.cpp Selection.cpp StringDictionary.cpp XorBlock.cpp ZoneMap.cpp -o segment_tests && ./segment_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "PackedBlock.h"
+#include "Segment.h"
+#include "XorBlock.h"
+
+using namespace std;
+
+// A file in a directory of its own, removed once the tests are done
+string testPath(const string& name) {
+    static const filesystem::path directory = filesystem::temp_directory_path() / "column_store_segment_tests";
+    filesystem::create_directories(directory);
+    return (directory / name).string();
+}
+
+void writeBytes(const string& filepath, const string& bytes) {
+    ofstream outputStream(filepath, ios::binary | ios::trunc);
+    outputStream.write(bytes.data(), bytes.size());
+}
+
+// Writes a segment file of the row groups followed by the footer of the segment
+void writeSegment(const string& filepath, const Segment& segment, const string& rowGroups) {
+    ofstream outputStream(filepath, ios::binary | ios::trunc);
+    uint32_t magic = Segment::MAGIC;
+    outputStream.write((const char*) &magic, sizeof(magic));
+    outputStream << rowGroups;
+    segment.writeFooter(outputStream);
+}
+
+// Appends the block to the row groups, located by the last zone of the zone map
+void addBlock(string& rowGroups, ZoneMap& zoneMap, const vector<char>& block, Segment::Encoding encoding) {
+    zoneMap.setLastBlock(sizeof(Segment::MAGIC) + rowGroups.size(), block.size(), encoding);
+    rowGroups.append(block.data(), block.size());
+}
+
+// The bytes of 16 RAW floats, enough for a zone of up to 4 rows
+const string RAW_FLOATS(16, 'x');
+
+bool throwsRuntimeError(const string& filepath) {
+    try {
+        Segment::open(filepath);
+    } catch (runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void testSegmentFooter() {
+    Segment written;
+    string rowGroups;
+    Segment::Column temperature;
+    temperature.name = "Temperature";
+    temperature.dataType = 2;
+    vector<float> values;
+    for (int i = 0; i < 5000; i++) {
+        if (i % 10 == 0) { temperature.zoneMap.addNull(); }
+        else { temperature.zoneMap.addValue(20 + i % 7); }
+        values.push_back(i % 10 == 0 ? numeric_limits<float>::quiet_NaN() : 20 + i % 7);
+        if (values.size() == ZoneMap::ZONE_ROWS) { // the first zone XOR encoded, the second stored RAW
+            vector<char> block;
+            XorBlock::encode(values.data(), values.size(), block);
+            addBlock(rowGroups, temperature.zoneMap, block, Segment::XOR);
+            values.clear();
+        }
+    }
+    addBlock(rowGroups, temperature.zoneMap, vector<char>((char*) values.data(), (char*) (values.data() + values.size())), Segment::RAW);
+    written.columns.push_back(temperature);
+
+    Segment::Column station;
+    station.name = "Station name with spaces";
+    station.dataType = 0;
+    station.zoneMap.addUnknown();
+    uint32_t code = 1;
+    vector<char> codes;
+    RunBlock::encode(&code, 1, codes);
+    addBlock(rowGroups, station.zoneMap, codes, Segment::RUNS);
+    station.dictionary = {"M", "Changi", "", "Paya Lebar"};
+    written.columns.push_back(station);
+
+    Segment::Column timestamp;
+    timestamp.name = "Timestamp";
+    timestamp.dataType = 3;
+    timestamp.years = {{2019, 3}, {2020, 10}};
+    timestamp.months = {{12, 3}, {1, 10}};
+    timestamp.days = {{31, 3}, {1, 10}};
+    written.columns.push_back(timestamp);
+
+    string filepath = testPath("segment");
+    writeSegment(filepath, written, rowGroups);
+    Segment read = Segment::open(filepath);
+
+    assert(read.file && read.footerOffset == sizeof(Segment::MAGIC) + rowGroups.size());
+    assert(read.columns.size() == 3 && read.rowGroupCount() == 2);
+    const Segment::Column* readTemperature = read.column("Temperature");
+    assert(readTemperature && readTemperature->dataType == 2 && readTemperature->zoneMap.rowCount == 5000);
+    for (size_t zone = 0; zone < 2; zone++) {
+        const ZoneMap::Zone& expected = temperature.zoneMap.zones[zone];
+        const ZoneMap::Zone& actual = readTemperature->zoneMap.zones[zone];
+        assert(actual.min == expected.min && actual.max == expected.max);
+        assert(actual.nullCount == expected.nullCount && actual.rowCount == expected.rowCount);
+        assert(actual.byteOffset == expected.byteOffset && actual.byteLength == expected.byteLength && actual.encoding == expected.encoding);
+    }
+
+    // Zones without statistics keep their infinite bounds
+    const Segment::Column* readStation = read.column("Station name with spaces");
+    assert(readStation && readStation->dictionary == station.dictionary);
+    assert(readStation->zoneMap.zones[0].min == -numeric_limits<double>::infinity());
+    assert(readStation->zoneMap.zones[0].max == numeric_limits<double>::infinity());
+
+    const Segment::Column* readTimestamp = read.column("Timestamp");
+    assert(readTimestamp && readTimestamp->zoneMap.empty() && readTimestamp->years.size() == 2);
+    assert(readTimestamp->years[1].value == 2020 && readTimestamp->years[1].end == 10);
+    assert(readTimestamp->months[0].value == 12 && readTimestamp->days[1].end == 10);
+    assert(!read.column("Humidity"));
+
+    // A segment without columns, as written by a store before its first rows
+    writeSegment(filepath, Segment(), "");
+    Segment empty = Segment::open(filepath);
+    assert(empty.file && empty.columns.empty() && empty.rowGroupCount() == 0);
+
+    // No file at all is a segment without columns and without a file
+    Segment missing = Segment::open(testPath("missing"));
+    assert(!missing.file && missing.columns.empty());
+}
+
+void testCorruptSegments() {
+    Segment segment;
+    Segment::Column column;
+    column.name = "Humidity";
+    column.dataType = 2;
+    column.zoneMap.addValue(80);
+    column.zoneMap.setLastBlock(4, 16, Segment::RAW);
+    segment.columns.push_back(column);
+    string filepath = testPath("corrupt");
+    writeSegment(filepath, segment, RAW_FLOATS);
+    string bytes;
+    {
+        ifstream inputStream(filepath, ios::binary);
+        bytes.assign(istreambuf_iterator<char>(inputStream), istreambuf_iterator<char>());
+    }
+    assert(!throwsRuntimeError(filepath));
+
+    // Too short to be a segment file, or without MAGIC at either end
+    writeBytes(filepath, bytes.substr(0, 6));
+    assert(throwsRuntimeError(filepath));
+    writeBytes(filepath, "XXXX" + bytes.substr(4));
+    assert(throwsRuntimeError(filepath));
+    writeBytes(filepath, bytes.substr(0, bytes.size() - 1) + "X");
+    assert(throwsRuntimeError(filepath));
+
+    // Cut short, so that the footer length points before the start of the file
+    writeBytes(filepath, bytes.substr(0, 4) + bytes.substr(bytes.size() - 12));
+    assert(throwsRuntimeError(filepath));
+
+    // A zone pointing past the row groups
+    Segment pastEnd = segment;
+    pastEnd.columns[0].zoneMap.zones[0].byteLength = 1000;
+    writeSegment(filepath, pastEnd, RAW_FLOATS);
+    assert(throwsRuntimeError(filepath));
+
+    // More rows than a zone holds, or more than its block holds
+    Segment tooLong = segment;
+    tooLong.columns[0].zoneMap.zones[0].rowCount = ZoneMap::ZONE_ROWS + 1;
+    writeSegment(filepath, tooLong, string((ZoneMap::ZONE_ROWS + 1) * sizeof(float), 'x'));
+    assert(throwsRuntimeError(filepath));
+    tooLong.columns[0].zoneMap.zones[0].rowCount = 5;
+    writeSegment(filepath, tooLong, RAW_FLOATS);
+    assert(throwsRuntimeError(filepath));
+
+    // A short zone before the last one
+    Segment shortZone = segment;
+    shortZone.columns[0].zoneMap.addZone(segment.columns[0].zoneMap.zones[0]);
+    writeSegment(filepath, shortZone, RAW_FLOATS);
+    assert(throwsRuntimeError(filepath));
+
+    // A block counting other rows than its zone, and one in an encoding of another data type
+    Segment::Column id;
+    id.name = "Id";
+    id.dataType = 1;
+    string rowGroups;
+    vector<int32_t> ids = {1, 2, 3};
+    for (int32_t value : ids) { id.zoneMap.addValue(value); }
+    vector<char> block;
+    PackedBlock::encode(ids.data(), ids.size(), numeric_limits<int32_t>::min(), block);
+    addBlock(rowGroups, id.zoneMap, block, Segment::PACKED);
+    Segment packed;
+    packed.columns.push_back(id);
+    writeSegment(filepath, packed, rowGroups);
+    assert(!throwsRuntimeError(filepath));
+    packed.columns[0].zoneMap.zones[0].rowCount = 2;
+    writeSegment(filepath, packed, rowGroups);
+    assert(throwsRuntimeError(filepath));
+    packed.columns[0].zoneMap.zones[0].rowCount = 3;
+    packed.columns[0].dataType = 2;
+    writeSegment(filepath, packed, rowGroups);
+    assert(throwsRuntimeError(filepath));
+
+    // Runs of codes ending before the end of their zone
+    Segment::Column station;
+    station.name = "Station";
+    station.dataType = 0;
+    vector<uint32_t> codes(100, 7);
+    for (size_t row = 0; row < codes.size(); row++) { station.zoneMap.addUnknown(); }
+    block.clear();
+    RunBlock::encode(codes.data(), codes.size(), block);
+    assert(RunBlock::header(block.data()).encoding == RunBlock::RUNS);
+    rowGroups.clear();
+    addBlock(rowGroups, station.zoneMap, block, Segment::RUNS);
+    Segment runs;
+    runs.columns.push_back(station);
+    writeSegment(filepath, runs, rowGroups);
+    assert(!throwsRuntimeError(filepath));
+    RunBlock::Run run = {7, 99};
+    memcpy(&rowGroups[sizeof(RunBlock::Header)], &run, sizeof(run));
+    writeSegment(filepath, runs, rowGroups);
+    assert(throwsRuntimeError(filepath));
+
+    // Another version of the format
+    string otherVersion = bytes;
+    size_t footerOffset = 4 + 16;
+    otherVersion[footerOffset] = (char) (Segment::VERSION + 1);
+    writeBytes(filepath, otherVersion);
+    assert(throwsRuntimeError(filepath));
+
+    // A dictionary entry running past the end of the footer
+    Segment longEntry = segment;
+    longEntry.columns[0].dictionary = {"Changi"};
+    writeSegment(filepath, longEntry, RAW_FLOATS);
+    {
+        ifstream inputStream(filepath, ios::binary);
+        bytes.assign(istreambuf_iterator<char>(inputStream), istreambuf_iterator<char>());
+    }
+    size_t lengthAt = bytes.find("Changi") - sizeof(uint32_t);
+    uint32_t length = 1 << 30;
+    memcpy(&bytes[lengthAt], &length, sizeof(length));
+    writeBytes(filepath, bytes);
+    assert(throwsRuntimeError(filepath));
+}
+
+// Appends write their chunks and a new footer after the end of the file, the footer at the end is the one read
+void testAppendedFooter() {
+    Segment first;
+    Segment::Column column;
+    column.name = "Rainfall";
+    column.dataType = 2;
+    column.zoneMap.addValue(1);
+    column.zoneMap.setLastBlock(4, 16, Segment::RAW);
+    first.columns.push_back(column);
+    string filepath = testPath("appended");
+    writeSegment(filepath, first, RAW_FLOATS);
+    size_t firstBytes = filesystem::file_size(filepath);
+
+    // The chunk is replaced by one written after the first footer, together with more rows
+    Segment second = first;
+    second.columns[0].zoneMap.removeLastZone();
+    for (int i = 0; i < 5; i++) { second.columns[0].zoneMap.addValue(2 + i); }
+    second.columns[0].zoneMap.setLastBlock(firstBytes, 20, Segment::RAW);
+    {
+        ofstream outputStream(filepath, ios::binary | ios::app);
+        outputStream << string(20, 'y');
+        second.writeFooter(outputStream);
+    }
+    Segment read = Segment::open(filepath);
+    assert(read.footerOffset == firstBytes + 20 && read.rowGroupCount() == 1);
+    const ZoneMap& zoneMap = read.column("Rainfall")->zoneMap;
+    assert(zoneMap.rowCount == 5 && zoneMap.zones[0].byteOffset == firstBytes && zoneMap.zones[0].min == 2 && zoneMap.zones[0].max == 6);
+
+    // Cut back to the first footer, the file is the segment it was
+    filesystem::resize_file(filepath, firstBytes);
+    read = Segment::open(filepath);
+    assert(read.column("Rainfall")->zoneMap.rowCount == 1 && read.column("Rainfall")->zoneMap.zones[0].min == 1);
+}
+
+int main() {
+    testSegmentFooter();
+    testCorruptSegments();
+    testAppendedFooter();
+    filesystem::remove_all(filesystem::path(testPath("")).parent_path());
+    cout << "All segment tests passed." << endl;
+    return 0;
+}
@@ -0,0 +1,169 @@
+// SelectionTests.cpp
+//
+// The compressed Selection passed between the stages of a query, checked against the set of rows it should hold.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -I. tests/SelectionTests.cpp Selection.cpp -o selection_tests && ./selection_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+#include "Selection.h"
+
+using namespace std;
+
+vector<int> sorted(const set<int>& rows) {
+    return vector<int>(rows.begin(), rows.end());
+}
+
+// Checks every way of reading the rows of the selection against the set of rows it should hold
+void checkRows(const Selection& selection, const set<int>& expected) {
+    assert(selection.toVector() == sorted(expected));
+    assert(selection.cardinality() == expected.size() && selection.empty() == expected.empty());
+    assert(selection.upperBound() == (expected.empty() ? 0 : (uint32_t) *expected.rbegin() + 1));
+
+    vector<int> visited;
+    selection.forEach([&](uint32_t row) { visited.push_back(row); });
+    assert(visited == sorted(expected));
+
+    vector<int> iterated;
+    for (uint32_t row : selection) { iterated.push_back(row); }
+    assert(iterated == sorted(expected));
+
+    // Runs are maximal: the row after a run is never selected
+    vector<int> fromRuns;
+    selection.forEachRun([&](uint32_t start, uint32_t end) {
+        assert(start < end && !expected.count(end));
+        for (uint32_t row = start; row < end; row++) { fromRuns.push_back(row); }
+    });
+    assert(fromRuns == sorted(expected));
+}
+
+void testSelection() {
+    mt19937 random(3);
+    checkRows(Selection(), {});
+
+    // A chunk turns into a bitmap past ARRAY_MAX rows and back into an array once intersected down
+    set<int> dense;
+    Selection denseSelection;
+    for (int i = 0; i < 70000; i += 3) {
+        dense.insert(i);
+        denseSelection.add(i);
+    }
+    checkRows(denseSelection, dense);
+    set<int> sparse;
+    Selection sparseSelection;
+    for (int i = 0; i < 200000; i += 1 + random() % 500) {
+        sparse.insert(i);
+        sparseSelection.add(i);
+    }
+    checkRows(sparseSelection, sparse);
+
+    set<int> both, either = dense;
+    for (int row : sparse) {
+        if (dense.count(row)) { both.insert(row); }
+        either.insert(row);
+    }
+    checkRows(denseSelection & sparseSelection, both);
+    checkRows(denseSelection | sparseSelection, either);
+    assert((denseSelection & sparseSelection) == (sparseSelection & denseSelection));
+    assert((denseSelection | Selection()) == denseSelection);
+    checkRows(denseSelection & Selection(), {});
+
+    // Ranges across chunk boundaries, and rows added out of order or twice
+    set<int> ranged;
+    for (int i = 65530; i < 131080; i++) { ranged.insert(i); }
+    checkRows(Selection::range(65530, 131080), ranged);
+    checkRows(Selection::range(5, 5), {});
+    checkRows(Selection::of({9, 3, 3, 70000, 1}), {1, 3, 9, 70000});
+    Selection added;
+    added.addRange(10, 20);
+    added.add(5);
+    added.add(15);
+    added.addRange(18, 25);
+    set<int> addedRows = {5};
+    for (int i = 10; i < 25; i++) { addedRows.insert(i); }
+    checkRows(added, addedRows);
+    assert(added.contains(5) && added.contains(24) && !added.contains(25) && !added.contains(6));
+
+    // Slices keep the rows in [start, end) only
+    set<int> sliced;
+    for (int row : either) {
+        if (row >= 1000 && row < 140000) { sliced.insert(row); }
+    }
+    checkRows((denseSelection | sparseSelection).slice(1000, 140000), sliced);
+    checkRows(denseSelection.slice(70000, 80000), {});
+
+    // Appending larger rows moves whole chunks over
+    Selection appended = Selection::range(0, 100);
+    appended.append(Selection::range(100, 70000));
+    appended.append(Selection::of({200000}));
+    set<int> appendedRows;
+    for (int i = 0; i < 70000; i++) { appendedRows.insert(i); }
+    appendedRows.insert(200000);
+    checkRows(appended, appendedRows);
+
+    // The largest rows
+    checkRows(Selection::of({(int) (UINT32_MAX >> 1)}), {(int) (UINT32_MAX >> 1)});
+}
+
+// Random selections combined in random ways, each step checked against the same steps on sets of rows
+// Rows cluster around a few chunks, so that chunks move between arrays and bitmaps as they fill up and empty out
+void testRandomOperations() {
+    mt19937 random(11);
+    auto randomRow = [&random]() { return (uint32_t) (random() % 3) * Selection::CHUNK_SIZE + random() % 9000; };
+    auto randomSelection = [&](set<int>& rows) {
+        Selection selection;
+        size_t count = random() % 3000;
+        for (size_t i = 0; i < count; i++) {
+            if (random() % 4 == 0) {
+                uint32_t start = randomRow();
+                uint32_t end = start + random() % 300;
+                selection.addRange(start, end);
+                for (uint32_t row = start; row < end; row++) { rows.insert(row); }
+            } else {
+                uint32_t row = randomRow();
+                selection.add(row);
+                rows.insert(row);
+            }
+        }
+        return selection;
+    };
+
+    for (int round = 0; round < 12; round++) {
+        set<int> leftRows, rightRows;
+        Selection left = randomSelection(leftRows);
+        Selection right = randomSelection(rightRows);
+        checkRows(left, leftRows);
+
+        set<int> both, either = leftRows;
+        for (int row : rightRows) {
+            if (leftRows.count(row)) { both.insert(row); }
+            either.insert(row);
+        }
+        checkRows(left & right, both);
+        checkRows(left | right, either);
+        assert(((left | right) & left) == left && ((left & right) | left) == left);
+
+        uint32_t start = randomRow(), end = start + random() % 100000;
+        set<int> sliced;
+        for (int row : either) {
+            if ((uint32_t) row >= start && (uint32_t) row < end) { sliced.insert(row); }
+        }
+        checkRows((left | right).slice(start, end), sliced);
+        for (int probe = 0; probe < 100; probe++) {
+            uint32_t row = randomRow();
+            assert(left.contains(row) == (leftRows.count(row) > 0));
+        }
+    }
+}
+
+int main() {
+    testSelection();
+    testRandomOperations();
+    cout << "All selection tests passed." << endl;
+    return 0;
+}
@@ -0,0 +1,85 @@
+// StringDictionaryTests.cpp
+//
+// Dictionary encoding of STRING columns: codes in the order values are first seen, null as code 0, codes of 1, 2 and
+// 4 bytes as the dictionary grows past 256 and 65536 codes, and a DictionaryColumn widening the codes it already holds
+// when it does, every row still reading back as stored.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -I. tests/StringDictionaryTests.cpp Predicate.cpp Selection.cpp StringDictionary.cpp -o string_dictionary_tests && ./string_dictionary_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "StringDictionary.h"
+
+using namespace std;
+
+void testCodes() {
+    StringDictionary dictionary;
+    assert(dictionary.size() == 1 && dictionary.decode(StringDictionary::NULL_CODE) == "M");
+
+    // Codes in the order values are first seen, the same value always getting the same code, "" and "M" being null
+    assert(dictionary.encode("Changi") == 1 && dictionary.encode("Paya Lebar") == 2 && dictionary.encode("Changi") == 1);
+    assert(dictionary.encode("") == StringDictionary::NULL_CODE && dictionary.encode("M") == StringDictionary::NULL_CODE);
+    assert(dictionary.size() == 3 && dictionary.decode(2) == "Paya Lebar");
+
+    // A dictionary built from the entries of another gives the same codes
+    assert(dictionary.entries() == vector<string>({"Changi", "Paya Lebar"}));
+    StringDictionary copy(dictionary.entries());
+    assert(copy.encode("Paya Lebar") == 2 && copy.encode("Seletar") == 3 && copy.size() == 4);
+
+    // Predicates are evaluated once per code
+    vector<bool> matches = dictionary.matchingCodes(Predicate::equals("Changi"));
+    assert(matches == vector<bool>({false, true, false}));
+    assert(dictionary.matchingCodes(Predicate::isNull()) == vector<bool>({true, false, false}));
+}
+
+void testWidths() {
+    assert(StringDictionary::widthFor(1) == 1 && StringDictionary::widthFor(256) == 1);
+    assert(StringDictionary::widthFor(257) == 2 && StringDictionary::widthFor(65536) == 2);
+    assert(StringDictionary::widthFor(65537) == 4);
+
+    // Codes of every width read back as appended, little endian, and widen without changing
+    vector<uint32_t> codes = {0, 1, 255, 256, 65535, 65536, 1 << 24};
+    for (int width : {1, 2, 4}) {
+        vector<char> packed;
+        uint32_t mask = width == 4 ? 0xFFFFFFFF : (1u << (8 * width)) - 1;
+        for (uint32_t code : codes) { StringDictionary::appendCode(packed, width, code & mask); }
+        assert(packed.size() == codes.size() * width);
+        for (size_t i = 0; i < codes.size(); i++) { assert(StringDictionary::readCode(packed.data(), width, i) == (codes[i] & mask)); }
+        if (width == 4) { continue; }
+
+        vector<char> widened = StringDictionary::widenCodes(packed.data(), codes.size(), width, width * 2);
+        assert(widened.size() == codes.size() * width * 2);
+        for (size_t i = 0; i < codes.size(); i++) { assert(StringDictionary::readCode(widened.data(), width * 2, i) == (codes[i] & mask)); }
+    }
+}
+
+// A column of more distinct values than 2-byte codes hold, its codes widened from 1 to 2 bytes at the 257th code and
+// to 4 bytes at the 65537th, every row read back after each step
+void testWidening() {
+    auto valueOf = [](size_t row) { return row % 10 == 9 ? string("M") : "Station " + to_string(row / 2); };
+    DictionaryColumn column;
+    // Every two rows add a value, so 510 rows need 256 codes and 131070 rows 65536
+    vector<pair<size_t, int>> checkpoints = {{510, 1}, {511, 2}, {131070, 2}, {131071, 4}, {140000, 4}};
+    size_t rows = 0;
+    for (auto [checkpoint, width] : checkpoints) {
+        for (; rows < checkpoint; rows++) { column.push_back(valueOf(rows)); }
+        StringDictionary dictionary = column.getDictionary();
+        assert(column.size() == rows && dictionary.codeWidth() == width);
+        for (size_t row = 0; row < rows; row++) {
+            assert(column.at(row) == valueOf(row) && column.codeAt(row) == dictionary.encode(valueOf(row)));
+        }
+        assert(dictionary.size() == column.getDictionary().size());
+    }
+}
+
+int main() {
+    testCodes();
+    testWidths();
+    testWidening();
+    cout << "All string dictionary tests passed." << endl;
+    return 0;
+}
@@ -0,0 +1,207 @@
+// ThreadPoolTests.cpp
+//
+// The ThreadPool and its TaskGroups: every task runs once, the first exception of a group reaches its wait(), and groups
+// waited for inside the tasks of other groups finish even on a single worker, since waiting threads run queued tasks.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -pthread -I. tests/ThreadPoolTests.cpp ThreadPool.cpp -o thread_pool_tests && ./thread_pool_tests
+
+#undef NDEBUG
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ThreadPool.h"
+
+using namespace std;
+
+void testTasks() {
+    ThreadPool pool(4);
+    assert(pool.workerCount() == 4 && ThreadPool(0).workerCount() == 1);
+
+    // Every task runs exactly once, whichever thread submits it
+    vector<atomic<int>> runs(10000);
+    {
+        TaskGroup group(pool);
+        for (size_t task = 0; task < runs.size(); task++) {
+            group.run([&runs, task]() { runs[task]++; });
+        }
+        group.wait();
+        for (atomic<int>& count : runs) { assert(count == 1); }
+    }
+    vector<thread> submitters;
+    atomic<int> total{0};
+    for (int submitter = 0; submitter < 4; submitter++) {
+        submitters.emplace_back([&pool, &total]() {
+            TaskGroup group(pool);
+            for (int task = 0; task < 1000; task++) {
+                group.run([&total]() { total++; });
+            }
+            group.wait();
+        });
+    }
+    for (thread& submitter : submitters) { submitter.join(); }
+    assert(total == 4000);
+
+    // Waiting for a group without tasks returns at once, and a thread outside the pool finds nothing to run once it is idle
+    TaskGroup empty(pool);
+    empty.wait();
+    while (pool.runPendingTask()) {}
+    assert(!pool.runPendingTask());
+
+    // A pool being destroyed runs the tasks still queued first
+    atomic<int> queued{0};
+    {
+        ThreadPool slowPool(1);
+        slowPool.submit([]() { this_thread::sleep_for(chrono::milliseconds(20)); });
+        for (int task = 0; task < 100; task++) {
+            slowPool.submit([&queued]() { queued++; });
+        }
+    }
+    assert(queued == 100);
+}
+
+void testExceptions() {
+    ThreadPool pool(4);
+
+    // The first exception reaches wait(), after every task of the group has finished
+    atomic<int> finished{0};
+    TaskGroup group(pool);
+    for (int task = 0; task < 100; task++) {
+        group.run([&finished, task]() {
+            this_thread::sleep_for(chrono::microseconds(task % 7 * 50));
+            finished++;
+            if (task % 10 == 3) { throw runtime_error("Task " + to_string(task) + " failed"); }
+        });
+    }
+    bool thrown = false;
+    try {
+        group.wait();
+    } catch (runtime_error& e) {
+        thrown = string(e.what()).find(" failed") != string::npos;
+    }
+    assert(thrown && finished == 100);
+
+    // It is rethrown once, the group can be used again after it
+    group.wait();
+    group.run([&finished]() { finished++; });
+    group.wait();
+    assert(finished == 101);
+
+    // Exceptions of any type are passed on as they are
+    group.run([]() { throw 42; });
+    int value = 0;
+    try {
+        group.wait();
+    } catch (int thrownValue) {
+        value = thrownValue;
+    }
+    assert(value == 42);
+
+    // A group destroyed without waiting still waits for its tasks, and drops their exception
+    atomic<bool> ran{false};
+    {
+        TaskGroup unwaited(pool);
+        unwaited.run([&ran]() {
+            this_thread::sleep_for(chrono::milliseconds(5));
+            ran = true;
+            throw runtime_error("Not waited for");
+        });
+    }
+    assert(ran);
+}
+
+// How many waits are nested on the calling thread, and the most there have been on any thread
+thread_local int waitDepth = 0;
+atomic<int> maxWaitDepth{0};
+
+// The sum of 0..count-1, split in halves that each run as a task of a nested group until they are small
+long long nestedSum(ThreadPool& pool, long long first, long long count, atomic<int>& groups) {
+    if (count <= 16) {
+        long long sum = 0;
+        for (long long value = first; value < first + count; value++) { sum += value; }
+        return sum;
+    }
+    groups++;
+    long long left = 0, right = 0;
+    TaskGroup group(pool);
+    group.run([&]() { left = nestedSum(pool, first, count / 2, groups); });
+    group.run([&]() { right = nestedSum(pool, first + count / 2, count - count / 2, groups); });
+    int depth = ++waitDepth;
+    for (int deepest = maxWaitDepth; depth > deepest && !maxWaitDepth.compare_exchange_weak(deepest, depth);) {}
+    group.wait();
+    waitDepth--;
+    return left + right;
+}
+
+void testNestedWaits() {
+    // Deeper than there are workers: every waiting worker runs the tasks it waits for
+    for (size_t workers : {1, 2, 8}) {
+        ThreadPool pool(workers);
+        atomic<int> groups{0};
+        maxWaitDepth = 0;
+        assert(nestedSum(pool, 0, 100000, groups) == 100000LL * 99999 / 2);
+        assert(groups > 1000);
+
+        // A waiting thread only runs tasks of its own group, so waits nest no deeper than the 13 levels of groups
+        assert(maxWaitDepth <= 13);
+    }
+
+    // A waiting thread does not run the tasks of other groups, it is not held up by them
+    ThreadPool blockedPool(1);
+    atomic<bool> started{false}, release{false};
+    TaskGroup blocker(blockedPool);
+    blocker.run([&started, &release]() {
+        started = true;
+        while (!release) { this_thread::yield(); }
+    });
+    while (!started) { this_thread::yield(); } // the only worker is stuck in the blocker
+    atomic<bool> otherRan{false};
+    TaskGroup other(blockedPool);
+    other.run([&otherRan]() { otherRan = true; });
+    TaskGroup own(blockedPool);
+    atomic<int> ownRan{0};
+    for (int task = 0; task < 10; task++) { own.run([&ownRan]() { ownRan++; }); }
+    own.wait();
+    assert(ownRan == 10 && !otherRan);
+    release = true;
+    other.wait();
+    blocker.wait();
+    assert(otherRan);
+
+    // An exception in a nested group reaches the wait() of the outermost one through the waits in between
+    ThreadPool pool(2);
+    TaskGroup outer(pool);
+    atomic<int> siblings{0};
+    for (int task = 0; task < 8; task++) {
+        outer.run([&pool, &siblings, task]() {
+            TaskGroup inner(pool);
+            for (int innerTask = 0; innerTask < 8; innerTask++) {
+                inner.run([&siblings, task, innerTask]() {
+                    siblings++;
+                    if (task == 5 && innerTask == 6) { throw out_of_range("Nested failure"); }
+                });
+            }
+            inner.wait();
+        });
+    }
+    bool thrown = false;
+    try {
+        outer.wait();
+    } catch (out_of_range& e) {
+        thrown = string(e.what()) == "Nested failure";
+    }
+    assert(thrown && siblings == 64);
+}
+
+int main() {
+    testTasks();
+    testExceptions();
+    testNestedWaits();
+    cout << "All thread pool tests passed." << endl;
+    return 0;
+}
@@ -0,0 +1,143 @@
+// TimeFormatTests.cpp
+//
+// The conversions of TIME values: the SWAR parser of "YYYY-MM-DD HH:MM", the calendar arithmetic behind it
+// checked against gmtime_r(), and the values it rejects.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -I. tests/TimeFormatTests.cpp TimeFormat.cpp -o time_format_tests && ./time_format_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include "TimeFormat.h"
+#include "ColumnStoreAbstract.h"
+
+using namespace std;
+
+// The text of the epoch seconds in the format parse() reads, through gmtime_r()
+string format(int64_t epoch, bool withSeconds) {
+    time_t seconds = (time_t) epoch;
+    tm t;
+    gmtime_r(&seconds, &t);
+    char buffer[32];
+    strftime(buffer, sizeof(buffer), withSeconds ? "%Y-%m-%d %H:%M:%S" : "%Y-%m-%d %H:%M", &t);
+    return buffer;
+}
+
+bool parses(const string& value) {
+    int64_t epoch;
+    return TimeFormat::parse(value, epoch);
+}
+
+void testCalendar() {
+    assert(TimeFormat::daysFromCivil(1970, 1, 1) == 0);
+    assert(TimeFormat::daysFromCivil(2000, 3, 1) == 11017);
+    assert(TimeFormat::daysFromCivil(1969, 12, 31) == -1);
+
+    // Every day of 1600..2400, through leap years and the turns of centuries, back and forth
+    int64_t days = TimeFormat::daysFromCivil(1600, 1, 1);
+    for (int year = 1600; year < 2400; year++) {
+        for (int month = 1; month <= 12; month++) {
+            static const int DAYS[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+            bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+            int monthDays = month == 2 && leap ? 29 : DAYS[month - 1];
+            for (int day = 1; day <= monthDays; day++, days++) {
+                assert(TimeFormat::daysFromCivil(year, month, day) == days);
+                int y, m, d;
+                TimeFormat::civilFromDays(days, y, m, d);
+                assert(y == year && m == month && d == day);
+            }
+        }
+    }
+
+    // Months outside 1..12 roll over into the neighbouring years
+    assert(TimeFormat::toEpoch(2019, 13, 1) == TimeFormat::toEpoch(2020, 1, 1));
+    assert(TimeFormat::toEpoch(2020, 0, 1) == TimeFormat::toEpoch(2019, 12, 1));
+    assert(TimeFormat::toEpoch(2020, -11, 1) == TimeFormat::toEpoch(2019, 1, 1));
+    assert(TimeFormat::toEpoch(2020, 3, 0) == TimeFormat::toEpoch(2020, 2, 29));
+    assert(TimeFormat::toEpoch(1970, 1, 1) == 0 && TimeFormat::toEpoch(1970, 1, 2) == 86400);
+
+    // Days of times before 1970 round down
+    assert(TimeFormat::daysFromEpoch(0) == 0 && TimeFormat::daysFromEpoch(86399) == 0 && TimeFormat::daysFromEpoch(86400) == 1);
+    assert(TimeFormat::daysFromEpoch(-1) == -1 && TimeFormat::daysFromEpoch(-86400) == -1 && TimeFormat::daysFromEpoch(-86401) == -2);
+}
+
+void testRoundTrips() {
+    // Times every 7 hours and 13 minutes from 1900 to 2100 read back as the seconds gmtime_r() turns into that text
+    for (int64_t epoch = TimeFormat::toEpoch(1900, 1, 1); epoch < TimeFormat::toEpoch(2100, 1, 1); epoch += 7 * 3600 + 13 * 60 + 17) {
+        int64_t parsed = -1;
+        assert(TimeFormat::parse(format(epoch, true), parsed) && parsed == epoch);
+        assert(TimeFormat::parse(format(epoch, false), parsed) && parsed == epoch - epoch % 60 - (epoch % 60 < 0 ? 60 : 0));
+    }
+
+    // The last minute of a leap day and of a year
+    int64_t epoch;
+    assert(TimeFormat::parse("2020-02-29 23:59", epoch) && epoch == TimeFormat::toEpoch(2020, 3, 1) - 60);
+    assert(TimeFormat::parse("1999-12-31 23:59:59", epoch) && epoch == TimeFormat::toEpoch(2000, 1, 1) - 1);
+    assert(TimeFormat::parse("2000-02-29 00:00", epoch) && epoch == TimeFormat::toEpoch(2000, 2, 29));
+
+    // Any get_time() format reads the same seconds
+    assert(TimeFormat::parse("29/02/2020 13:45", "%d/%m/%Y %H:%M", epoch) && epoch == TimeFormat::toEpoch(2020, 2, 29) + 13 * 3600 + 45 * 60);
+    assert(TimeFormat::parse("2020-02-29 13:45", TimeFormat::FORMAT, epoch) && epoch == TimeFormat::toEpoch(2020, 2, 29) + 13 * 3600 + 45 * 60);
+    assert(!TimeFormat::parse("2019-02-29 13:45", TimeFormat::FORMAT, epoch));
+}
+
+void testInvalidValues() {
+    // Bad separators, in every position
+    assert(parses("2020-06-15 08:30"));
+    assert(!parses("2020/06/15 08:30"));
+    assert(!parses("2020-06/15 08:30"));
+    assert(!parses("2020-06-15T08:30"));
+    assert(!parses("2020-06-15 08.30"));
+    assert(!parses("2020-06-15 08:30.00"));
+    assert(!parses("2020-06-15 08:30:0x"));
+
+    // Digits only where the layout has them, and exactly two of them
+    assert(!parses("202O-06-15 08:30"));
+    assert(!parses("2020-06-1  08:30"));
+    assert(!parses("2020-6-15 08:30"));
+    assert(!parses("2020-06-15 8:30"));
+    assert(!parses("+020-06-15 08:30"));
+    assert(!parses("2020-06-15 08:3:"));
+    assert(!parses("2020-06-15 08:30 "));
+    assert(!parses(""));
+    assert(!parses("M"));
+
+    // Dates and times that do not exist
+    assert(!parses("2019-02-29 00:00"));
+    assert(!parses("1900-02-29 00:00"));
+    assert(parses("2000-02-29 00:00"));
+    assert(!parses("2020-04-31 00:00"));
+    assert(!parses("2020-00-10 00:00"));
+    assert(!parses("2020-13-10 00:00"));
+    assert(!parses("2020-01-00 00:00"));
+    assert(!parses("2020-01-32 00:00"));
+    assert(!parses("2020-01-10 24:00"));
+    assert(!parses("2020-01-10 23:60"));
+    assert(!parses("2020-01-10 23:59:60"));
+
+    // A rejected value leaves epoch as it was
+    int64_t epoch = 42;
+    assert(!TimeFormat::parse("2020-01-10 24:00", epoch) && epoch == 42);
+}
+
+void testEpochStart() {
+    // The start of 1970 is 0 epoch seconds, a time like any other: NULL_TIME lies before every time that can be parsed
+    int64_t epoch = -1;
+    assert(TimeFormat::parse("1970-01-01 00:00", epoch) && epoch == 0 && epoch != ColumnStoreAbstract::NULL_TIME);
+    assert(TimeFormat::parse("1970-01-01 00:01", epoch) && epoch == 60);
+    assert(TimeFormat::parse("1969-12-31 23:59:59", epoch) && epoch == -1);
+    assert(TimeFormat::parse("0001-01-01 00:00", epoch) && epoch > ColumnStoreAbstract::NULL_TIME);
+}
+
+int main() {
+    testCalendar();
+    testRoundTrips();
+    testInvalidValues();
+    testEpochStart();
+    cout << "All time format tests passed." << endl;
+    return 0;
+}
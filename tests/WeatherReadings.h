@@ -0,0 +1,69 @@
+// WeatherReadings.h
+//
+// The weather readings the GroupBy and ExtremesReport tests load into the stores: the columns, the values of every
+// row, and the batch holding them. Included after the stores' .cpp files, whose classes it uses.
+
+#ifndef WEATHERREADINGS_H
+#define WEATHERREADINGS_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace std;
+
+const string STATIONS[] = {"Changi", "Paya Lebar", "Seletar"};
+
+const int STRING = ColumnStoreAbstract::STRING_DATATYPE;
+const int FLOAT = ColumnStoreAbstract::FLOAT_DATATYPE;
+const int TIME = ColumnStoreAbstract::TIME_DATATYPE;
+
+const unordered_map<string, int> COLUMNS = {{"Timestamp", TIME}, {"Station", STRING}, {"Humidity", FLOAT}, {"Temperature", FLOAT}};
+
+// Readings of two stations every 15 minutes of 2019, more rows than a morsel holds. The humidity only takes 25 values
+// per station, so its extremes are tied on several rows of a day and on many days. Changi reads no humidity in April
+// and nothing at all in May, and its August rows are Seletar's. Some timestamps are missing.
+const size_t ROW_COUNT = 2 * 365 * 96;
+
+inline int64_t timestampOf(size_t row) {
+    size_t reading = row / 2;
+    return reading % 997 == 500 ? ColumnStoreAbstract::NULL_TIME : TimeFormat::toEpoch(2019, 1, 1) + (int64_t) reading * 900;
+}
+
+inline int monthOf(size_t row) {
+    int year, month, day;
+    TimeFormat::civilFromDays(TimeFormat::daysFromEpoch(TimeFormat::toEpoch(2019, 1, 1) + (int64_t) (row / 2) * 900), year, month, day);
+    return month;
+}
+
+inline string_view stationOf(size_t row) {
+    if (row % 2 == 1) { return STATIONS[1]; }
+    return monthOf(row) == 8 ? STATIONS[2] : STATIONS[0];
+}
+
+inline float humidityOf(size_t row) {
+    bool changi = row % 2 == 0;
+    if (row % 13 == 4 || (changi && (monthOf(row) == 4 || monthOf(row) == 5))) { return ColumnStoreAbstract::NULL_FLOAT; }
+    return 50.0f + (row * 37 % 50);
+}
+
+inline float temperatureOf(size_t row) {
+    if (row % 17 == 6 || (row % 2 == 0 && monthOf(row) == 5)) { return ColumnStoreAbstract::NULL_FLOAT; }
+    return 20.0f + (row * 53 % 150) / 10.0f;
+}
+
+inline ColumnBatch readings() {
+    ColumnBatch batch;
+    batch.columns = {ColumnBatch::Column("Timestamp", TIME), ColumnBatch::Column("Station", STRING),
+        ColumnBatch::Column("Humidity", FLOAT), ColumnBatch::Column("Temperature", FLOAT)};
+    for (size_t row = 0; row < ROW_COUNT; row++) {
+        batch.columns[0].times.push_back(timestampOf(row));
+        batch.columns[1].strings.push_back(stationOf(row));
+        batch.columns[2].floats.push_back(humidityOf(row));
+        batch.columns[3].floats.push_back(temperatureOf(row));
+    }
+    batch.rowCount = ROW_COUNT;
+    return batch;
+}
+
+#endif
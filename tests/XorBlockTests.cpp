@@ -0,0 +1,73 @@
+// XorBlockTests.cpp
+//
+// Round trips and edge cases of the XOR encoded blocks of FLOAT chunks, see XorBlock.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -I. tests/XorBlockTests.cpp XorBlock.cpp -o xor_block_tests && ./xor_block_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+#include "XorBlock.h"
+
+using namespace std;
+
+void checkXorRoundTrip(const vector<float>& values) {
+    vector<char> block(1, 0);
+    XorBlock::encode(values.data(), values.size(), block);
+    assert(XorBlock::header(block.data() + 1).count == values.size());
+
+    vector<float> decoded(values.size());
+    XorBlock::decode(block.data() + 1, decoded.data());
+    // Compared bit for bit, so that NaN nulls and -0.0 count as well
+    assert(values.empty() || memcmp(decoded.data(), values.data(), values.size() * sizeof(float)) == 0);
+    for (size_t i = 0; i < values.size(); i += 7) {
+        float value = XorBlock::at(block.data() + 1, i);
+        assert(memcmp(&value, &values[i], sizeof(float)) == 0);
+    }
+}
+
+void testXorBlock() {
+    mt19937 random(11);
+    const float nullFloat = numeric_limits<float>::quiet_NaN();
+
+    // Slowly changing readings take far fewer than 32 bits each
+    vector<float> readings;
+    float temperature = 27.5f;
+    for (int i = 0; i < 4096; i++) {
+        if (random() % 4 == 0) { temperature += 0.1f * (float) ((int) (random() % 5) - 2); }
+        readings.push_back(i % 97 == 0 ? nullFloat : temperature);
+    }
+    checkXorRoundTrip(readings);
+    vector<char> block;
+    XorBlock::encode(readings.data(), readings.size(), block);
+    assert(XorBlock::header(block.data()).byteLength < readings.size() * sizeof(float) / 2);
+
+    // Values that share no bits with the previous one open a new window every time
+    vector<float> noise;
+    for (int i = 0; i < 1000; i++) {
+        uint32_t bits = random() & 0x7F7FFFFFu; // finite values only, NaNs other than the null are not stored
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        noise.push_back(value);
+    }
+    checkXorRoundTrip(noise);
+
+    float denormal = numeric_limits<float>::denorm_min();
+    checkXorRoundTrip({0.0f, -0.0f, numeric_limits<float>::infinity(), -numeric_limits<float>::infinity(), denormal, -denormal,
+                       numeric_limits<float>::max(), numeric_limits<float>::lowest(), nullFloat});
+    checkXorRoundTrip({1.5f});
+    checkXorRoundTrip(vector<float>(500, 3.25f));
+    checkXorRoundTrip(vector<float>(500, nullFloat));
+    checkXorRoundTrip({});
+}
+
+int main() {
+    testXorBlock();
+    cout << "All XOR block tests passed." << endl;
+    return 0;
+}
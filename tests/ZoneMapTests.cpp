@@ -0,0 +1,69 @@
+// ZoneMapTests.cpp
+//
+// The per-zone statistics of a ZoneMap, and the zones they let a predicate skip.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -I. tests/ZoneMapTests.cpp ZoneMap.cpp Predicate.cpp Selection.cpp -o zone_map_tests && ./zone_map_tests
+
+#undef NDEBUG
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include "Predicate.h"
+#include "Selection.h"
+#include "ZoneMap.h"
+
+using namespace std;
+
+void testZoneMap() {
+    ZoneMap zoneMap;
+    assert(zoneMap.empty() && zoneMap.rowCount == 0);
+
+    // Zone 0 holds 0..4095 with a null, zone 1 only nulls, zone 2 values without statistics and a partial zone 3
+    for (uint32_t row = 0; row < ZoneMap::ZONE_ROWS; row++) {
+        if (row == 10) { zoneMap.addNull(); }
+        else { zoneMap.addValue(row); }
+    }
+    for (uint32_t row = 0; row < ZoneMap::ZONE_ROWS; row++) { zoneMap.addNull(); }
+    for (uint32_t row = 0; row < ZoneMap::ZONE_ROWS; row++) { zoneMap.addUnknown(); }
+    zoneMap.addValue(-5.5);
+    zoneMap.addValue(7);
+
+    assert(zoneMap.zones.size() == 4 && zoneMap.rowCount == 3 * ZoneMap::ZONE_ROWS + 2);
+    assert(zoneMap.zones[0].min == 0 && zoneMap.zones[0].max == ZoneMap::ZONE_ROWS - 1 && zoneMap.zones[0].nullCount == 1);
+    assert(zoneMap.zones[1].nullCount == ZoneMap::ZONE_ROWS && zoneMap.zones[1].min > zoneMap.zones[1].max);
+    assert(isinf(zoneMap.zones[2].min) && isinf(zoneMap.zones[2].max) && zoneMap.zones[2].nullCount == 0);
+    assert(zoneMap.zones[3].min == -5.5 && zoneMap.zones[3].max == 7 && zoneMap.zones[3].rowCount == 2);
+    assert(zoneMap.firstRow(3) == 3 * ZoneMap::ZONE_ROWS);
+
+    // Zones are skipped only when their statistics rule the predicate out
+    assert(zoneMap.mayMatch(0, Predicate::equals(100)) && !zoneMap.mayMatch(0, Predicate::greaterThan((int) ZoneMap::ZONE_ROWS - 1)));
+    assert(!zoneMap.mayMatch(1, Predicate::equals(100)) && zoneMap.mayMatch(1, Predicate::isNull()));
+    assert(zoneMap.mayMatch(2, Predicate::equals(1e9)) && !zoneMap.mayMatch(2, Predicate::isNull()));
+    assert(zoneMap.mayMatch(3, Predicate::between(-6, -5)) && !zoneMap.mayMatch(3, Predicate::lessThan(-5.5)));
+    assert(zoneMap.mayMatch(0, !Predicate::isNull()) && !zoneMap.mayMatch(1, !Predicate::isNull()));
+
+    uint32_t zoneRows = ZoneMap::ZONE_ROWS;
+    assert(zoneMap.candidateRows(Predicate::equals(7)) == (Selection::range(0, zoneRows) | Selection::range(2 * zoneRows, 3 * zoneRows + 2)));
+    assert(zoneMap.candidateRows(Predicate::isNull()) == Selection::range(0, 2 * zoneRows));
+    assert(zoneMap.candidateRows(Predicate::between(5000, 6000)) == Selection::range(2 * zoneRows, 3 * zoneRows));
+
+    // Where the blocks are, and zones forgotten to be written again
+    zoneMap.setLastBlock(1000, 24, 1);
+    assert(zoneMap.zones[3].byteOffset == 1000 && zoneMap.zones[3].byteLength == 24 && zoneMap.zones[3].encoding == 1);
+    ZoneMap::Zone last = zoneMap.zones[3];
+    zoneMap.removeLastZone();
+    assert(zoneMap.zones.size() == 3 && zoneMap.rowCount == 3 * ZoneMap::ZONE_ROWS);
+    zoneMap.addZone(last);
+    assert(zoneMap.zones.size() == 4 && zoneMap.rowCount == 3 * ZoneMap::ZONE_ROWS + 2);
+
+    // The partial zone goes on filling before a new one starts
+    for (uint32_t row = 2; row < ZoneMap::ZONE_ROWS + 1; row++) { zoneMap.addValue(1); }
+    assert(zoneMap.zones.size() == 5 && zoneMap.zones[3].rowCount == ZoneMap::ZONE_ROWS && zoneMap.zones[4].rowCount == 1);
+}
+
+int main() {
+    testZoneMap();
+    cout << "All zone map tests passed." << endl;
+    return 0;
+}